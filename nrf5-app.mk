@@ -33,22 +33,37 @@ include $(BUILD_SUPPORT_DIR)/nrf5-openthread.mk
 LOCK_SRCS = \
     $(PROJECT_ROOT)/src/examples/lock/main.cpp \
     $(PROJECT_ROOT)/src/examples/lock/DeviceController.cpp \
-    $(PROJECT_ROOT)/src/examples/lock/WDMFeature.cpp \
+    $(PROJECT_ROOT)/src/examples/lock/AssociatedSensor.cpp \
     $(PROJECT_ROOT)/src/examples/lock/traits/BoltLockSettingsTraitDataSink.cpp \
     $(PROJECT_ROOT)/src/examples/lock/traits/BoltLockTraitDataSource.cpp \
     $(PROJECT_ROOT)/src/examples/lock/traits/DeviceIdentityTraitDataSource.cpp \
+    $(PROJECT_ROOT)/src/examples/lock/traits/SecurityOpenCloseTraitDataSink.cpp \
     $(PROJECT_ROOT)/src/examples/lock/schema/BoltLockSettingsTrait.cpp \
     $(PROJECT_ROOT)/src/examples/lock/schema/BoltLockTrait.cpp \
+    $(PROJECT_ROOT)/src/examples/lock/schema/BoltLockTraitEventSerializer.cpp \
     $(PROJECT_ROOT)/src/examples/lock/schema/DeviceIdentityTrait.cpp \
+    $(PROJECT_ROOT)/src/examples/lock/schema/OpenCloseTrait.cpp \
+    $(PROJECT_ROOT)/src/examples/lock/schema/SecurityOpenCloseTrait.cpp \
     $(PROJECT_ROOT)/src/common/AppTask.cpp \
+    $(PROJECT_ROOT)/src/common/AppTaskStats.cpp \
     $(PROJECT_ROOT)/src/common/LED.cpp \
     $(PROJECT_ROOT)/src/common/Button.cpp \
+    $(PROJECT_ROOT)/src/common/ButtonDebouncer.cpp \
     $(PROJECT_ROOT)/src/common/ConnectivityState.cpp \
+    $(PROJECT_ROOT)/src/common/GenericWDMFeature.cpp \
+    $(PROJECT_ROOT)/src/common/CachedTraitDataSource.cpp \
+    $(PROJECT_ROOT)/src/common/PublisherLock.cpp \
+    $(PROJECT_ROOT)/src/common/RttEstimator.cpp \
+    $(PROJECT_ROOT)/src/common/ResubscribePolicy.cpp \
+    $(PROJECT_ROOT)/src/common/PersistedEventLog.cpp \
+    $(PROJECT_ROOT)/src/common/ResponseBufferPool.cpp \
     $(PROJECT_ROOT)/src/common/AppSoftwareUpdateManager.cpp \
     $(PROJECT_ROOT)/src/common/AltPrintf.c \
     $(PROJECT_ROOT)/src/common/CXXExceptionStubs.cpp \
     $(PROJECT_ROOT)/src/common/FreeRTOSNewlibLockSupport.c \
+    $(PROJECT_ROOT)/src/common/FreeRTOSStaticSupport.c \
     $(PROJECT_ROOT)/src/common/platforms/nrf5/HardwarePlatform.cpp \
+    $(PROJECT_ROOT)/src/common/platforms/nrf5/AppPersistentStorage.cpp \
     $(PROJECT_ROOT)/src/common/platforms/nrf5/Nrf5LED.cpp \
     $(PROJECT_ROOT)/src/common/platforms/nrf5/nRF5Sbrk.c \
     $(PROJECT_ROOT)/third_party/printf/printf.c
@@ -56,25 +71,35 @@ LOCK_SRCS = \
 OCSENSOR_SRCS = \
     $(PROJECT_ROOT)/src/examples/ocsensor/main.cpp \
     $(PROJECT_ROOT)/src/examples/ocsensor/DeviceController.cpp \
-    $(PROJECT_ROOT)/src/examples/ocsensor/WDMFeature.cpp \
     $(PROJECT_ROOT)/src/examples/ocsensor/schema/ApplicationKeysTrait.cpp \
     $(PROJECT_ROOT)/src/examples/ocsensor/schema/DeviceIdentityTrait.cpp \
     $(PROJECT_ROOT)/src/examples/ocsensor/schema/DeviceLocatedSettingsTrait.cpp \
     $(PROJECT_ROOT)/src/examples/ocsensor/schema/LocatedTrait.cpp \
     $(PROJECT_ROOT)/src/examples/ocsensor/schema/OpenCloseTrait.cpp \
     $(PROJECT_ROOT)/src/examples/ocsensor/schema/SecurityOpenCloseTrait.cpp \
+    $(PROJECT_ROOT)/src/examples/ocsensor/schema/SecurityOpenCloseTraitEventSerializer.cpp \
     $(PROJECT_ROOT)/src/examples/ocsensor/traits/DeviceIdentityTraitDataSource.cpp \
     $(PROJECT_ROOT)/src/examples/ocsensor/traits/DeviceLocatedSettingsTraitDataSink.cpp \
     $(PROJECT_ROOT)/src/examples/ocsensor/traits/SecurityOpenCloseTraitDataSource.cpp \
     $(PROJECT_ROOT)/src/common/AppTask.cpp \
+    $(PROJECT_ROOT)/src/common/AppTaskStats.cpp \
     $(PROJECT_ROOT)/src/common/LED.cpp \
     $(PROJECT_ROOT)/src/common/Button.cpp \
+    $(PROJECT_ROOT)/src/common/ButtonDebouncer.cpp \
     $(PROJECT_ROOT)/src/common/ConnectivityState.cpp \
+    $(PROJECT_ROOT)/src/common/GenericWDMFeature.cpp \
+    $(PROJECT_ROOT)/src/common/CachedTraitDataSource.cpp \
+    $(PROJECT_ROOT)/src/common/PublisherLock.cpp \
+    $(PROJECT_ROOT)/src/common/RttEstimator.cpp \
+    $(PROJECT_ROOT)/src/common/ResubscribePolicy.cpp \
+    $(PROJECT_ROOT)/src/common/PersistedEventLog.cpp \
     $(PROJECT_ROOT)/src/common/AppSoftwareUpdateManager.cpp \
     $(PROJECT_ROOT)/src/common/AltPrintf.c \
     $(PROJECT_ROOT)/src/common/CXXExceptionStubs.cpp \
     $(PROJECT_ROOT)/src/common/FreeRTOSNewlibLockSupport.c \
+    $(PROJECT_ROOT)/src/common/FreeRTOSStaticSupport.c \
     $(PROJECT_ROOT)/src/common/platforms/nrf5/HardwarePlatform.cpp \
+    $(PROJECT_ROOT)/src/common/platforms/nrf5/AppPersistentStorage.cpp \
     $(PROJECT_ROOT)/src/common/platforms/nrf5/Nrf5LED.cpp \
     $(PROJECT_ROOT)/src/common/platforms/nrf5/nRF5Sbrk.c \
     $(PROJECT_ROOT)/third_party/printf/printf.c
@@ -107,7 +132,6 @@ SRCS = \
     $(NRF5_SDK_ROOT)/components/libraries/atomic/nrf_atomic.c \
     $(NRF5_SDK_ROOT)/components/libraries/atomic_fifo/nrf_atfifo.c \
     $(NRF5_SDK_ROOT)/components/libraries/balloc/nrf_balloc.c \
-    $(NRF5_SDK_ROOT)/components/libraries/button/app_button.c \
     $(NRF5_SDK_ROOT)/components/libraries/crc16/crc16.c \
     $(NRF5_SDK_ROOT)/components/libraries/experimental_section_vars/nrf_section_iter.c \
     $(NRF5_SDK_ROOT)/components/libraries/fds/fds.c \
@@ -178,7 +202,6 @@ INC_DIRS = \
     $(NRF5_SDK_ROOT)/components/libraries/atomic_fifo \
     $(NRF5_SDK_ROOT)/components/libraries/balloc \
     $(NRF5_SDK_ROOT)/components/libraries/bsp \
-    $(NRF5_SDK_ROOT)/components/libraries/button \
     $(NRF5_SDK_ROOT)/components/libraries/crc16 \
     $(NRF5_SDK_ROOT)/components/libraries/delay \
     $(NRF5_SDK_ROOT)/components/libraries/experimental_section_vars \
@@ -232,6 +255,25 @@ CFLAGS = \
 LDFLAGS = \
     --specs=nano.specs
 
+# Static allocation of the application's kernel objects:
+#   $ make APP=lock PLATFORM=<platform> STATIC_ALLOCATION=1 [BOOT_HEAP_BUDGET=<bytes>]
+ifeq ($(STATIC_ALLOCATION),1)
+DEFINES += \
+    APP_USE_STATIC_ALLOCATION=1
+ifdef BOOT_HEAP_BUDGET
+DEFINES += \
+    APP_BOOT_HEAP_BUDGET_BYTES=$(BOOT_HEAP_BUDGET)
+endif
+endif
+
+# Debug builds: check every event logged against its field descriptors (see
+# EventSerializer.h):
+#   $ make APP=<app> PLATFORM=<platform> EVENT_SELF_CHECK=1
+ifeq ($(EVENT_SELF_CHECK),1)
+DEFINES += \
+    EVENT_SERIALIZER_SELF_CHECK=1
+endif
+
 ifdef DEVICE_FIRMWARE_REVISION
 DEFINES += \
     WEAVE_DEVICE_CONFIG_DEVICE_FIRMWARE_REVISION=\"$(DEVICE_FIRMWARE_REVISION)\"
@@ -0,0 +1,299 @@
+#
+#   Copyright (c) 2020 Google LLC.
+#   All rights reserved.
+#
+#   Licensed under the Apache License, Version 2.0 (the "License");
+#   you may not use this file except in compliance with the License.
+#   You may obtain a copy of the License at
+#
+#       http://www.apache.org/licenses/LICENSE-2.0
+#
+#   Unless required by applicable law or agreed to in writing, software
+#   distributed under the License is distributed on an "AS IS" BASIS,
+#   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#   See the License for the specific language governing permissions and
+#   limitations under the License.
+#
+
+#
+#   @file
+#         Makefile for building the sample apps as host (posix) executables.
+#
+#         OpenWeave is built with its Linux Device Layer and the application
+#         runs on top of the FreeRTOS posix port, so the application code
+#         (AppTask, DeviceController, WDMFeature, traits) is the same code
+#         that runs on the devkits.
+#
+
+PROJECT_ROOT ?= $(realpath $(dir $(firstword $(MAKEFILE_LIST))))
+
+OPENWEAVE_ROOT     ?= $(PROJECT_ROOT)/third_party/openweave-core
+FREERTOS_ROOT      ?= $(PROJECT_ROOT)/third_party/FreeRTOS/FreeRTOS
+FREERTOS_PORT_DIR  = $(FREERTOS_ROOT)/Source/portable/ThirdParty/GCC/Posix
+FREERTOSCONFIG_DIR = $(PROJECT_ROOT)/src/common/platforms/posix/include
+
+CC  ?= gcc
+CXX ?= g++
+
+LOCK_SRCS = \
+    $(PROJECT_ROOT)/src/examples/lock/main.cpp \
+    $(PROJECT_ROOT)/src/examples/lock/DeviceController.cpp \
+    $(PROJECT_ROOT)/src/examples/lock/AssociatedSensor.cpp \
+    $(PROJECT_ROOT)/src/examples/lock/traits/BoltLockSettingsTraitDataSink.cpp \
+    $(PROJECT_ROOT)/src/examples/lock/traits/BoltLockTraitDataSource.cpp \
+    $(PROJECT_ROOT)/src/examples/lock/traits/DeviceIdentityTraitDataSource.cpp \
+    $(PROJECT_ROOT)/src/examples/lock/traits/SecurityOpenCloseTraitDataSink.cpp \
+    $(PROJECT_ROOT)/src/examples/lock/schema/BoltLockSettingsTrait.cpp \
+    $(PROJECT_ROOT)/src/examples/lock/schema/BoltLockTrait.cpp \
+    $(PROJECT_ROOT)/src/examples/lock/schema/BoltLockTraitEventSerializer.cpp \
+    $(PROJECT_ROOT)/src/examples/lock/schema/DeviceIdentityTrait.cpp \
+    $(PROJECT_ROOT)/src/examples/lock/schema/OpenCloseTrait.cpp \
+    $(PROJECT_ROOT)/src/examples/lock/schema/SecurityOpenCloseTrait.cpp \
+    $(PROJECT_ROOT)/src/common/AppTask.cpp \
+    $(PROJECT_ROOT)/src/common/AppTaskStats.cpp \
+    $(PROJECT_ROOT)/src/common/LED.cpp \
+    $(PROJECT_ROOT)/src/common/Button.cpp \
+    $(PROJECT_ROOT)/src/common/ConnectivityState.cpp \
+    $(PROJECT_ROOT)/src/common/GenericWDMFeature.cpp \
+    $(PROJECT_ROOT)/src/common/CachedTraitDataSource.cpp \
+    $(PROJECT_ROOT)/src/common/PublisherLock.cpp \
+    $(PROJECT_ROOT)/src/common/RttEstimator.cpp \
+    $(PROJECT_ROOT)/src/common/ResubscribePolicy.cpp \
+    $(PROJECT_ROOT)/src/common/PersistedEventLog.cpp \
+    $(PROJECT_ROOT)/src/common/ResponseBufferPool.cpp \
+    $(PROJECT_ROOT)/src/common/AppSoftwareUpdateManager.cpp \
+    $(PROJECT_ROOT)/src/common/FreeRTOSStaticSupport.c \
+    $(PROJECT_ROOT)/src/common/platforms/posix/HardwarePlatform.cpp \
+    $(PROJECT_ROOT)/src/common/platforms/posix/AppPersistentStorage.cpp \
+    $(PROJECT_ROOT)/src/common/platforms/posix/PosixLED.cpp \
+    $(PROJECT_ROOT)/src/common/platforms/posix/app_timer.cpp
+
+OCSENSOR_SRCS = \
+    $(PROJECT_ROOT)/src/examples/ocsensor/main.cpp \
+    $(PROJECT_ROOT)/src/examples/ocsensor/DeviceController.cpp \
+    $(PROJECT_ROOT)/src/examples/ocsensor/schema/ApplicationKeysTrait.cpp \
+    $(PROJECT_ROOT)/src/examples/ocsensor/schema/DeviceIdentityTrait.cpp \
+    $(PROJECT_ROOT)/src/examples/ocsensor/schema/DeviceLocatedSettingsTrait.cpp \
+    $(PROJECT_ROOT)/src/examples/ocsensor/schema/LocatedTrait.cpp \
+    $(PROJECT_ROOT)/src/examples/ocsensor/schema/OpenCloseTrait.cpp \
+    $(PROJECT_ROOT)/src/examples/ocsensor/schema/SecurityOpenCloseTrait.cpp \
+    $(PROJECT_ROOT)/src/examples/ocsensor/schema/SecurityOpenCloseTraitEventSerializer.cpp \
+    $(PROJECT_ROOT)/src/examples/ocsensor/traits/DeviceIdentityTraitDataSource.cpp \
+    $(PROJECT_ROOT)/src/examples/ocsensor/traits/DeviceLocatedSettingsTraitDataSink.cpp \
+    $(PROJECT_ROOT)/src/examples/ocsensor/traits/SecurityOpenCloseTraitDataSource.cpp \
+    $(PROJECT_ROOT)/src/common/AppTask.cpp \
+    $(PROJECT_ROOT)/src/common/AppTaskStats.cpp \
+    $(PROJECT_ROOT)/src/common/LED.cpp \
+    $(PROJECT_ROOT)/src/common/Button.cpp \
+    $(PROJECT_ROOT)/src/common/ConnectivityState.cpp \
+    $(PROJECT_ROOT)/src/common/GenericWDMFeature.cpp \
+    $(PROJECT_ROOT)/src/common/CachedTraitDataSource.cpp \
+    $(PROJECT_ROOT)/src/common/PublisherLock.cpp \
+    $(PROJECT_ROOT)/src/common/RttEstimator.cpp \
+    $(PROJECT_ROOT)/src/common/ResubscribePolicy.cpp \
+    $(PROJECT_ROOT)/src/common/PersistedEventLog.cpp \
+    $(PROJECT_ROOT)/src/common/AppSoftwareUpdateManager.cpp \
+    $(PROJECT_ROOT)/src/common/FreeRTOSStaticSupport.c \
+    $(PROJECT_ROOT)/src/common/platforms/posix/HardwarePlatform.cpp \
+    $(PROJECT_ROOT)/src/common/platforms/posix/AppPersistentStorage.cpp \
+    $(PROJECT_ROOT)/src/common/platforms/posix/PosixLED.cpp \
+    $(PROJECT_ROOT)/src/common/platforms/posix/app_timer.cpp
+
+FREERTOS_SRCS = \
+    $(FREERTOS_ROOT)/Source/croutine.c \
+    $(FREERTOS_ROOT)/Source/event_groups.c \
+    $(FREERTOS_ROOT)/Source/list.c \
+    $(FREERTOS_ROOT)/Source/queue.c \
+    $(FREERTOS_ROOT)/Source/stream_buffer.c \
+    $(FREERTOS_ROOT)/Source/tasks.c \
+    $(FREERTOS_ROOT)/Source/timers.c \
+    $(FREERTOS_ROOT)/Source/portable/MemMang/heap_3.c \
+    $(FREERTOS_PORT_DIR)/port.c \
+    $(FREERTOS_PORT_DIR)/utils/wait_for_event.c
+
+# To build an app (e.g. ocsensor)
+#   $ make APP=ocsensor PLATFORM=posix
+ifeq ($(APP),lock)
+   APP_DIR = lock
+   override APP = openweave-lock-$(PLATFORM)-example
+   APP_SRCS = $(LOCK_SRCS)
+   $(warning building lock application for $(PLATFORM))
+else ifeq ($(APP),ocsensor)
+   APP_DIR = ocsensor
+   override APP = openweave-ocsensor-$(PLATFORM)-example
+   APP_SRCS = $(OCSENSOR_SRCS)
+   $(warning building ocsensor application for $(PLATFORM))
+else
+   $(Error must specify APP as "lock" or "ocsensor". For example,"make APP=lock".)
+endif
+
+OPENWEAVE_PROJECT_CONFIG = $(PROJECT_ROOT)/src/examples/$(APP_DIR)/include/WeaveProjectConfig.h
+
+OUTPUT_DIR            ?= $(PROJECT_ROOT)/build-posix/$(APP_DIR)
+OBJS_DIR              = $(OUTPUT_DIR)/objs
+OPENWEAVE_BUILD_DIR   = $(OUTPUT_DIR)/openweave
+OPENWEAVE_INSTALL_DIR = $(OUTPUT_DIR)/openweave-install
+OPENWEAVE_STAMP       = $(OPENWEAVE_INSTALL_DIR)/.installed
+
+SRCS = \
+    $(APP_SRCS) \
+    $(FREERTOS_SRCS)
+
+INC_DIRS = \
+    $(PROJECT_ROOT) \
+    $(PROJECT_ROOT)/src/common/include \
+    $(PROJECT_ROOT)/src/common/platforms/posix/include \
+    $(PROJECT_ROOT)/src/examples/$(APP_DIR)/include \
+    $(PROJECT_ROOT)/src/examples/$(APP_DIR)/traits/include \
+    $(PROJECT_ROOT)/src/examples/$(APP_DIR)/schema/include \
+    $(FREERTOSCONFIG_DIR) \
+    $(FREERTOS_ROOT)/Source/include \
+    $(FREERTOS_PORT_DIR) \
+    $(FREERTOS_PORT_DIR)/utils \
+    $(OPENWEAVE_INSTALL_DIR)/include
+
+# The host has no BLE or Thread radio; Weave runs directly over the host's IP interfaces.
+DEFINES = \
+    WEAVE_PROJECT_CONFIG_INCLUDE=\"$(OPENWEAVE_PROJECT_CONFIG)\" \
+    WEAVE_DEVICE_LAYER_TARGET=Linux \
+    WEAVE_DEVICE_LAYER_TARGET_LINUX=1 \
+    WEAVE_DEVICE_CONFIG_ENABLE_WOBLE=0 \
+    WEAVE_ERROR_LOGGING=1 \
+    WEAVE_PROGRESS_LOGGING=1 \
+    WEAVE_DETAIL_LOGGING=1 \
+    APP_TASK_STACK_SIZE=65536
+
+# Static allocation of the application's kernel objects:
+#   $ make APP=lock PLATFORM=<platform> STATIC_ALLOCATION=1 [BOOT_HEAP_BUDGET=<bytes>]
+ifeq ($(STATIC_ALLOCATION),1)
+DEFINES += \
+    APP_USE_STATIC_ALLOCATION=1
+ifdef BOOT_HEAP_BUDGET
+DEFINES += \
+    APP_BOOT_HEAP_BUDGET_BYTES=$(BOOT_HEAP_BUDGET)
+endif
+endif
+
+# Log the DeviceIdentityTrait encode time with and without its TLV cache at startup:
+#   $ make APP=lock PLATFORM=posix DEVICE_IDENTITY_BENCHMARK=1
+ifeq ($(DEVICE_IDENTITY_BENCHMARK),1)
+DEFINES += \
+    DEVICE_IDENTITY_TRAIT_BENCHMARK=1
+endif
+
+# Publish several BoltLockTrait instances, and/or log the trait catalog cost
+# per lock for 32 and 128 locks at startup:
+#   $ make APP=lock PLATFORM=posix [LOCK_INSTANCE_COUNT=<count>] [CATALOG_BENCHMARK=1]
+ifdef LOCK_INSTANCE_COUNT
+DEFINES += \
+    LOCK_INSTANCE_COUNT=$(LOCK_INSTANCE_COUNT)
+endif
+ifeq ($(CATALOG_BENCHMARK),1)
+DEFINES += \
+    LOCK_CATALOG_BENCHMARK=1
+endif
+
+# Log the BoltLockTrait notify encode cost for 1, 4 and 8 subscribers at startup:
+#   $ make APP=lock PLATFORM=posix FANOUT_BENCHMARK=1
+ifeq ($(FANOUT_BENCHMARK),1)
+DEFINES += \
+    BOLT_LOCK_TRAIT_FANOUT_BENCHMARK=1
+endif
+
+# Log the event serialization cost with the field descriptors and with the
+# direct serializers at startup. Every event logged is checked against its
+# field descriptors unless EVENT_SELF_CHECK=0:
+#   $ make APP=<app> PLATFORM=posix [EVENT_BENCHMARK=1] [EVENT_SELF_CHECK=0]
+ifeq ($(EVENT_BENCHMARK),1)
+DEFINES += \
+    EVENT_SERIALIZER_BENCHMARK=1
+endif
+ifneq ($(EVENT_SELF_CHECK),0)
+DEFINES += \
+    EVENT_SERIALIZER_SELF_CHECK=1
+endif
+
+# Log the cost of persisting 1000 events and of reading them back for their
+# offload at startup, with pages large enough to hold them all:
+#   $ make APP=<app> PLATFORM=posix EVENT_LOG_BENCHMARK=1
+ifeq ($(EVENT_LOG_BENCHMARK),1)
+DEFINES += \
+    PERSISTED_EVENT_LOG_BENCHMARK=1 \
+    PERSISTED_EVENT_LOG_PAGE_SIZE=1024 \
+    PERSISTED_EVENT_LOG_PAGE_COUNT=48
+endif
+
+# Toggle the sensor <count> times, 50 ms apart, once the event loop runs and log
+# the space its events take in the persisted event log:
+#   $ make APP=ocsensor PLATFORM=posix EVENT_STORM=<count>
+ifdef EVENT_STORM
+DEFINES += \
+    OCSENSOR_EVENT_STORM_COUNT=$(EVENT_STORM)
+endif
+
+ifdef DEVICE_FIRMWARE_REVISION
+DEFINES += \
+    WEAVE_DEVICE_CONFIG_DEVICE_FIRMWARE_REVISION=\"$(DEVICE_FIRMWARE_REVISION)\"
+endif
+
+CPPFLAGS += $(foreach dir,$(INC_DIRS),-I$(dir)) $(foreach def,$(DEFINES),-D$(def))
+CFLAGS   += -g -O0 -Wall -pthread
+CXXFLAGS += -g -O0 -Wall -pthread -std=gnu++11 -fno-rtti
+LDFLAGS  += -pthread -L$(OPENWEAVE_INSTALL_DIR)/lib
+LDLIBS   += -lDeviceLayer -lWeave -lWarm -lInetLayer -lSystemLayer -lnlfaultinjection -lssl -lcrypto -lrt
+
+OPENWEAVE_CONFIGURE_OPTIONS = \
+    --prefix=$(OPENWEAVE_INSTALL_DIR) \
+    --with-device-layer=linux \
+    --with-weave-project-includes=$(dir $(OPENWEAVE_PROJECT_CONFIG)) \
+    --disable-tests \
+    --disable-tools \
+    --disable-docs
+
+OBJS = $(patsubst $(PROJECT_ROOT)/%,$(OBJS_DIR)/%.o,$(SRCS))
+
+.PHONY : all check clean openweave
+
+all : $(OUTPUT_DIR)/$(APP)
+
+$(OUTPUT_DIR)/$(APP) : $(OBJS)
+	$(CXX) $(LDFLAGS) -o $@ $^ $(LDLIBS)
+
+$(OBJS) : $(OPENWEAVE_STAMP)
+
+$(OBJS_DIR)/%.c.o : $(PROJECT_ROOT)/%.c
+	@mkdir -p $(dir $@)
+	$(CC) $(CPPFLAGS) $(CFLAGS) -c -o $@ $<
+
+$(OBJS_DIR)/%.cpp.o : $(PROJECT_ROOT)/%.cpp
+	@mkdir -p $(dir $@)
+	$(CXX) $(CPPFLAGS) $(CXXFLAGS) -c -o $@ $<
+
+openweave : $(OPENWEAVE_STAMP)
+
+$(OPENWEAVE_STAMP) :
+	@mkdir -p $(OPENWEAVE_BUILD_DIR)
+	test -x $(OPENWEAVE_ROOT)/configure || (cd $(OPENWEAVE_ROOT) && ./bootstrap)
+	cd $(OPENWEAVE_BUILD_DIR) && $(OPENWEAVE_ROOT)/configure $(OPENWEAVE_CONFIGURE_OPTIONS) \
+	    CPPFLAGS="-DWEAVE_DEVICE_CONFIG_ENABLE_WOBLE=0"
+	$(MAKE) -C $(OPENWEAVE_BUILD_DIR)
+	$(MAKE) -C $(OPENWEAVE_BUILD_DIR) install
+	touch $@
+
+# Unit tests of the code that does not depend on OpenWeave or FreeRTOS, built
+# and run on the host:
+#   $ make PLATFORM=posix check
+TESTS_DIR = $(PROJECT_ROOT)/build-posix/tests
+
+TESTS = \
+    $(TESTS_DIR)/TestRttEstimator
+
+$(TESTS_DIR)/TestRttEstimator : $(PROJECT_ROOT)/src/common/tests/TestRttEstimator.cpp $(PROJECT_ROOT)/src/common/RttEstimator.cpp
+	@mkdir -p $(dir $@)
+	$(CXX) $(CXXFLAGS) -I$(PROJECT_ROOT)/src/common/include -o $@ $^
+
+check : $(TESTS)
+	@for test in $(TESTS); do $$test || exit 1; done
+
+clean :
+	rm -rf $(OUTPUT_DIR)
@@ -242,10 +242,7 @@ void AppSoftwareUpdateManager::HandleSoftwareUpdateEvent(void * apAppState, Soft
 
         // FIXME: Which task are we on when this executes? Weave task?
         // Do we really have to post an event to the AppTask?
-        AppTask::AppTaskEvent event;
-        event.Handler = InstallEventHandler;
-        event.Data    = nullptr;
-        GetAppTask().PostEvent(&event);
+        GetAppTask().PostEvent(InstallEventHandler);
 
         break;
     }
@@ -16,12 +16,18 @@
  */
 
 #include "AppTask.h"
+#include "AppTaskStats.h"
 
 #include "app_config.h"
 #include "app_timer.h"
 
 #include "FreeRTOS.h"
 
+#include <inttypes.h>
+#if APP_USE_STATIC_ALLOCATION
+#include <malloc.h>
+#endif
+
 #include <Weave/Profiles/WeaveProfiles.h>
 #include <Weave/Support/crypto/HashAlgos.h>
 #include <Weave/DeviceLayer/SoftwareUpdateManager.h>
@@ -32,15 +38,52 @@
 using namespace ::nl::Weave::TLV;
 using namespace ::nl::Weave::DeviceLayer;
 
+#ifndef APP_TASK_STACK_SIZE
 #define APP_TASK_STACK_SIZE (4096)
+#endif
 #define APP_TASK_PRIORITY 2
-#define APP_EVENT_QUEUE_SIZE 10
+
+// Depth of each event lane (see AppTask::EventLane_t).
+#ifndef APP_EVENT_QUEUE_SIZE_ACTUATOR
+#define APP_EVENT_QUEUE_SIZE_ACTUATOR 4
+#endif
+#ifndef APP_EVENT_QUEUE_SIZE_COMMAND
+#define APP_EVENT_QUEUE_SIZE_COMMAND 6
+#endif
+#ifndef APP_EVENT_QUEUE_SIZE_UI
+#define APP_EVENT_QUEUE_SIZE_UI 10
+#endif
+
+// How often the AppTask statistics are logged. Only checked when the task is
+// awake anyway, so logging never causes a wakeup by itself.
+#define APP_TASK_STATS_LOG_INTERVAL_MS (60 * 60 * 1000)
 
 static TaskHandle_t sAppTaskHandle;
-static QueueHandle_t sAppEventQueue;
+static QueueHandle_t sAppEventQueues[AppTask::kEventLane_Count];
+
+static const UBaseType_t sAppEventQueueSizes[AppTask::kEventLane_Count] = {
+    APP_EVENT_QUEUE_SIZE_ACTUATOR,
+    APP_EVENT_QUEUE_SIZE_COMMAND,
+    APP_EVENT_QUEUE_SIZE_UI,
+};
+
+static const char * const sAppEventLaneNames[AppTask::kEventLane_Count] = {
+    "actuator",
+    "command",
+    "ui",
+};
 
 static SemaphoreHandle_t sWeaveEventLock;
 
+#if APP_USE_STATIC_ALLOCATION
+static StackType_t sAppTaskStack[APP_TASK_STACK_SIZE / sizeof(StackType_t)];
+static StaticTask_t sAppTaskStruct;
+static uint8_t sAppEventQueueStorage[(APP_EVENT_QUEUE_SIZE_ACTUATOR + APP_EVENT_QUEUE_SIZE_COMMAND + APP_EVENT_QUEUE_SIZE_UI) *
+                                     sizeof(AppTask::AppTaskEvent)];
+static StaticQueue_t sAppEventQueueStructs[AppTask::kEventLane_Count];
+static StaticSemaphore_t sWeaveEventLockStruct;
+#endif // APP_USE_STATIC_ALLOCATION
+
 namespace nl {
 namespace Weave {
 namespace Profiles {
@@ -71,6 +114,42 @@ AppTask AppTask::sAppTask;
 
 // Static data members
 AppTask::EventLoopCycleCallback_t AppTask::sEventLoopCycleCallback;
+uint32_t AppTask::sWakeupCount;
+uint64_t AppTask::sStartTimeMs;
+uint64_t AppTask::sLastStatsLogTimeMs;
+AppTask::LaneStats AppTask::sLaneStats[kEventLane_Count];
+
+// Converts a deadline returned by the event loop callback to a queue wait time.
+// Rounds up so that a short deadline never turns into a busy loop.
+static TickType_t DeadlineToTicks(uint32_t deadlineMs)
+{
+    if (deadlineMs == APP_EVENT_LOOP_NO_DEADLINE)
+    {
+        return portMAX_DELAY;
+    }
+
+    uint64_t ticks = (((uint64_t) deadlineMs * configTICK_RATE_HZ) + 999) / 1000;
+    return (ticks < portMAX_DELAY) ? (TickType_t) ticks : (portMAX_DELAY - 1);
+}
+
+#if APP_USE_STATIC_ALLOCATION
+// Called once boot is complete. With the application's kernel objects in static
+// storage, what remains on the heap belongs to the Weave/OpenThread/mbedTLS stacks.
+// Dies if APP_BOOT_HEAP_BUDGET_BYTES is defined and exceeded.
+static void CheckBootHeapUsage(void)
+{
+    struct mallinfo info = mallinfo();
+
+    WeaveLogProgress(Support, "Heap in use after boot: %u bytes", (unsigned) info.uordblks);
+#ifdef APP_BOOT_HEAP_BUDGET_BYTES
+    if ((size_t) info.uordblks > APP_BOOT_HEAP_BUDGET_BYTES)
+    {
+        WeaveLogError(Support, "Heap in use after boot exceeds budget of %u bytes", (unsigned) APP_BOOT_HEAP_BUDGET_BYTES);
+        WeaveDie();
+    }
+#endif
+}
+#endif // APP_USE_STATIC_ALLOCATION
 
 // -----------------------------------------------------------------------------
 // AppTask Lifecycle
@@ -79,16 +158,35 @@ int AppTask::StartAppTask(EventLoopCycleCallback_t eventLoopCycleCallback)
 {
     sEventLoopCycleCallback = eventLoopCycleCallback;
 
-    sAppEventQueue = xQueueCreate(APP_EVENT_QUEUE_SIZE, sizeof(AppTaskEvent));
-    if (sAppEventQueue == NULL)
+#if APP_USE_STATIC_ALLOCATION
+    uint8_t * queueStorage = sAppEventQueueStorage;
+#endif
+
+    for (int lane = 0; lane < kEventLane_Count; lane++)
     {
-        WeaveLogError(Support, "Failed to allocate app event queue");
-        return WEAVE_ERROR_INCORRECT_STATE;
+#if APP_USE_STATIC_ALLOCATION
+        sAppEventQueues[lane] =
+            xQueueCreateStatic(sAppEventQueueSizes[lane], sizeof(AppTaskEvent), queueStorage, &sAppEventQueueStructs[lane]);
+        queueStorage += sAppEventQueueSizes[lane] * sizeof(AppTaskEvent);
+#else
+        sAppEventQueues[lane] = xQueueCreate(sAppEventQueueSizes[lane], sizeof(AppTaskEvent));
+#endif
+        if (sAppEventQueues[lane] == NULL)
+        {
+            WeaveLogError(Support, "Failed to allocate app event queue (%s)", sAppEventLaneNames[lane]);
+            return WEAVE_ERROR_INCORRECT_STATE;
+        }
     }
 
     // Start App task.
+#if APP_USE_STATIC_ALLOCATION
+    sAppTaskHandle = xTaskCreateStatic(AppTaskMain, "APP", sizeof(sAppTaskStack) / sizeof(StackType_t), NULL, APP_TASK_PRIORITY,
+                                       sAppTaskStack, &sAppTaskStruct);
+    if (sAppTaskHandle == NULL)
+#else
     if (xTaskCreate(AppTaskMain, "APP", APP_TASK_STACK_SIZE / sizeof(StackType_t), NULL, APP_TASK_PRIORITY, &sAppTaskHandle) !=
         pdPASS)
+#endif
     {
         WeaveLogError(Support, "Failed to create the task.");
         return WEAVE_ERROR_INCORRECT_STATE;
@@ -109,7 +207,11 @@ int AppTask::Init()
         return ret;
     }
 
+#if APP_USE_STATIC_ALLOCATION
+    sWeaveEventLock = xSemaphoreCreateMutexStatic(&sWeaveEventLockStruct);
+#else
     sWeaveEventLock = xSemaphoreCreateMutex();
+#endif
     if (sWeaveEventLock == NULL)
     {
         WeaveLogError(Support, "xSemaphoreCreateMutex() failed.");
@@ -122,43 +224,226 @@ int AppTask::Init()
 void AppTask::AppTaskMain(void * pvParameter)
 {
     WEAVE_ERROR ret;
-    AppTaskEvent event;
+
+    uint32_t deadlineMs = 0; // Run the callback once right away.
 
     ret = sAppTask.Init();
     SuccessOrAbort(ret, "AppTask.Init() failed.");
 
+#if APP_USE_STATIC_ALLOCATION
+    CheckBootHeapUsage();
+#endif
+
+    sStartTimeMs        = ::nl::Weave::System::Platform::Layer::GetClock_MonotonicMS();
+    sLastStatsLogTimeMs = sStartTimeMs;
+
     while (true)
     {
-        BaseType_t eventReceived = xQueueReceive(sAppEventQueue, &event, pdMS_TO_TICKS(10));
-        while (eventReceived == pdTRUE)
+        // Sleep until an event is posted (PostEvent notifies the task) or the
+        // callback's deadline is reached. With no deadline, the task blocks
+        // indefinitely and the idle task can suppress the tick (configUSE_TICKLESS_IDLE).
+        ulTaskNotifyTake(pdTRUE, DeadlineToTicks(deadlineMs));
+        sWakeupCount++;
+
+        while (DispatchNextEvent())
         {
-            sAppTask.DispatchEvent(&event);
-            eventReceived = xQueueReceive(sAppEventQueue, &event, 0);
         }
         // Invoke the callback.
-        sEventLoopCycleCallback();
+        deadlineMs = sEventLoopCycleCallback();
+
+        LogStats();
+    }
+}
+
+// Dispatches one event from the highest priority lane that is not empty.
+// Returns false when all lanes are empty.
+bool AppTask::DispatchNextEvent(void)
+{
+    AppTaskEvent event;
+
+    for (int lane = 0; lane < kEventLane_Count; lane++)
+    {
+        if (xQueueReceive(sAppEventQueues[lane], &event, 0) == pdTRUE)
+        {
+            sAppTask.DispatchEvent(&event, static_cast<EventLane_t>(lane));
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+// Statistics
+
+uint32_t AppTask::GetWakeupCount(void)
+{
+    return sWakeupCount;
+}
+
+uint32_t AppTask::GetWakeupsPerHour(void)
+{
+    uint64_t uptimeMs = ::nl::Weave::System::Platform::Layer::GetClock_MonotonicMS() - sStartTimeMs;
+
+    if (uptimeMs == 0)
+    {
+        return 0;
+    }
+
+    return (uint32_t)(((uint64_t) sWakeupCount * 3600000) / uptimeMs);
+}
+
+void AppTask::GetLaneStats(EventLane_t lane, LaneStats & stats)
+{
+    taskENTER_CRITICAL();
+    stats = sLaneStats[lane];
+    taskEXIT_CRITICAL();
+}
+
+void AppTask::LogStats(void)
+{
+    uint64_t nowMs = ::nl::Weave::System::Platform::Layer::GetClock_MonotonicMS();
+
+    if (nowMs - sLastStatsLogTimeMs < APP_TASK_STATS_LOG_INTERVAL_MS)
+    {
+        return;
+    }
+    sLastStatsLogTimeMs = nowMs;
+
+    WeaveLogProgress(Support, "AppTask wakeups: %" PRIu32 " total, %" PRIu32 " per hour", sWakeupCount,
+                     sAppTask.GetWakeupsPerHour());
+
+    for (int lane = 0; lane < kEventLane_Count; lane++)
+    {
+        LaneStats stats;
+        sAppTask.GetLaneStats(static_cast<EventLane_t>(lane), stats);
+        WeaveLogProgress(Support,
+                         "AppTask lane %s: %" PRIu32 " dispatched, %" PRIu32 " dropped, high-water %" PRIu32 ", latency avg %" PRIu32
+                         " ms, max %" PRIu32 " ms",
+                         sAppEventLaneNames[lane], stats.DispatchCount, stats.DropCount, stats.HighWaterMark,
+                         (stats.DispatchCount != 0) ? (uint32_t)(stats.TotalLatencyMs / stats.DispatchCount) : 0,
+                         stats.MaxLatencyMs);
     }
+
+    GetAppTaskStats().LogStats();
 }
 
 // -----------------------------------------------------------------------------
 // Events Management
 
-void AppTask::PostEvent(const AppTaskEvent * event)
+bool AppTask::PostEvent(AppTaskEvent * event, EventLane_t lane)
 {
-    if (sAppEventQueue != NULL)
+    if (sAppEventQueues[lane] == NULL)
     {
-        if (!xQueueSend(sAppEventQueue, event, 1))
-        {
-            WeaveLogError(Support, "Failed to post event to app task event queue");
-        }
+        return false;
     }
+
+    event->PostedTimeUs  = (uint32_t)::nl::Weave::System::Platform::Layer::GetClock_MonotonicHiRes();
+    event->PostedFromISR = false;
+    if (!xQueueSend(sAppEventQueues[lane], event, 1))
+    {
+        taskENTER_CRITICAL();
+        sLaneStats[lane].DropCount++;
+        taskEXIT_CRITICAL();
+        WeaveLogError(Support, "Failed to post event to app task event queue (%s)", sAppEventLaneNames[lane]);
+        return false;
+    }
+
+    UBaseType_t depth = uxQueueMessagesWaiting(sAppEventQueues[lane]);
+    taskENTER_CRITICAL();
+    if (depth > sLaneStats[lane].HighWaterMark)
+    {
+        sLaneStats[lane].HighWaterMark = depth;
+    }
+    taskEXIT_CRITICAL();
+
+    // Wake up the AppTask. Notifications are counted, so none is lost
+    // while the task is busy dispatching.
+    if (sAppTaskHandle != NULL)
+    {
+        xTaskNotifyGive(sAppTaskHandle);
+    }
+
+    return true;
+}
+
+bool AppTask::PostEvent(AppTaskEventHandler_t handler, EventLane_t lane)
+{
+    AppTaskEvent event;
+    event.Handler = handler;
+    return PostEvent(&event, lane);
 }
 
-void AppTask::DispatchEvent(const AppTaskEvent * event)
+void AppTask::PostEventFromISR(AppTaskEvent * event, EventLane_t lane)
 {
+    BaseType_t taskWoken = pdFALSE;
+    UBaseType_t interruptStatus;
+
+    if (sAppEventQueues[lane] == NULL)
+    {
+        return;
+    }
+
+    // The hi-res clock is not interrupt safe: stamp the event with the tick count instead.
+    event->PostedTick    = xTaskGetTickCountFromISR();
+    event->PostedFromISR = true;
+    if (!xQueueSendFromISR(sAppEventQueues[lane], event, &taskWoken))
+    {
+        // No logging from interrupt context; the drop shows in the lane stats.
+        interruptStatus = taskENTER_CRITICAL_FROM_ISR();
+        sLaneStats[lane].DropCount++;
+        taskEXIT_CRITICAL_FROM_ISR(interruptStatus);
+        return;
+    }
+
+    UBaseType_t depth = uxQueueMessagesWaitingFromISR(sAppEventQueues[lane]);
+    interruptStatus   = taskENTER_CRITICAL_FROM_ISR();
+    if (depth > sLaneStats[lane].HighWaterMark)
+    {
+        sLaneStats[lane].HighWaterMark = depth;
+    }
+    taskEXIT_CRITICAL_FROM_ISR(interruptStatus);
+
+    if (sAppTaskHandle != NULL)
+    {
+        vTaskNotifyGiveFromISR(sAppTaskHandle, &taskWoken);
+    }
+    portYIELD_FROM_ISR(taskWoken);
+}
+
+void AppTask::DispatchEvent(const AppTaskEvent * event, EventLane_t lane)
+{
+    uint64_t dispatchTimeUs = ::nl::Weave::System::Platform::Layer::GetClock_MonotonicHiRes();
+    uint32_t latencyUs;
+    uint32_t latencyMs;
+
+    if (event->PostedFromISR)
+    {
+        latencyUs = (uint32_t)(((uint64_t)(xTaskGetTickCount() - event->PostedTick) * 1000000) / configTICK_RATE_HZ);
+    }
+    else
+    {
+        latencyUs = (uint32_t) dispatchTimeUs - event->PostedTimeUs;
+    }
+    latencyMs = latencyUs / 1000;
+
+    taskENTER_CRITICAL();
+    LaneStats & stats = sLaneStats[lane];
+    stats.DispatchCount++;
+    stats.TotalLatencyMs += latencyMs;
+    if (latencyMs > stats.MaxLatencyMs)
+    {
+        stats.MaxLatencyMs = latencyMs;
+    }
+    taskEXIT_CRITICAL();
+
     if (event->Handler)
     {
-        event->Handler(event->Data);
+        // The handler may modify the data in place; it is our copy.
+        event->Handler(const_cast<uint8_t *>(event->Payload.Bytes));
+
+        uint32_t runtimeUs = (uint32_t)(::nl::Weave::System::Platform::Layer::GetClock_MonotonicHiRes() - dispatchTimeUs);
+        GetAppTaskStats().RecordDispatch(event->Handler, latencyUs, runtimeUs);
     }
     else
     {
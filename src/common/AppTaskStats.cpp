@@ -0,0 +1,175 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "AppTaskStats.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <Weave/DeviceLayer/WeaveDeviceLayer.h>
+
+// Singleton.
+AppTaskStats AppTaskStats::sAppTaskStats;
+
+// -----------------------------------------------------------------------------
+// Recording
+
+void AppTaskStats::RecordDispatch(AppTask::AppTaskEventHandler_t handler, uint32_t queueLatencyUs, uint32_t runtimeUs)
+{
+    // Only the AppTask adds entries, so the lookup and the bucket computation
+    // need no lock. Interrupts are only masked for the counter updates.
+    HandlerStats * entry  = FindOrAddHandler(handler);
+    uint8_t queueBucket   = GetBucket(queueLatencyUs);
+    uint8_t runtimeBucket = GetBucket(runtimeUs);
+
+    taskENTER_CRITICAL();
+    // Drop the sample if Reset() cleared the entry since the lookup.
+    if (entry->Handler == handler || entry == &mHandlers[APP_TASK_STATS_MAX_HANDLERS])
+    {
+        entry->DispatchCount++;
+        RecordValue(entry->QueueLatency, queueBucket, queueLatencyUs);
+        RecordValue(entry->Runtime, runtimeBucket, runtimeUs);
+    }
+    taskEXIT_CRITICAL();
+}
+
+AppTaskStats::HandlerStats * AppTaskStats::FindOrAddHandler(AppTask::AppTaskEventHandler_t handler)
+{
+    for (uint8_t i = 0; i < mHandlerCount; i++)
+    {
+        if (mHandlers[i].Handler == handler)
+        {
+            return &mHandlers[i];
+        }
+    }
+
+    if (mHandlerCount < APP_TASK_STATS_MAX_HANDLERS)
+    {
+        // The entry past the count is not read by the accessors until the count covers it.
+        HandlerStats * entry = &mHandlers[mHandlerCount];
+        memset(entry, 0, sizeof(*entry));
+        entry->Handler = handler;
+
+        taskENTER_CRITICAL();
+        if (entry == &mHandlers[mHandlerCount]) // Not if Reset() ran meanwhile.
+        {
+            mHandlerCount++;
+        }
+        taskEXIT_CRITICAL();
+        return entry;
+    }
+
+    // Table full: account in the shared "other" entry.
+    return &mHandlers[APP_TASK_STATS_MAX_HANDLERS];
+}
+
+uint8_t AppTaskStats::GetBucket(uint32_t valueUs)
+{
+    uint8_t bucket = 0;
+
+    while (valueUs != 0 && bucket < APP_TASK_STATS_HISTOGRAM_BUCKETS - 1)
+    {
+        valueUs >>= 1;
+        bucket++;
+    }
+
+    return bucket;
+}
+
+void AppTaskStats::RecordValue(Histogram & histogram, uint8_t bucket, uint32_t valueUs)
+{
+    histogram.Buckets[bucket]++;
+    if (valueUs > histogram.MaxUs)
+    {
+        histogram.MaxUs = valueUs;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Accessors
+
+uint8_t AppTaskStats::GetHandlerCount(void)
+{
+    // Handler entries followed by the shared "other" entry.
+    return mHandlerCount + 1;
+}
+
+bool AppTaskStats::GetHandlerStats(uint8_t index, HandlerStats & stats)
+{
+    if (index > mHandlerCount)
+    {
+        return false;
+    }
+
+    taskENTER_CRITICAL();
+    stats = (index == mHandlerCount) ? mHandlers[APP_TASK_STATS_MAX_HANDLERS] : mHandlers[index];
+    taskEXIT_CRITICAL();
+
+    return true;
+}
+
+void AppTaskStats::Reset(void)
+{
+    taskENTER_CRITICAL();
+    memset(mHandlers, 0, sizeof(mHandlers));
+    mHandlerCount = 0;
+    taskEXIT_CRITICAL();
+}
+
+// -----------------------------------------------------------------------------
+// Logging
+
+void AppTaskStats::LogStats(void)
+{
+    HandlerStats stats;
+
+    for (uint8_t i = 0; i < GetHandlerCount(); i++)
+    {
+        if (!GetHandlerStats(i, stats) || stats.DispatchCount == 0)
+        {
+            continue;
+        }
+
+        WeaveLogProgress(Support, "AppTask handler %p: %" PRIu32 " dispatched, queue max %" PRIu32 " us, run max %" PRIu32 " us",
+                         (void *) stats.Handler, stats.DispatchCount, stats.QueueLatency.MaxUs, stats.Runtime.MaxUs);
+        LogHistogram("queue", stats.QueueLatency);
+        LogHistogram("run", stats.Runtime);
+    }
+}
+
+// Logs the non-empty buckets as "<bucket>:<count>" pairs.
+void AppTaskStats::LogHistogram(const char * name, const Histogram & histogram)
+{
+    char buf[160];
+    size_t len = 0;
+
+    for (uint8_t bucket = 0; bucket < APP_TASK_STATS_HISTOGRAM_BUCKETS && len < sizeof(buf); bucket++)
+    {
+        if (histogram.Buckets[bucket] != 0)
+        {
+            len += snprintf(&buf[len], sizeof(buf) - len, " %u:%" PRIu32, bucket, histogram.Buckets[bucket]);
+        }
+    }
+    buf[(len < sizeof(buf)) ? len : sizeof(buf) - 1] = '\0';
+
+    WeaveLogProgress(Support, "  %s log2(us) histogram:%s", name, buf);
+}
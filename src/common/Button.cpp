@@ -18,8 +18,16 @@
 
 #include "AppTask.h"
 #include "Button.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <inttypes.h>
+
 #include <Weave/DeviceLayer/WeaveDeviceLayer.h>
 
+uint32_t Button::sMaxEdgeLatencyMs;
+
 void Button::Init()
 {
     mButtonPressState     = kButtonPressState_Inactive;
@@ -47,7 +55,13 @@ void Button::PhysicalButtonEventHandler(void * eventData)
     PhysicalButtonAppTaskEventData * data     = static_cast<PhysicalButtonAppTaskEventData *>(eventData);
     Button * _this                            = static_cast<Button *>(data->ButtonPtr);
     PhysicalButtonAction physicalButtonAction = data->Action;
-    WeaveLogProgress(Support, "Button::PhysicalButtonEventHandler: Action [%d].", physicalButtonAction);
+    uint32_t edgeLatencyMs                    = ((xTaskGetTickCount() - data->EdgeTick) * 1000) / configTICK_RATE_HZ;
+    if (edgeLatencyMs > sMaxEdgeLatencyMs)
+    {
+        sMaxEdgeLatencyMs = edgeLatencyMs;
+    }
+    WeaveLogProgress(Support, "Button::PhysicalButtonEventHandler: Action [%d], edge latency %" PRIu32 " ms.",
+                     physicalButtonAction, edgeLatencyMs);
 
     if (physicalButtonAction == kPhysicalButtonAction_Press)
     {
@@ -124,6 +138,31 @@ Button::ButtonPressState Button::UpdateButtonPressState(void)
     return mButtonPressState;
 }
 
+uint32_t Button::GetNextPressStateDeadlineMs(void)
+{
+    uint64_t thresholdMs;
+
+    switch (mButtonPressState)
+    {
+    case kButtonPressState_Short:
+        thresholdMs = LONG_PRESS_ACTIVATION_START_MS;
+        break;
+    case kButtonPressState_Long_Started:
+        thresholdMs = LONG_PRESS_ACTIVATION_COMPLETE_MS;
+        break;
+    default:
+        return APP_EVENT_LOOP_NO_DEADLINE;
+    }
+
+    uint64_t elapsedMs = ::nl::Weave::System::Platform::Layer::GetClock_MonotonicMS() - mButtonPressStartedMs;
+    return (elapsedMs >= thresholdMs) ? 0 : (uint32_t)(thresholdMs - elapsedMs);
+}
+
+uint32_t Button::GetMaxEdgeLatencyMs(void)
+{
+    return sMaxEdgeLatencyMs;
+}
+
 void Button::EndButtonPress()
 {
     WeaveLogProgress(Support, "Button::EndButtonPress()");
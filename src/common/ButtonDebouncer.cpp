@@ -0,0 +1,140 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "ButtonDebouncer.h"
+#include "AppTask.h"
+
+#include <task.h>
+
+#include <Weave/DeviceLayer/WeaveDeviceLayer.h>
+
+int ButtonDebouncer::Init(Button * buttons, uint8_t buttonCount, uint32_t lockoutMs, ReadButtonFunct_t readButton)
+{
+    if (buttonCount > BUTTON_DEBOUNCER_MAX_BUTTONS)
+    {
+        WeaveLogError(Support, "ButtonDebouncer: too many buttons (%u)", buttonCount);
+        return WEAVE_ERROR_INVALID_ARGUMENT;
+    }
+
+    mButtons      = buttons;
+    mButtonCount  = buttonCount;
+    mLockoutTicks = pdMS_TO_TICKS(lockoutMs);
+    mReadButton   = readButton;
+
+    for (uint8_t i = 0; i < mButtonCount; i++)
+    {
+        ButtonState & state = mStates[i];
+
+        state.Debouncer = this;
+        state.Index     = i;
+        state.Pressed   = false;
+        // Accept the very first edge.
+        state.LastReportedTick = xTaskGetTickCount() - mLockoutTicks;
+        state.LastEdgeTick     = state.LastReportedTick;
+
+        // One-shot timer that re-samples the pin at the end of the lockout.
+#if APP_USE_STATIC_ALLOCATION
+        state.SettleTimer =
+            xTimerCreateStatic("BtnSettle", mLockoutTicks, pdFALSE, &state, SettleTimerCallback, &state.SettleTimerStruct);
+#else
+        state.SettleTimer = xTimerCreate("BtnSettle", mLockoutTicks, pdFALSE, &state, SettleTimerCallback);
+#endif
+        if (state.SettleTimer == NULL)
+        {
+            WeaveLogError(Support, "ButtonDebouncer: xTimerCreate() failed");
+            return WEAVE_ERROR_NO_MEMORY;
+        }
+    }
+
+    return WEAVE_NO_ERROR;
+}
+
+Button::PhysicalButtonAppTaskEventData ButtonDebouncer::MakeEventData(ButtonState & state)
+{
+    Button::PhysicalButtonAppTaskEventData data;
+
+    data.ButtonPtr = &mButtons[state.Index];
+    data.Action    = state.Pressed ? Button::kPhysicalButtonAction_Press : Button::kPhysicalButtonAction_Release;
+    data.EdgeTick  = state.LastEdgeTick;
+
+    return data;
+}
+
+// -----------------------------------------------------------------------------
+// Interrupt context
+
+void ButtonDebouncer::OnEdgeFromISR(uint8_t buttonIndex, bool pressed)
+{
+    if (buttonIndex >= mButtonCount)
+    {
+        return;
+    }
+
+    ButtonState & state = mStates[buttonIndex];
+    TickType_t now      = xTaskGetTickCountFromISR();
+
+    state.LastEdgeTick = now;
+
+    if ((TickType_t)(now - state.LastReportedTick) < mLockoutTicks)
+    {
+        // Bounce. Check the level again once the line has settled.
+        BaseType_t taskWoken = pdFALSE;
+        xTimerResetFromISR(state.SettleTimer, &taskWoken);
+        portYIELD_FROM_ISR(taskWoken);
+        return;
+    }
+
+    if (pressed == state.Pressed)
+    {
+        // Missed the opposite edge; nothing changed from the AppTask's point of view.
+        return;
+    }
+
+    state.Pressed          = pressed;
+    state.LastReportedTick = now;
+
+    GetAppTask().PostEventFromISR(Button::PhysicalButtonEventHandler, MakeEventData(state));
+}
+
+// -----------------------------------------------------------------------------
+// Timer task context
+
+void ButtonDebouncer::SettleTimerCallback(TimerHandle_t timer)
+{
+    ButtonState & state         = *static_cast<ButtonState *>(pvTimerGetTimerID(timer));
+    ButtonDebouncer & debouncer = *state.Debouncer;
+    bool pressed                = debouncer.mReadButton(state.Index);
+    bool changed                = false;
+    Button::PhysicalButtonAppTaskEventData data;
+
+    // The GPIO interrupt may update the state concurrently.
+    taskENTER_CRITICAL();
+    if (pressed != state.Pressed)
+    {
+        state.Pressed          = pressed;
+        state.LastReportedTick = xTaskGetTickCount();
+        data                   = debouncer.MakeEventData(state);
+        changed                = true;
+    }
+    taskEXIT_CRITICAL();
+
+    if (changed)
+    {
+        GetAppTask().PostEvent(Button::PhysicalButtonEventHandler, data);
+    }
+}
@@ -0,0 +1,104 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "CachedTraitDataSource.h"
+
+using namespace ::nl::Weave::Profiles::DataManagement_Current;
+using namespace ::nl::Weave::TLV;
+
+// Leaves are the handles that follow the root.
+#define FIRST_LEAF_HANDLE (kRootPropertyPathHandle + 1)
+
+CachedTraitDataSource::CachedTraitDataSource(const TraitSchemaEngine * aEngine, uint8_t aLeafCount) :
+    TraitDataSource(aEngine), mLeafCount(aLeafCount), mCacheState(kCacheState_Invalid)
+{}
+
+void CachedTraitDataSource::InvalidateCache(void)
+{
+    mCacheState = kCacheState_Invalid;
+}
+
+WEAVE_ERROR CachedTraitDataSource::GetLeafData(PropertyPathHandle aLeafHandle, uint64_t aTagToWrite, TLVWriter & aWriter)
+{
+    if (mCacheState == kCacheState_Invalid)
+    {
+        WEAVE_ERROR err = BuildCache();
+        if (err != WEAVE_NO_ERROR)
+        {
+            WeaveLogError(Support, "Trait leaf cache not built: %s", ::nl::ErrorStr(err));
+            mCacheState = kCacheState_Unusable;
+        }
+    }
+
+    if (mCacheState == kCacheState_Valid)
+    {
+        return CopyCachedLeaf(aLeafHandle, aTagToWrite, aWriter);
+    }
+
+    return EncodeLeaf(aLeafHandle, aTagToWrite, aWriter);
+}
+
+WEAVE_ERROR CachedTraitDataSource::BuildCache(void)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    TLVWriter writer;
+
+    VerifyOrExit(mLeafCount <= CACHED_TRAIT_DATA_SOURCE_MAX_LEAVES, err = WEAVE_ERROR_BUFFER_TOO_SMALL);
+
+    writer.Init(mCache, sizeof(mCache));
+
+    for (uint8_t i = 0; i < mLeafCount; i++)
+    {
+        uint32_t offset = writer.GetLengthWritten();
+
+        err = EncodeLeaf(FIRST_LEAF_HANDLE + i, AnonymousTag, writer);
+        SuccessOrExit(err);
+
+        mLeafOffsets[i] = (uint8_t) offset;
+        mLeafLengths[i] = (uint8_t)(writer.GetLengthWritten() - offset);
+    }
+
+    err = writer.Finalize();
+    SuccessOrExit(err);
+
+    mCacheState = kCacheState_Valid;
+
+exit:
+    return err;
+}
+
+WEAVE_ERROR CachedTraitDataSource::CopyCachedLeaf(PropertyPathHandle aLeafHandle, uint64_t aTagToWrite, TLVWriter & aWriter)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    uint32_t index  = GetPropertySchemaHandle(aLeafHandle) - FIRST_LEAF_HANDLE;
+    TLVReader reader;
+
+    VerifyOrExit(index < mLeafCount && mLeafLengths[index] != 0, err = WEAVE_NO_ERROR);
+
+    reader.Init(&mCache[mLeafOffsets[index]], mLeafLengths[index]);
+
+    err = reader.Next();
+    SuccessOrExit(err);
+
+    // Re-tags the element; the value bytes are copied as is.
+    err = aWriter.CopyElement(aTagToWrite, reader);
+    SuccessOrExit(err);
+
+exit:
+    return err;
+}
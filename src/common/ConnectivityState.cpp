@@ -15,52 +15,132 @@
  *    limitations under the License.
  */
 
+
 #include "ConnectivityState.h"
+#include "AppTask.h"
 
-#include <Weave/DeviceLayer/WeaveDeviceLayer.h>
+#include <string.h>
 
 using namespace ::nl::Weave::DeviceLayer;
 
-void ConnectivityState::SetLED(LED * aLEDPtr)
+ConnectivityState * ConnectivityState::sInstance;
+
+void ConnectivityState::Init(LED * aLEDPtr, ServiceSubscriptionStateFunct_t areServiceSubscriptionsEstablished)
+{
+    connectivityStateLEDPtr                 = aLEDPtr;
+    areServiceSubscriptionsEstablishedFunct = areServiceSubscriptionsEstablished;
+    sInstance                               = this;
+
+    UpdateLED();
+
+    PlatformMgr().AddEventHandler(PlatformEventHandler, 0);
+
+    // Compute the initial state on the Weave task.
+    PlatformMgr().ScheduleWork(RefreshWork);
+}
+
+void ConnectivityState::SetLEDUpdatesEnabled(bool enabled)
+{
+    isLEDUpdateEnabled = enabled;
+    if (enabled)
+    {
+        UpdateLED();
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Weave task
+
+void ConnectivityState::PlatformEventHandler(const WeaveDeviceEvent * event, intptr_t arg)
+{
+    // Thread, BLE, service connectivity and pairing changes are all signaled
+    // by device events; any of them may change the state.
+    Refresh();
+}
+
+void ConnectivityState::RefreshWork(intptr_t arg)
+{
+    Refresh();
+}
+
+void ConnectivityState::Refresh(void)
 {
-    connectivityStateLEDPtr = aLEDPtr;
+    ConnectivityState * _this = sInstance;
+    Snapshot snapshot;
+
+    if (_this == NULL)
+    {
+        return;
+    }
+
+    // Running on the Weave task: the stack does not need to be locked.
+    snapshot.isThreadProvisioned              = ConnectivityMgr().IsThreadProvisioned();
+    snapshot.isThreadEnabled                  = ConnectivityMgr().IsThreadEnabled();
+    snapshot.isThreadAttached                 = ConnectivityMgr().IsThreadAttached();
+    snapshot.hasBLEConnections                = (ConnectivityMgr().NumBLEConnections() != 0);
+    snapshot.isPairedToAccount                = ConfigurationMgr().IsPairedToAccount();
+    snapshot.hasServiceConnectivity           = ConnectivityMgr().HaveServiceConnectivity();
+    snapshot.isServiceSubscriptionEstablished = _this->areServiceSubscriptionsEstablishedFunct();
+
+    if (_this->hasPublishedSnapshot && memcmp(&snapshot, &_this->publishedSnapshot, sizeof(snapshot)) == 0)
+    {
+        return;
+    }
+
+    // Only a snapshot that reached the AppTask counts as published. If the lane
+    // is full, try again shortly rather than wait for the next device event.
+    if (!GetAppTask().PostEvent(SnapshotEventHandler, snapshot))
+    {
+        SystemLayer.StartTimer(kPostRetryDelayMs, HandleRetryTimer, NULL);
+        return;
+    }
+
+    _this->publishedSnapshot    = snapshot;
+    _this->hasPublishedSnapshot = true;
+}
+
+void ConnectivityState::HandleRetryTimer(::nl::Weave::System::Layer * systemLayer, void * appState,
+                                         ::nl::Weave::System::Error error)
+{
+    Refresh();
+}
+
+// -----------------------------------------------------------------------------
+// AppTask
+
+void ConnectivityState::SnapshotEventHandler(void * data)
+{
+    ConnectivityState * _this = sInstance;
+
+    _this->currentSnapshot = *static_cast<Snapshot *>(data);
+    _this->UpdateLED();
 }
 
-// FIXME: why is it "are" as opposed to "is"
-void ConnectivityState::Update(bool areServiceSubscriptionsEstablished)
+void ConnectivityState::UpdateLED(void)
 {
-    // Because the Weave event loop is being run in a separate task, the stack must be locked
-    // while these values are queried.  However we use a non-blocking lock request
-    // (TryLockWeaveStack()) to avoid blocking other UI activities when the Weave
-    // task is busy (e.g. with a long crypto operation).
-    if (PlatformMgr().TryLockWeaveStack())
+    const Snapshot & s = currentSnapshot;
+
+    if (!isLEDUpdateEnabled)
     {
-        isThreadProvisioned              = ConnectivityMgr().IsThreadProvisioned();
-        isThreadEnabled                  = ConnectivityMgr().IsThreadEnabled();
-        isThreadAttached                 = ConnectivityMgr().IsThreadAttached();
-        hasBLEConnections                = (ConnectivityMgr().NumBLEConnections() != 0);
-        isPairedToAccount                = ConfigurationMgr().IsPairedToAccount();
-        hasServiceConnectivity           = ConnectivityMgr().HaveServiceConnectivity();
-        isServiceSubscriptionEstablished = areServiceSubscriptionsEstablished;
-        PlatformMgr().UnlockWeaveStack();
+        return;
     }
 
     // Consider the system to be "fully connected" if it has service
     // connectivity and it is able to interact with the service on a regular basis.
-    bool isFullyConnected = (hasServiceConnectivity && isServiceSubscriptionEstablished);
+    bool isFullyConnected = (s.hasServiceConnectivity && s.isServiceSubscriptionEstablished);
     if (isFullyConnected)
     {
         // If system has "full connectivity", keep the LED On constantly.
         connectivityStateLEDPtr->Set(true);
     }
-    else if (isThreadProvisioned && isThreadEnabled && isPairedToAccount && (!isThreadAttached || !isFullyConnected))
+    else if (s.isThreadProvisioned && s.isThreadEnabled && s.isPairedToAccount && (!s.isThreadAttached || !isFullyConnected))
     {
         // Thread and service provisioned, but not attached to the thread network yet OR no
         // connectivity to the service OR subscriptions are not fully established
         // THEN blink the LED Off for a short period of time.
         connectivityStateLEDPtr->Blink(950, 50);
     }
-    else if (hasBLEConnections)
+    else if (s.hasBLEConnections)
     {
         // If the system has ble connection(s) uptill the stage above, THEN blink the LEDs at an even
         // rate of 100ms.
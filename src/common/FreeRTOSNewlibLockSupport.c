@@ -28,6 +28,11 @@
 #include "semphr.h"
 #include "task.h"
 
+// Follow the application's static allocation build option unless set explicitly.
+#ifndef USE_STATIC_NEWLIB_MUTEXES
+#define USE_STATIC_NEWLIB_MUTEXES APP_USE_STATIC_ALLOCATION
+#endif
+
 /*
  * Global mutex objects used by newlib.
  */
@@ -0,0 +1,58 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *          Memory for the FreeRTOS idle and timer tasks when the kernel is
+ *          built with configSUPPORT_STATIC_ALLOCATION (APP_USE_STATIC_ALLOCATION).
+ *
+ */
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+
+#if configSUPPORT_STATIC_ALLOCATION
+
+void vApplicationGetIdleTaskMemory(StaticTask_t ** ppxIdleTaskTCBBuffer, StackType_t ** ppxIdleTaskStackBuffer,
+                                   uint32_t * pulIdleTaskStackSize)
+{
+    static StaticTask_t sIdleTaskTCB;
+    static StackType_t sIdleTaskStack[configMINIMAL_STACK_SIZE];
+
+    *ppxIdleTaskTCBBuffer   = &sIdleTaskTCB;
+    *ppxIdleTaskStackBuffer = sIdleTaskStack;
+    *pulIdleTaskStackSize   = configMINIMAL_STACK_SIZE;
+}
+
+#if configUSE_TIMERS
+
+void vApplicationGetTimerTaskMemory(StaticTask_t ** ppxTimerTaskTCBBuffer, StackType_t ** ppxTimerTaskStackBuffer,
+                                    uint32_t * pulTimerTaskStackSize)
+{
+    static StaticTask_t sTimerTaskTCB;
+    static StackType_t sTimerTaskStack[configTIMER_TASK_STACK_DEPTH];
+
+    *ppxTimerTaskTCBBuffer   = &sTimerTaskTCB;
+    *ppxTimerTaskStackBuffer = sTimerTaskStack;
+    *pulTimerTaskStackSize   = configTIMER_TASK_STACK_DEPTH;
+}
+
+#endif // configUSE_TIMERS
+
+#endif // configSUPPORT_STATIC_ALLOCATION
@@ -0,0 +1,1065 @@
+/*
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "GenericWDMFeature.h"
+#include "AppPersistentStorage.h"
+#include "ConnectivityState.h"
+#include "PersistedEventLog.h"
+
+#include <Weave/DeviceLayer/WeaveDeviceLayer.h>
+
+#include "task.h"
+
+#include <algorithm>
+#include <inttypes.h>
+#include <string.h>
+
+using namespace ::nl;
+using namespace ::nl::Inet;
+using namespace ::nl::Weave;
+using namespace ::nl::Weave::DeviceLayer;
+using namespace ::nl::Weave::DeviceLayer::Internal;
+using namespace ::nl::Weave::Profiles::DataManagement_Current;
+
+// TODO: Remove this
+#define kServiceEndpoint_Data_Management 0x18B4300200000003ull ///< Core Weave data management protocol endpoint
+
+/** Defines the timeout for liveness between the service and the device.
+ *  For sleepy end node devices, this timeout will be much larger than the current
+ *  value to preserve battery.
+ */
+#define SERVICE_LIVENESS_TIMEOUT_SEC 60 * 1 // 1 minute
+
+/** Defines the timeout for a response to any message initiated by the device to the service.
+ *  This includes notifies, subscribe confirms, cancels and updates.
+ *  This timeout is kept SERVICE_WRM_MAX_RETRANS x SERVICE_WRM_INITIAL_RETRANS_TIMEOUT_MS + some buffer
+ *  to account for latency in the message transmission through multiple hops.
+ */
+#define SERVICE_MESSAGE_RESPONSE_TIMEOUT_MS 10000
+
+/** Defines the timeout for a message to get retransmitted when no wrm ack or
+ *  response has been heard back from the service. This timeout is kept larger
+ *  for now since the message has to travel through multiple hops and service
+ *  layers before actually making it to the actual receiver.
+ *  @note
+ *    WRM has an initial and active retransmission timeouts to interact with
+ *    sleepy destination nodes. For the time being, the pinna WRM config would
+ *    set both these timeouts to be the same based on the assumption that the pinna
+ *    would not be interacting directly with a sleepy peer.
+ */
+#define SERVICE_WRM_INITIAL_RETRANS_TIMEOUT_MS 2500
+
+#define SERVICE_WRM_ACTIVE_RETRANS_TIMEOUT_MS 2500
+
+/** Define the maximum number of retransmissions in WRM
+ */
+#define SERVICE_WRM_MAX_RETRANS 3
+
+/** Define the timeout for piggybacking a WRM acknowledgment message
+ */
+#define SERVICE_WRM_PIGGYBACK_ACK_TIMEOUT_MS 200
+
+/** Adapt the WRM retransmission timeout of the service bindings to the measured round-trip times
+ *  (RFC 6298 estimator), between SERVICE_WRM_MIN_RETRANS_TIMEOUT_MS and SERVICE_WRM_INITIAL_RETRANS_TIMEOUT_MS.
+ *  The timeout starts at the latter, the worst multi-hop case, until the first ack is timed.
+ */
+#ifndef SERVICE_WRM_ADAPTIVE_RETRANS_TIMEOUT
+#define SERVICE_WRM_ADAPTIVE_RETRANS_TIMEOUT 1
+#endif
+
+/** Lower bound of the adaptive retransmission timeout. Kept above the piggyback ack timeout of
+ *  the service, which delays the acks of messages that get no immediate response.
+ */
+#ifndef SERVICE_WRM_MIN_RETRANS_TIMEOUT_MS
+#define SERVICE_WRM_MIN_RETRANS_TIMEOUT_MS 500
+#endif
+
+/** Clock granularity of the estimator: WRM checks for retransmissions once per timer period.
+ */
+#define SERVICE_WRM_RTT_GRANULARITY_MS WEAVE_CONFIG_WRMP_TIMER_DEFAULT_PERIOD_MSEC
+
+/** Defines the timeout for expecting a subscribe response after sending a subscribe request.
+ *  This is meant to be a gross timeout - the MESSAGE_RESPONSE_TIMEOUT_MS will usually trip first
+ *  to catch timeouts for each message in the subscribe request exchange.
+ *  SUBSCRIPTION_RESPONSE_TIMEOUT_MS > Average no. of notifies during a subscription * MESSAGE_RESPONSE_TIMEOUT_MS
+ */
+#define SUBSCRIPTION_RESPONSE_TIMEOUT_MS 40000
+
+/** Bounds of the decorrelated jitter backoff between attempts to re-establish the service subscription.
+ *  The cap keeps a device from staying unsubscribed for longer than the liveness timeout of the
+ *  subscription after a failed attempt.
+ */
+#ifndef SERVICE_RESUBSCRIBE_BASE_INTERVAL_MS
+#define SERVICE_RESUBSCRIBE_BASE_INTERVAL_MS 1000
+#endif
+
+#ifndef SERVICE_RESUBSCRIBE_MAX_INTERVAL_MS
+#define SERVICE_RESUBSCRIBE_MAX_INTERVAL_MS (SERVICE_LIVENESS_TIMEOUT_SEC * 1000)
+#endif
+
+/** Defines the minimum interval between two logs of the aggregation and PublisherLock counters.
+ */
+#define WDM_STATS_LOG_INTERVAL_MS (60 * 60 * 1000)
+
+const nl::Weave::WRMPConfig gWRMPConfigService = { SERVICE_WRM_INITIAL_RETRANS_TIMEOUT_MS, SERVICE_WRM_ACTIVE_RETRANS_TIMEOUT_MS,
+                                                   SERVICE_WRM_PIGGYBACK_ACK_TIMEOUT_MS, SERVICE_WRM_MAX_RETRANS };
+
+WDMFeatureBase * WDMFeatureBase::sInstance;
+
+SubscriptionEngine * SubscriptionEngine::GetInstance()
+{
+    return &(WDMFeatureBase::sInstance->mSubscriptionEngine);
+}
+
+WDMFeatureBase::WDMFeatureBase(const SourceTraitCatalog::CatalogItem * sourceItems, uint32_t sourceCount,
+                               const SourceTraitCatalog::ItemArray * sourceArrays, uint32_t sourceArrayCount,
+                               const SinkTraitCatalog::CatalogItem * sinkItems, uint32_t sinkCount,
+                               const SinkTraitCatalog::ItemArray * sinkArrays, uint32_t sinkArrayCount,
+                               TraitPath * sinkTraitPaths) :
+    mServiceSinkTraitCatalog(sinkItems, sinkCount, sinkArrays, sinkArrayCount),
+    mServiceSourceTraitCatalog(sourceItems, sourceCount, sourceArrays, sourceArrayCount),
+    mServiceSinkTraitPaths(sinkTraitPaths), mServiceSinkTraitPathCount(sinkCount), mServiceSubClient(NULL),
+    mServiceCounterSubHandler(NULL), mServiceNotifyExchange(NULL), mServiceNotifyResponseHandler(NULL),
+    mServiceSubBinding(NULL), mServiceWRMPConfig(gWRMPConfigService), mRttSampleExchange(NULL), mRttSampleStartMs(0),
+    mRttSampleTimeoutMs(0), mDefaultResubscribePolicy(SERVICE_RESUBSCRIBE_BASE_INTERVAL_MS, SERVICE_RESUBSCRIBE_MAX_INTERVAL_MS),
+    mResubscribePolicy(&mDefaultResubscribePolicy), mSubToServiceLostTimeMs(0), mNextResubscribeTimeMs(0),
+    mResubscribeAttemptCount(0), mHadServiceConnectivity(false), mReattachTimeMs(0), mLocalSubPolicy(kLocalSubPolicy_None),
+    mLocalSubTraitHandle(kNoLocalSubscription), mLocalPeerNodeId(kNodeIdNotSpecified), mPendingChanges(0), mIsHoldTimerArmed(false),
+    mServiceNotifyStartMs(0), mServiceNotifyHasEvents(false), mIsEventHoldTimerArmed(false),
+    mIsSubToServiceEstablished(false), mIsServiceCounterSubEstablished(false), mIsSubToServiceActivated(false)
+{
+    memset(&mAggregationStats, 0, sizeof(mAggregationStats));
+    memset(mPendingEvents, 0, sizeof(mPendingEvents));
+    memset(&mEventOffloadStats, 0, sizeof(mEventOffloadStats));
+    memset(mServiceNotifyEvents, 0, sizeof(mServiceNotifyEvents));
+    memset(mLocalSubHandlers, 0, sizeof(mLocalSubHandlers));
+    memset(&mResubscribeStats, 0, sizeof(mResubscribeStats));
+    mPublishedResubscribeStats.Init(mResubscribeStats);
+    memset(&mConnectStats, 0, sizeof(mConnectStats));
+    mPublishedConnectStats.Init(mConnectStats);
+    mServiceRtt.Init(SERVICE_WRM_MIN_RETRANS_TIMEOUT_MS, SERVICE_WRM_INITIAL_RETRANS_TIMEOUT_MS, SERVICE_WRM_RTT_GRANULARITY_MS);
+    sInstance = this;
+}
+
+// -----------------------------------------------------------------------------
+// Notify aggregation
+//
+// ProcessTraitChanges() may be called many times in a burst (e.g. the lock
+// reports "locking" then "locked"). Requests are folded into a single scheduled
+// run of the notification engine, and intermediate states may be held for up to
+// WDM_NOTIFY_AGGREGATION_WINDOW_MS so that they go out in the same notify as the
+// change that follows. A final state always triggers a run right away.
+//
+// Events are scheduled by importance rather than by the byte threshold of the
+// event logger. A ProductionCritical event triggers a run right away, unless an
+// intermediate state is held, in which case it goes out with it. Less important
+// events are held until WDM_EVENT_OFFLOAD_BATCH_BYTES of them are pending, or
+// until any other run carries them, for at most WDM_EVENT_OFFLOAD_MAX_HOLD_MS.
+
+enum
+{
+    kPendingChange_Final        = 0x01,
+    kPendingChange_Intermediate = 0x02,
+    kPendingChange_UrgentEvent  = 0x04,
+    kPendingChange_HeldEvent    = 0x08,
+};
+
+// Returns false if a run is already scheduled.
+bool WDMFeatureBase::ScheduleChanges(uint8_t changes)
+{
+    // Only the first request of a burst schedules work on the Weave task.
+    if (__atomic_fetch_or(&mPendingChanges, changes, __ATOMIC_ACQ_REL) != 0)
+    {
+        return false;
+    }
+
+    PlatformMgr().ScheduleWork(AsyncProcessChanges);
+    return true;
+}
+
+void WDMFeatureBase::ProcessTraitChanges(TraitChangeType type)
+{
+    uint8_t change = (type == kTraitChange_Final) ? kPendingChange_Final : kPendingChange_Intermediate;
+
+    __atomic_fetch_add(&mAggregationStats.RequestCount, 1, __ATOMIC_RELAXED);
+
+    if (!ScheduleChanges(change))
+    {
+        __atomic_fetch_add(&mAggregationStats.CoalescedRunCount, 1, __ATOMIC_RELAXED);
+    }
+}
+
+void WDMFeatureBase::OnEventLogged(ImportanceType importance, uint32_t dataLen)
+{
+    uint64_t nowMs     = System::Platform::Layer::GetClock_MonotonicMS();
+    uint32_t heldBytes = 0;
+    size_t index       = importance - ProductionCritical;
+
+    if (index >= kEventImportanceCount)
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    PendingEvents & pending = mPendingEvents[index];
+    if (pending.Count++ == 0)
+    {
+        pending.FirstLoggedMs = nowMs;
+    }
+    pending.Bytes += dataLen;
+    pending.LoggedMsSum += nowMs;
+    mEventOffloadStats.LoggedCount[index]++;
+    for (size_t i = 1; i < kEventImportanceCount; i++)
+    {
+        heldBytes += mPendingEvents[i].Bytes;
+    }
+    taskEXIT_CRITICAL();
+
+    if (importance == ProductionCritical || heldBytes >= WDM_EVENT_OFFLOAD_BATCH_BYTES)
+    {
+        ScheduleChanges(kPendingChange_UrgentEvent);
+    }
+    else
+    {
+        ScheduleChanges(kPendingChange_HeldEvent);
+    }
+}
+
+void WDMFeatureBase::AsyncProcessChanges(intptr_t arg)
+{
+    uint8_t pending = __atomic_exchange_n(&sInstance->mPendingChanges, 0, __ATOMIC_ACQ_REL);
+
+    if ((pending & kPendingChange_HeldEvent) && !sInstance->mIsEventHoldTimerArmed &&
+        SystemLayer.StartTimer(WDM_EVENT_OFFLOAD_MAX_HOLD_MS, HandleEventHoldTimerExpired, NULL) == WEAVE_SYSTEM_NO_ERROR)
+    {
+        sInstance->mIsEventHoldTimerArmed = true;
+    }
+
+    if ((pending & kPendingChange_Final) || WDM_NOTIFY_AGGREGATION_WINDOW_MS == 0)
+    {
+        sInstance->RunNotificationEngine();
+    }
+    else if (sInstance->mIsHoldTimerArmed)
+    {
+        // Another intermediate state, or an event; it will go out with the held state.
+        if (pending & kPendingChange_Intermediate)
+        {
+            __atomic_fetch_add(&sInstance->mAggregationStats.NotifiesSavedCount, 1, __ATOMIC_RELAXED);
+        }
+    }
+    else if (pending & kPendingChange_Intermediate)
+    {
+        __atomic_fetch_add(&sInstance->mAggregationStats.HeldCount, 1, __ATOMIC_RELAXED);
+        if (SystemLayer.StartTimer(WDM_NOTIFY_AGGREGATION_WINDOW_MS, HandleHoldTimerExpired, NULL) == WEAVE_SYSTEM_NO_ERROR)
+        {
+            sInstance->mIsHoldTimerArmed = true;
+        }
+        else
+        {
+            sInstance->RunNotificationEngine();
+        }
+    }
+    else if (pending & kPendingChange_UrgentEvent)
+    {
+        sInstance->RunNotificationEngine();
+    }
+}
+
+void WDMFeatureBase::HandleHoldTimerExpired(System::Layer * systemLayer, void * appState, System::Error error)
+{
+    sInstance->mIsHoldTimerArmed = false;
+    sInstance->RunNotificationEngine();
+}
+
+void WDMFeatureBase::HandleEventHoldTimerExpired(System::Layer * systemLayer, void * appState, System::Error error)
+{
+    sInstance->mIsEventHoldTimerArmed = false;
+    sInstance->RunNotificationEngine();
+}
+
+void WDMFeatureBase::RunNotificationEngine(void)
+{
+    if (mIsHoldTimerArmed)
+    {
+        // The held intermediate state goes out in this run.
+        SystemLayer.CancelTimer(HandleHoldTimerExpired, NULL);
+        mIsHoldTimerArmed = false;
+        __atomic_fetch_add(&mAggregationStats.NotifiesSavedCount, 1, __ATOMIC_RELAXED);
+    }
+
+    mSubscriptionEngine.GetNotificationEngine()->Run();
+
+    if (mIsServiceCounterSubEstablished && mIsEventHoldTimerArmed)
+    {
+        // The held events go out in this run, or right after the notify in flight.
+        SystemLayer.CancelTimer(HandleEventHoldTimerExpired, NULL);
+        mIsEventHoldTimerArmed = false;
+    }
+
+    LogStats();
+}
+
+// Called on the start of each notify exchange of the counter-subscription.
+// The response goes through HandleServiceNotifyResponse() first.
+void WDMFeatureBase::OnServiceNotifyStart(ExchangeContext * ec)
+{
+    mServiceNotifyExchange        = ec;
+    mServiceNotifyResponseHandler = ec->OnMessageReceived;
+    ec->OnMessageReceived         = HandleServiceNotifyResponse;
+
+    // The engine puts the pending events, oldest first, in every notify it
+    // sends while they are pending.
+    mServiceNotifyStartMs   = System::Platform::Layer::GetClock_MonotonicMS();
+    mServiceNotifyHasEvents = false;
+    taskENTER_CRITICAL();
+    memcpy(mServiceNotifyEvents, mPendingEvents, sizeof(mServiceNotifyEvents));
+    taskEXIT_CRITICAL();
+    for (size_t i = 0; i < kEventImportanceCount; i++)
+    {
+        mServiceNotifyHasEvents |= (mServiceNotifyEvents[i].Count != 0);
+    }
+}
+
+void WDMFeatureBase::HandleServiceNotifyResponse(ExchangeContext * ec, const IPPacketInfo * pktInfo,
+                                                 const WeaveMessageInfo * msgInfo, uint32_t profileId, uint8_t msgType,
+                                                 System::PacketBuffer * payload)
+{
+    ExchangeContext::MessageReceiveFunct responseHandler = sInstance->mServiceNotifyResponseHandler;
+    bool isConfirmed                                     = false;
+
+    if (ec == sInstance->mServiceNotifyExchange)
+    {
+        sInstance->mServiceNotifyExchange = NULL;
+        isConfirmed                       = sInstance->mServiceNotifyHasEvents;
+    }
+
+    // May close ec, and start the next notify.
+    responseHandler(ec, pktInfo, msgInfo, profileId, msgType, payload);
+
+    // A notify started right away carries the events that did not fit in this
+    // one: its own response confirms them. Otherwise the service has every
+    // event pending when this notify started.
+    if (isConfirmed && sInstance->mServiceNotifyExchange == NULL)
+    {
+        sInstance->AccountEventOffload();
+#if PERSISTED_EVENT_LOG_PAGE_COUNT
+        PersistedEventLog::GetInstance().OnEventsDelivered(sInstance->mServiceNotifyStartMs);
+#endif
+    }
+
+    // A run finds whether events are left to send.
+    if (sInstance->mServiceNotifyExchange == NULL)
+    {
+        sInstance->ScheduleChanges(kPendingChange_Final);
+    }
+}
+
+// Counts the events pending at the start of the last notify of the
+// counter-subscription as offloaded, once the service has confirmed it. Events
+// logged since stay pending.
+void WDMFeatureBase::AccountEventOffload(void)
+{
+    uint64_t nowMs = System::Platform::Layer::GetClock_MonotonicMS();
+
+    taskENTER_CRITICAL();
+    for (size_t i = 0; i < kEventImportanceCount; i++)
+    {
+        PendingEvents & pending         = mPendingEvents[i];
+        const PendingEvents & delivered = mServiceNotifyEvents[i];
+
+        if (delivered.Count == 0 || delivered.Count > pending.Count)
+        {
+            continue;
+        }
+
+        mEventOffloadStats.OffloadCount[i]++;
+        mEventOffloadStats.OffloadedEventCount[i] += delivered.Count;
+        mEventOffloadStats.TotalAgeMs[i] += delivered.Count * nowMs - delivered.LoggedMsSum;
+        mEventOffloadStats.MaxAgeMs[i] = std::max(mEventOffloadStats.MaxAgeMs[i], (uint32_t)(nowMs - delivered.FirstLoggedMs));
+
+        // The events left were all logged after the notify started.
+        pending.Count -= delivered.Count;
+        pending.Bytes -= delivered.Bytes;
+        pending.LoggedMsSum -= delivered.LoggedMsSum;
+        pending.FirstLoggedMs = (pending.Count != 0) ? mServiceNotifyStartMs : 0;
+    }
+    taskEXIT_CRITICAL();
+
+    memset(mServiceNotifyEvents, 0, sizeof(mServiceNotifyEvents));
+}
+
+void WDMFeatureBase::GetAggregationStats(AggregationStats & stats)
+{
+    stats.RequestCount       = __atomic_load_n(&mAggregationStats.RequestCount, __ATOMIC_RELAXED);
+    stats.CoalescedRunCount  = __atomic_load_n(&mAggregationStats.CoalescedRunCount, __ATOMIC_RELAXED);
+    stats.HeldCount          = __atomic_load_n(&mAggregationStats.HeldCount, __ATOMIC_RELAXED);
+    stats.NotifiesSavedCount = __atomic_load_n(&mAggregationStats.NotifiesSavedCount, __ATOMIC_RELAXED);
+}
+
+void WDMFeatureBase::GetEventOffloadStats(EventOffloadStats & stats)
+{
+    taskENTER_CRITICAL();
+    stats = mEventOffloadStats;
+    taskEXIT_CRITICAL();
+}
+
+void WDMFeatureBase::LogStats(void)
+{
+    static uint64_t sLastStatsLogTimeMs;
+    uint64_t nowMs = System::Platform::Layer::GetClock_MonotonicMS();
+    AggregationStats stats;
+
+    if (nowMs - sLastStatsLogTimeMs < WDM_STATS_LOG_INTERVAL_MS)
+    {
+        return;
+    }
+    sLastStatsLogTimeMs = nowMs;
+
+    GetAggregationStats(stats);
+    WeaveLogProgress(Support,
+                     "WDM aggregation: %" PRIu32 " requests, %" PRIu32 " coalesced, %" PRIu32 " held, %" PRIu32
+                     " notifies saved",
+                     stats.RequestCount, stats.CoalescedRunCount, stats.HeldCount, stats.NotifiesSavedCount);
+
+    mPublisherLock.LogStats();
+
+    RttEstimator::Stats rttStats;
+    GetServiceRttStats(rttStats);
+    WeaveLogProgress(Support,
+                     "Service RTT: srtt %" PRIu32 " ms, rttvar %" PRIu32 " ms, retrans timeout %" PRIu32 " ms (%" PRIu32
+                     " samples, %" PRIu32 " discarded, %" PRIu32 " backoffs)",
+                     rttStats.SrttMs, rttStats.RttVarMs, rttStats.RetransTimeoutMs, rttStats.SampleCount,
+                     rttStats.DiscardedCount, rttStats.BackoffCount);
+
+    WeaveLogProgress(Support,
+                     "Service resubscribe: %" PRIu32 " recoveries, %" PRIu32 " attempts, max %" PRIu32 " ms to resubscribe",
+                     mResubscribeStats.ResubscribeCount, mResubscribeStats.AttemptCount, mResubscribeStats.MaxTimeToResubscribeMs);
+
+    WeaveLogProgress(Support,
+                     "Service connect: %" PRIu32 " ms from boot, %" PRIu32 " reattaches, max %" PRIu32 " ms from reattach",
+                     mConnectStats.BootToConnectedMs, mConnectStats.ReattachCount, mConnectStats.MaxReattachToConnectedMs);
+
+    static const char * const sImportanceNames[kEventImportanceCount] = { "critical", "production", "info", "debug" };
+    EventOffloadStats offloadStats;
+    GetEventOffloadStats(offloadStats);
+    for (size_t i = 0; i < kEventImportanceCount; i++)
+    {
+        if (offloadStats.LoggedCount[i] == 0)
+        {
+            continue;
+        }
+
+        WeaveLogProgress(Support,
+                         "Event offload (%s): %" PRIu32 " logged, %" PRIu32 " offloads of %" PRIu32 " events, age avg %" PRIu32
+                         " ms, max %" PRIu32 " ms",
+                         sImportanceNames[i], offloadStats.LoggedCount[i], offloadStats.OffloadCount[i],
+                         offloadStats.OffloadedEventCount[i],
+                         (uint32_t)(offloadStats.TotalAgeMs[i] / std::max<uint32_t>(offloadStats.OffloadedEventCount[i], 1)),
+                         offloadStats.MaxAgeMs[i]);
+    }
+
+#if PERSISTED_EVENT_LOG_PAGE_COUNT
+    PersistedEventLog::GetInstance().LogStats();
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Service round-trip times
+//
+// The first message of each exchange initiated by the subscription client
+// (subscribe request, subscribe confirm, cancel, update) is timed from the
+// start of the exchange to its WRM ack. Samples feed the RttEstimator, whose
+// retransmission timeout is then used by every new exchange with the service,
+// so that a lost packet on a healthy link costs a few hundred milliseconds
+// instead of the worst-case SERVICE_WRM_INITIAL_RETRANS_TIMEOUT_MS.
+
+void WDMFeatureBase::StartServiceRttSample(ExchangeContext * ec)
+{
+    // The exchange may predate the last change of the timeout.
+    ec->mWRMPConfig = mServiceWRMPConfig;
+
+#if SERVICE_WRM_ADAPTIVE_RETRANS_TIMEOUT
+    ec->OnAckRcvd       = HandleServiceAckRcvd;
+    mRttSampleExchange  = ec;
+    mRttSampleStartMs   = System::Platform::Layer::GetClock_MonotonicMS();
+    mRttSampleTimeoutMs = mServiceWRMPConfig.mInitialRetransTimeout;
+#endif
+}
+
+void WDMFeatureBase::HandleServiceAckRcvd(ExchangeContext * ec, void * msgCtxt)
+{
+    uint32_t rttMs;
+
+    // Only the first ack of the exchange is timed.
+    ec->OnAckRcvd = NULL;
+    if (ec != sInstance->mRttSampleExchange)
+    {
+        return;
+    }
+    sInstance->mRttSampleExchange = NULL;
+
+    rttMs = (uint32_t)(System::Platform::Layer::GetClock_MonotonicMS() - sInstance->mRttSampleStartMs);
+
+    // Past the retransmission timeout, the ack may be that of a retransmission.
+    if (rttMs >= sInstance->mRttSampleTimeoutMs)
+    {
+        sInstance->mServiceRtt.DiscardSample();
+    }
+    else if (sInstance->mServiceRtt.AddSample(rttMs))
+    {
+        sInstance->ApplyServiceRetransTimeout();
+    }
+}
+
+void WDMFeatureBase::ApplyServiceRetransTimeout(void)
+{
+    uint32_t timeoutMs = mServiceRtt.GetRetransTimeoutMs();
+
+    mServiceWRMPConfig.mInitialRetransTimeout = timeoutMs;
+    mServiceWRMPConfig.mActiveRetransTimeout  = timeoutMs;
+
+    if (mServiceSubBinding != NULL)
+    {
+        mServiceSubBinding->SetDefaultWRMPConfig(mServiceWRMPConfig);
+    }
+    if (mServiceCounterSubHandler != NULL)
+    {
+        mServiceCounterSubHandler->GetBinding()->SetDefaultWRMPConfig(mServiceWRMPConfig);
+    }
+
+    WeaveLogDetail(Support, "Service WRM retransmission timeout set to %" PRIu32 " ms", timeoutMs);
+}
+
+void WDMFeatureBase::HandleSubscriptionEngineEvent(void * appState, SubscriptionEngine::EventID eventType,
+                                               const SubscriptionEngine::InEventParam & inParam,
+                                               SubscriptionEngine::OutEventParam & outParam)
+{
+    switch (eventType)
+    {
+    case SubscriptionEngine::kEvent_OnIncomingSubscribeRequest:
+        outParam.mIncomingSubscribeRequest.mHandlerEventCallback = HandleInboundSubscriptionEvent;
+        outParam.mIncomingSubscribeRequest.mHandlerAppState      = NULL;
+        outParam.mIncomingSubscribeRequest.mRejectRequest        = false;
+        break;
+
+    default:
+        SubscriptionEngine::DefaultEventHandler(eventType, inParam, outParam);
+        break;
+    }
+}
+
+bool WDMFeatureBase::AreServiceSubscriptionsEstablished(void)
+{
+    return (mIsSubToServiceEstablished && mIsServiceCounterSubEstablished);
+}
+
+void WDMFeatureBase::InitiateSubscriptionToService(void)
+{
+    WeaveLogProgress(Support, "Initiating Subscription To Service");
+    mServiceSubClient->EnableResubscribe(HandleResubscribePolicy);
+    mServiceSubClient->InitiateSubscription();
+}
+
+void WDMFeatureBase::TearDownSubscriptions(void)
+{
+    if (mServiceSubClient)
+    {
+        mServiceSubClient->AbortSubscription();
+        if (mServiceCounterSubHandler != NULL)
+        {
+            mServiceCounterSubHandler->AbortSubscription();
+            mServiceCounterSubHandler = NULL;
+        }
+    }
+}
+
+void WDMFeatureBase::HandleServiceBindingEvent(void * appState, ::nl::Weave::Binding::EventType eventType,
+                                           const ::nl::Weave::Binding::InEventParam & inParam,
+                                           ::nl::Weave::Binding::OutEventParam & outParam)
+{
+    Binding * binding = inParam.Source;
+
+    switch (eventType)
+    {
+    case Binding::kEvent_PrepareRequested:
+        outParam.PrepareRequested.PrepareError = binding->BeginConfiguration()
+                                                     .Target_ServiceEndpoint(kServiceEndpoint_Data_Management)
+                                                     .Transport_UDP_WRM()
+                                                     .Transport_DefaultWRMPConfig(sInstance->mServiceWRMPConfig)
+                                                     .Exchange_ResponseTimeoutMsec(SERVICE_MESSAGE_RESPONSE_TIMEOUT_MS)
+                                                     .Security_SharedCASESession()
+                                                     .PrepareBinding();
+        break;
+
+    case Binding::kEvent_PrepareFailed:
+        WeaveLogError(Support, "Failed to prepare service subscription binding: %s", ErrorStr(inParam.PrepareFailed.Reason));
+        break;
+
+    case Binding::kEvent_BindingFailed:
+        WeaveLogError(Support, "Service subscription binding failed: %s", ErrorStr(inParam.BindingFailed.Reason));
+        break;
+
+    case Binding::kEvent_BindingReady:
+        WeaveLogProgress(Support, "Service subscription binding ready");
+        break;
+
+    default:
+        nl::Weave::Binding::DefaultEventHandler(appState, eventType, inParam, outParam);
+    }
+}
+
+// Local subscriptions are limited by the policy set with
+// AcceptLocalSubscription() or AcceptLocalSubscribers(), and to a bounded number
+// of handlers, so that other nodes of the network cannot exhaust the pool of
+// subscription handlers. The request must come over a CASE session, so that the
+// source node id is authenticated.
+//
+// The associated peer may only subscribe to its trait instance, with a single
+// handler: a request of the peer replaces its previous subscription, which it
+// no longer uses if it subscribes again.
+bool WDMFeatureBase::AcceptLocalSubscribeRequest(SubscriptionHandler * handler, const WeaveMessageInfo * msgInfo)
+{
+    WEAVE_ERROR err;
+    uint64_t sourceNodeId = msgInfo->SourceNodeId;
+
+    if (!IsCASEAuthMode(msgInfo->PeerAuthMode))
+    {
+        return false;
+    }
+
+    if (mLocalSubPolicy == kLocalSubPolicy_AnyPeer)
+    {
+        for (size_t i = 0; i < WDM_MAX_LOCAL_SUBSCRIBERS; i++)
+        {
+            if (mLocalSubHandlers[i] == NULL)
+            {
+                mLocalSubHandlers[i] = handler;
+                return true;
+            }
+        }
+
+        WeaveLogError(Support, "Local subscriber limit (%d) reached", WDM_MAX_LOCAL_SUBSCRIBERS);
+        return false;
+    }
+
+    if (mLocalSubPolicy != kLocalSubPolicy_AssociatedPeer || handler->GetNumTraitInstances() != 1 ||
+        handler->GetTraitInstanceInfoList()[0].mTraitDataHandle != mLocalSubTraitHandle)
+    {
+        return false;
+    }
+
+    if (sourceNodeId != mLocalPeerNodeId)
+    {
+        // A new peer is only associated while the user selected mode is active.
+        if (!ConnectivityMgr().IsUserSelectedModeActive())
+        {
+            return false;
+        }
+
+        WeaveLogProgress(Support, "Associated with local node %" PRIX64, sourceNodeId);
+        mLocalPeerNodeId = sourceNodeId;
+        err              = AppPersistentStorage::WriteRecord(AppPersistentStorage::kRecordId_LocalPeer, mLocalPeerNodeId);
+        if (err != WEAVE_NO_ERROR)
+        {
+            WeaveLogError(Support, "Failed to persist the local peer: %s", ErrorStr(err));
+        }
+    }
+
+    if (mLocalSubHandlers[0] != NULL)
+    {
+        SubscriptionHandler * previousHandler = mLocalSubHandlers[0];
+
+        mLocalSubHandlers[0] = NULL;
+        previousHandler->AbortSubscription();
+    }
+
+    mLocalSubHandlers[0] = handler;
+    return true;
+}
+
+void WDMFeatureBase::HandleInboundSubscriptionEvent(void * aAppState, SubscriptionHandler::EventID eventType,
+                                                const SubscriptionHandler::InEventParam & inParam,
+                                                SubscriptionHandler::OutEventParam & outParam)
+{
+    switch (eventType)
+    {
+    case SubscriptionHandler::kEvent_OnSubscribeRequestParsed: {
+        Binding * binding = inParam.mSubscribeRequestParsed.mHandler->GetBinding();
+
+        if (inParam.mSubscribeRequestParsed.mIsSubscriptionIdValid &&
+            inParam.mSubscribeRequestParsed.mMsgInfo->SourceNodeId == kServiceEndpoint_Data_Management)
+        {
+            WeaveLogDetail(Support,
+                           "Inbound service counter-subscription request received (sub id %016" PRIX64 ", path count %" PRId16 ")",
+                           inParam.mSubscribeRequestParsed.mSubscriptionId, inParam.mSubscribeRequestParsed.mNumTraitInstances);
+            sInstance->mServiceCounterSubHandler = inParam.mSubscribeRequestParsed.mHandler;
+
+            binding->SetDefaultResponseTimeout(SERVICE_MESSAGE_RESPONSE_TIMEOUT_MS);
+            binding->SetDefaultWRMPConfig(sInstance->mServiceWRMPConfig);
+        }
+        else if (!inParam.mSubscribeRequestParsed.mIsSubscriptionIdValid &&
+                 sInstance->AcceptLocalSubscribeRequest(inParam.mSubscribeRequestParsed.mHandler,
+                                                        inParam.mSubscribeRequestParsed.mMsgInfo))
+        {
+            // A local peer keeps the default WRM and response timeouts of the binding.
+            WeaveLogProgress(Support, "Inbound local subscription request received from node %" PRIX64,
+                             inParam.mSubscribeRequestParsed.mMsgInfo->SourceNodeId);
+        }
+        else
+        {
+            WeaveLogError(Support, "Inbound subscription request from node %" PRIX64 " refused (path count %" PRId16 ")",
+                          inParam.mSubscribeRequestParsed.mMsgInfo->SourceNodeId,
+                          inParam.mSubscribeRequestParsed.mNumTraitInstances);
+            inParam.mSubscribeRequestParsed.mHandler->EndSubscription(nl::Weave::Profiles::kWeaveProfile_Common,
+                                                                      nl::Weave::Profiles::Common::kStatus_AccessDenied);
+            break;
+        }
+
+        inParam.mSubscribeRequestParsed.mHandler->AcceptSubscribeRequest(inParam.mSubscribeRequestParsed.mTimeoutSecMin);
+        break;
+    }
+
+    case SubscriptionHandler::kEvent_OnExchangeStart:
+        if (inParam.mExchangeStart.mHandler == sInstance->mServiceCounterSubHandler)
+        {
+            sInstance->OnServiceNotifyStart(inParam.mExchangeStart.mEC);
+        }
+        break;
+
+    case SubscriptionHandler::kEvent_OnSubscriptionEstablished: {
+        if (inParam.mSubscriptionEstablished.mHandler == sInstance->mServiceCounterSubHandler)
+        {
+            WeaveLogDetail(Support, "Inbound service counter-subscription established");
+            sInstance->mIsServiceCounterSubEstablished = true;
+            sInstance->UpdateConnectStats();
+            ConnectivityState::Refresh();
+#if PERSISTED_EVENT_LOG_PAGE_COUNT
+            PersistedEventLog::GetInstance().OnServiceCounterSubscriptionChange(true);
+#endif
+        }
+        else
+        {
+            WeaveLogProgress(Support, "Inbound local subscription established");
+        }
+        break;
+    }
+
+    case SubscriptionHandler::kEvent_OnSubscriptionTerminated: {
+        const char * termDesc = (inParam.mSubscriptionTerminated.mReason == WEAVE_ERROR_STATUS_REPORT_RECEIVED)
+            ? StatusReportStr(inParam.mSubscriptionTerminated.mStatusProfileId, inParam.mSubscriptionTerminated.mStatusCode)
+            : ErrorStr(inParam.mSubscriptionTerminated.mReason);
+
+        if (inParam.mSubscriptionTerminated.mHandler == sInstance->mServiceCounterSubHandler)
+        {
+            WeaveLogProgress(Support, "Inbound service counter-subscription terminated: %s", termDesc);
+
+            sInstance->mServiceCounterSubHandler       = NULL;
+            sInstance->mServiceNotifyExchange          = NULL;
+            sInstance->mIsServiceCounterSubEstablished = false;
+            ConnectivityState::Refresh();
+#if PERSISTED_EVENT_LOG_PAGE_COUNT
+            PersistedEventLog::GetInstance().OnServiceCounterSubscriptionChange(false);
+#endif
+        }
+        else
+        {
+            WeaveLogProgress(Support, "Inbound local subscription terminated: %s", termDesc);
+
+            for (size_t i = 0; i < WDM_MAX_LOCAL_SUBSCRIBERS; i++)
+            {
+                if (inParam.mSubscriptionTerminated.mHandler == sInstance->mLocalSubHandlers[i])
+                {
+                    sInstance->mLocalSubHandlers[i] = NULL;
+                }
+            }
+        }
+        break;
+    }
+
+    default:
+        SubscriptionHandler::DefaultEventHandler(eventType, inParam, outParam);
+        break;
+    }
+}
+
+void WDMFeatureBase::HandleOutboundServiceSubscriptionEvent(void * appState, SubscriptionClient::EventID eventType,
+                                                        const SubscriptionClient::InEventParam & inParam,
+                                                        SubscriptionClient::OutEventParam & outParam)
+{
+    switch (eventType)
+    {
+    case SubscriptionClient::kEvent_OnExchangeStart:
+        sInstance->StartServiceRttSample(inParam.mExchangeStart.mEC);
+        break;
+
+    case SubscriptionClient::kEvent_OnSubscribeRequestPrepareNeeded: {
+        outParam.mSubscribeRequestPrepareNeeded.mPathList                  = sInstance->mServiceSinkTraitPaths;
+        outParam.mSubscribeRequestPrepareNeeded.mPathListSize              = sInstance->mServiceSinkTraitPathCount;
+        // The subscribe request carries the data version of each sink that has
+        // one (see the sinks' persisted state), which lets the service answer
+        // with no data for the traits that did not change. mVersionedPathList
+        // only requests schema versions, which the default of the paths covers.
+        outParam.mSubscribeRequestPrepareNeeded.mVersionedPathList         = NULL;
+        outParam.mSubscribeRequestPrepareNeeded.mNeedAllEvents             = false;
+        outParam.mSubscribeRequestPrepareNeeded.mLastObservedEventList     = NULL;
+        outParam.mSubscribeRequestPrepareNeeded.mLastObservedEventListSize = 0;
+        outParam.mSubscribeRequestPrepareNeeded.mTimeoutSecMin             = SERVICE_LIVENESS_TIMEOUT_SEC;
+        outParam.mSubscribeRequestPrepareNeeded.mTimeoutSecMax             = SERVICE_LIVENESS_TIMEOUT_SEC;
+
+        WeaveLogDetail(Support, "Sending outbound service subscribe request (path count %" PRIu32 ")",
+                       sInstance->mServiceSinkTraitPathCount);
+
+        break;
+    }
+    case SubscriptionClient::kEvent_OnSubscriptionEstablished:
+        WeaveLogDetail(Support, "Outbound service subscription established (sub id %016" PRIX64 ")",
+                       inParam.mSubscriptionEstablished.mSubscriptionId);
+        sInstance->mIsSubToServiceEstablished = true;
+        sInstance->OnServiceSubscriptionEstablished();
+        sInstance->UpdateConnectStats();
+        ConnectivityState::Refresh();
+        break;
+
+    case SubscriptionClient::kEvent_OnSubscriptionTerminated: {
+        WeaveLogDetail(
+            Support, "Outbound service subscription terminated: %s",
+            (inParam.mSubscriptionTerminated.mIsStatusCodeValid)
+                ? StatusReportStr(inParam.mSubscriptionTerminated.mStatusProfileId, inParam.mSubscriptionTerminated.mStatusCode)
+                : ErrorStr(inParam.mSubscriptionTerminated.mReason));
+
+        if (sInstance->mIsSubToServiceEstablished)
+        {
+            sInstance->OnServiceSubscriptionLost();
+        }
+        sInstance->mIsSubToServiceEstablished = false;
+        ConnectivityState::Refresh();
+
+        // RFC 6298 5.5: back off until a new sample is taken.
+        if ((inParam.mSubscriptionTerminated.mReason == WEAVE_ERROR_MESSAGE_NOT_ACKNOWLEDGED ||
+             inParam.mSubscriptionTerminated.mReason == WEAVE_ERROR_TIMEOUT) &&
+            SERVICE_WRM_ADAPTIVE_RETRANS_TIMEOUT && sInstance->mServiceRtt.Backoff())
+        {
+            sInstance->ApplyServiceRetransTimeout();
+        }
+
+        if (inParam.mSubscriptionTerminated.mClient == sInstance->mServiceSubClient)
+        {
+            // This would happen when the service explicitly terminates the subscription
+            // by sending a CANCEL subscription request.
+            if (!inParam.mSubscriptionTerminated.mWillRetry)
+            {
+                sInstance->TearDownSubscriptions();
+                sInstance->InitiateSubscriptionToService();
+            }
+        }
+
+        break;
+    }
+
+    default:
+        SubscriptionClient::DefaultEventHandler(eventType, inParam, outParam);
+        break;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Resubscription
+
+void WDMFeatureBase::HandleResubscribePolicy(void * const appState, SubscriptionClient::ResubscribeParam & inParam,
+                                             uint32_t & outIntervalMsec)
+{
+    outIntervalMsec = sInstance->mResubscribePolicy->GetRetryIntervalMs(inParam.mNumRetries);
+    sInstance->mResubscribeAttemptCount++;
+    sInstance->mNextResubscribeTimeMs = System::Platform::Layer::GetClock_MonotonicMS() + outIntervalMsec;
+
+    WeaveLogProgress(Support, "Resubscribing to service in %" PRIu32 " ms (retry %" PRIu32 ")", outIntervalMsec,
+                     (uint32_t) inParam.mNumRetries);
+}
+
+void WDMFeatureBase::OnServiceSubscriptionLost(void)
+{
+    // Never 0, which means "established".
+    mSubToServiceLostTimeMs  = std::max<uint64_t>(System::Platform::Layer::GetClock_MonotonicMS(), 1);
+    mResubscribeAttemptCount = 0;
+}
+
+void WDMFeatureBase::OnServiceSubscriptionEstablished(void)
+{
+    uint32_t timeToResubscribeMs;
+
+    mNextResubscribeTimeMs = 0;
+
+    if (mSubToServiceLostTimeMs == 0)
+    {
+        return;
+    }
+
+    timeToResubscribeMs     = (uint32_t)(System::Platform::Layer::GetClock_MonotonicMS() - mSubToServiceLostTimeMs);
+    mSubToServiceLostTimeMs = 0;
+
+    mResubscribeStats.ResubscribeCount++;
+    mResubscribeStats.AttemptCount += mResubscribeAttemptCount;
+    mResubscribeStats.LastAttemptCount        = mResubscribeAttemptCount;
+    mResubscribeStats.LastTimeToResubscribeMs = timeToResubscribeMs;
+    mResubscribeStats.MaxTimeToResubscribeMs  = std::max(mResubscribeStats.MaxTimeToResubscribeMs, timeToResubscribeMs);
+    mPublishedResubscribeStats.Publish(mResubscribeStats);
+
+    WeaveLogProgress(Support, "Service subscription re-established after %" PRIu32 " ms and %" PRIu32 " attempts",
+                     timeToResubscribeMs, mResubscribeAttemptCount);
+}
+
+// -----------------------------------------------------------------------------
+// Service connection
+
+void WDMFeatureBase::PrepareServiceBinding(void)
+{
+    WEAVE_ERROR err;
+
+    if (mServiceSubBinding == NULL || !mServiceSubBinding->CanBePrepared())
+    {
+        // Ready, or being prepared.
+        return;
+    }
+
+    WeaveLogDetail(Support, "Preparing service binding");
+
+    err = mServiceSubBinding->RequestPrepare();
+    if (err != WEAVE_NO_ERROR)
+    {
+        WeaveLogError(Support, "Failed to prepare service binding: %s", ErrorStr(err));
+    }
+}
+
+void WDMFeatureBase::UpdateConnectStats(void)
+{
+    uint64_t nowMs = System::Platform::Layer::GetClock_MonotonicMS();
+
+    if (!AreServiceSubscriptionsEstablished())
+    {
+        return;
+    }
+
+    if (mConnectStats.BootToConnectedMs == 0)
+    {
+        // The monotonic clock starts at boot.
+        mConnectStats.BootToConnectedMs = std::max<uint32_t>((uint32_t) nowMs, 1);
+        WeaveLogProgress(Support, "Service fully connected %" PRIu32 " ms after boot", mConnectStats.BootToConnectedMs);
+    }
+    else if (mReattachTimeMs != 0)
+    {
+        uint32_t reattachToConnectedMs = (uint32_t)(nowMs - mReattachTimeMs);
+
+        mConnectStats.ReattachCount++;
+        mConnectStats.LastReattachToConnectedMs = reattachToConnectedMs;
+        mConnectStats.MaxReattachToConnectedMs  = std::max(mConnectStats.MaxReattachToConnectedMs, reattachToConnectedMs);
+        WeaveLogProgress(Support, "Service fully connected %" PRIu32 " ms after reattach", reattachToConnectedMs);
+    }
+    else
+    {
+        return;
+    }
+
+    mReattachTimeMs = 0;
+    mPublishedConnectStats.Publish(mConnectStats);
+}
+
+void WDMFeatureBase::PlatformEventHandler(const WeaveDeviceEvent * event, intptr_t arg)
+{
+    sInstance->OnPlatformEvent(event);
+
+    bool haveServiceConnectivity     = ConnectivityMgr().HaveServiceConnectivity();
+    bool serviceSubShouldBeActivated = (haveServiceConnectivity && ConfigurationMgr().IsPairedToAccount());
+    bool linkRestored                = (haveServiceConnectivity && !sInstance->mHadServiceConnectivity);
+
+    sInstance->mHadServiceConnectivity = haveServiceConnectivity;
+
+    if (linkRestored && sInstance->mConnectStats.BootToConnectedMs != 0)
+    {
+        sInstance->mReattachTimeMs = System::Platform::Layer::GetClock_MonotonicMS();
+    }
+
+    // Set up the binding, and with it the shared CASE session, as soon as the service is reachable,
+    // so that it is ready (or nearly so) when the subscribe request goes out. After a failure, not
+    // before the next resubscribe attempt, so that platform events do not bypass its backoff.
+    if (serviceSubShouldBeActivated &&
+        (linkRestored || System::Platform::Layer::GetClock_MonotonicMS() >= sInstance->mNextResubscribeTimeMs))
+    {
+        sInstance->PrepareServiceBinding();
+    }
+
+    // If we should be activated and we are not, initiate subscription
+    if (serviceSubShouldBeActivated == true && sInstance->mIsSubToServiceActivated == false)
+    {
+        sInstance->InitiateSubscriptionToService();
+        sInstance->mIsSubToServiceActivated = true;
+    }
+    // If connectivity just came back (e.g. Thread reattached) while we wait for the next resubscribe
+    // attempt, make it now rather than at the end of the backoff.
+    else if (linkRestored && serviceSubShouldBeActivated && sInstance->mIsSubToServiceActivated &&
+             !sInstance->mIsSubToServiceEstablished && !sInstance->mServiceSubClient->IsInProgressOrEstablished())
+    {
+        WeaveLogProgress(Support, "Service connectivity restored, resubscribing now");
+        sInstance->mResubscribePolicy->OnLinkRestored();
+        sInstance->mServiceSubClient->ResetResubscribe();
+    }
+}
+
+WEAVE_ERROR WDMFeatureBase::Init()
+{
+    WEAVE_ERROR err;
+    Binding * binding;
+
+    err = mPublisherLock.Init();
+    SuccessOrExit(err);
+
+    PlatformMgr().AddEventHandler(PlatformEventHandler);
+
+    err = InitTraits();
+    SuccessOrExit(err);
+
+    if (mLocalSubPolicy == kLocalSubPolicy_AssociatedPeer &&
+        !AppPersistentStorage::ReadRecord(AppPersistentStorage::kRecordId_LocalPeer, mLocalPeerNodeId))
+    {
+        mLocalPeerNodeId = kNodeIdNotSpecified;
+    }
+
+#if PERSISTED_EVENT_LOG_PAGE_COUNT
+    // Before the first subscription, which offloads the events of the previous boot.
+    err = PersistedEventLog::GetInstance().Init();
+    SuccessOrExit(err);
+#endif
+
+    err = mSubscriptionEngine.Init(&ExchangeMgr, this, HandleSubscriptionEngineEvent);
+    SuccessOrExit(err);
+
+    err = mSubscriptionEngine.EnablePublisher(&mPublisherLock, &mServiceSourceTraitCatalog);
+    SuccessOrExit(err);
+
+    binding = ExchangeMgr.NewBinding(HandleServiceBindingEvent, this);
+    VerifyOrExit(NULL != binding, err = WEAVE_ERROR_NO_MEMORY);
+
+    err = mSubscriptionEngine.NewClient(&(mServiceSubClient), binding, this, HandleOutboundServiceSubscriptionEvent,
+                                        &mServiceSinkTraitCatalog, SUBSCRIPTION_RESPONSE_TIMEOUT_MS);
+    SuccessOrExit(err);
+
+    mServiceSubBinding = binding;
+
+    WeaveLogProgress(Support, "WDMFeature Init Complete");
+
+exit:
+    return err;
+}
\ No newline at end of file
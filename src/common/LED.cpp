@@ -58,20 +58,26 @@ void LED::Blink(uint32_t onTimeMS, uint32_t offTimeMS)
     Animate();
 }
 
-void LED::Animate()
+uint32_t LED::Animate()
 {
-    if (mBlinkOnTimeMS != 0 && mBlinkOffTimeMS != 0)
+    if (mBlinkOnTimeMS == 0 || mBlinkOffTimeMS == 0)
     {
-        int64_t nowUS            = ::nl::Weave::System::Platform::Layer::GetClock_MonotonicHiRes();
-        int64_t stateDurUS       = ((mState) ? mBlinkOnTimeMS : mBlinkOffTimeMS) * 1000LL;
-        int64_t nextChangeTimeUS = mLastChangeTimeUS + stateDurUS;
+        return APP_EVENT_LOOP_NO_DEADLINE;
+    }
+
+    int64_t nowUS            = ::nl::Weave::System::Platform::Layer::GetClock_MonotonicHiRes();
+    int64_t stateDurUS       = ((mState) ? mBlinkOnTimeMS : mBlinkOffTimeMS) * 1000LL;
+    int64_t nextChangeTimeUS = mLastChangeTimeUS + stateDurUS;
 
-        if (nowUS > nextChangeTimeUS)
-        {
-            DoSet(!mState);
-            mLastChangeTimeUS = nowUS;
-        }
+    if (nowUS >= nextChangeTimeUS)
+    {
+        DoSet(!mState);
+        mLastChangeTimeUS = nowUS;
+        nextChangeTimeUS  = nowUS + ((mState) ? mBlinkOnTimeMS : mBlinkOffTimeMS) * 1000LL;
     }
+
+    // Round up so we never wake up just before the change is due.
+    return (uint32_t)((nextChangeTimeUS - nowUS + 999) / 1000);
 }
 
 void LED::DoSet(bool state)
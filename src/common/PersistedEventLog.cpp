@@ -0,0 +1,909 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "PersistedEventLog.h"
+
+#if PERSISTED_EVENT_LOG_PAGE_COUNT
+
+#include <Weave/Core/WeaveEncoding.h>
+
+#include "GenericWDMFeature.h"
+
+#include <algorithm>
+#include <inttypes.h>
+#include <string.h>
+
+using namespace ::nl::Weave;
+using namespace ::nl::Weave::DeviceLayer;
+using namespace ::nl::Weave::Encoding;
+using namespace ::nl::Weave::Profiles::DataManagement;
+
+PersistedEventLog PersistedEventLog::sInstance;
+
+// Event data of an entry, handed to LogEvent() when the entry is logged again.
+struct EntryData
+{
+    const uint8_t * Data;
+    uint8_t Length;
+};
+
+static WEAVE_ERROR WriteEntryData(TLV::TLVWriter & writer, uint8_t dataTag, void * appData)
+{
+    const EntryData * entry = static_cast<const EntryData *>(appData);
+    WEAVE_ERROR err;
+    TLV::TLVReader reader;
+
+    reader.Init(entry->Data, entry->Length);
+
+    err = reader.Next();
+    SuccessOrExit(err);
+
+    err = writer.CopyElement(TLV::ContextTag(dataTag), reader);
+
+exit:
+    return err;
+}
+
+static void WritePageHeader(uint8_t * page, uint32_t sequence, uint16_t length, uint16_t eventCount)
+{
+    LittleEndian::Write32(page, sequence);
+    LittleEndian::Write16(page, length);
+    LittleEndian::Write16(page, eventCount);
+}
+
+static inline uint64_t ZigZagEncode(int64_t value)
+{
+    return ((uint64_t) value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static inline int64_t ZigZagDecode(uint64_t value)
+{
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+// Writes value 7 bits at a time, least significant first, and advances p.
+static void WriteVarint(uint8_t *& p, uint64_t value)
+{
+    do
+    {
+        uint8_t byte = value & 0x7F;
+
+        value >>= 7;
+        *p++ = (value != 0) ? (byte | 0x80) : byte;
+    } while (value != 0);
+}
+
+// Returns false if the varint at p runs past end.
+static bool ReadVarint(const uint8_t *& p, const uint8_t * end, uint64_t & value)
+{
+    value = 0;
+
+    for (uint8_t shift = 0; p < end && shift < 64; shift += 7)
+    {
+        uint8_t byte = *p++;
+
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static inline bool IsSameSchema(const EventSchema & a, const EventSchema & b)
+{
+    return a.mProfileId == b.mProfileId && a.mStructureType == b.mStructureType && a.mImportance == b.mImportance &&
+        a.mDataSchemaVersion == b.mDataSchemaVersion;
+}
+
+static inline AppPersistentStorage::RecordId GetPageRecordId(uint8_t slot)
+{
+    return static_cast<AppPersistentStorage::RecordId>(AppPersistentStorage::kRecordId_EventLogPageFirst + slot);
+}
+
+WEAVE_ERROR PersistedEventLog::Init(void)
+{
+    WEAVE_ERROR err       = WEAVE_NO_ERROR;
+    uint32_t maxSequence  = 0;
+    uint32_t pendingCount = 0;
+    uint8_t lastSlot      = PERSISTED_EVENT_LOG_PAGE_COUNT - 1;
+
+#if APP_USE_STATIC_ALLOCATION
+    mLock = xSemaphoreCreateMutexStatic(&mLockStruct);
+#else
+    mLock = xSemaphoreCreateMutex();
+#endif
+    VerifyOrExit(mLock != NULL, err = WEAVE_ERROR_NO_MEMORY);
+
+    memset(mPages, 0, sizeof(mPages));
+    memset(&mStats, 0, sizeof(mStats));
+    mWriteBufferState     = kWriteBuffer_Free;
+    mIsFlushScheduled     = false;
+    mIsFlushTimerArmed    = false;
+    mIsServiceConnected   = false;
+    mIsOffloadPending     = false;
+    mConnectedSinceMs     = 0;
+    mDeliveredBeforeMs    = 0;
+    mOffloadReplayedCount = 0;
+
+    if (!AppPersistentStorage::ReadRecord(AppPersistentStorage::kRecordId_EventLogRetired, mRetiredSequence))
+    {
+        mRetiredSequence = 0;
+    }
+
+    for (uint8_t slot = 0; slot < PERSISTED_EVENT_LOG_PAGE_COUNT; slot++)
+    {
+        PageInfo & page = mPages[slot];
+        size_t len;
+        const uint8_t * p = mWriteBuffer;
+
+        if (ReadPage(slot, len) != WEAVE_NO_ERROR)
+        {
+            continue;
+        }
+
+        page.Sequence = LittleEndian::Read32(p);
+        LittleEndian::Read16(p);
+        page.EventCount       = LittleEndian::Read16(p);
+        page.FromPreviousBoot = true;
+        page.NeedsReplay      = IsPending(page);
+
+        if (page.NeedsReplay)
+        {
+            pendingCount += page.EventCount;
+        }
+
+        if (page.Sequence > maxSequence)
+        {
+            maxSequence = page.Sequence;
+            lastSlot    = slot;
+        }
+    }
+
+    // Continue the ring after the most recent page.
+    mNextSequence = std::max(maxSequence, mRetiredSequence) + 1;
+    mFillSlot     = (lastSlot + 1) % PERSISTED_EVENT_LOG_PAGE_COUNT;
+    StartNewPage();
+
+    if (pendingCount != 0)
+    {
+        WeaveLogProgress(Support, "%" PRIu32 " persisted events of the previous boot to offload", pendingCount);
+        mIsOffloadPending = true;
+    }
+
+exit:
+    return err;
+}
+
+void PersistedEventLog::AppendEntry(const EventSchema & schema, event_id_t eventId, SerializeFunct serialize, const void * event)
+{
+    WEAVE_ERROR err    = WEAVE_NO_ERROR;
+    uint64_t utcTimeMs = 0;
+    uint32_t dataLen   = 0;
+    bool appended      = false;
+
+    // Logged again with its original time if the real time clock was set.
+    if (System::Platform::Layer::GetClock_RealTimeMS(utcTimeMs) != WEAVE_SYSTEM_NO_ERROR)
+    {
+        utcTimeMs = 0;
+    }
+
+    xSemaphoreTake(mLock, portMAX_DELAY);
+
+    for (int attempt = 0; attempt < 2 && !appended; attempt++)
+    {
+        PageInfo & page = mPages[mFillSlot];
+        uint8_t header[kMaxEntryHeaderSize];
+        size_t headerLen  = EncodeEntryHeader(schema, eventId, utcTimeMs, header);
+        uint32_t entryPos = mFillLength + headerLen;
+        uint32_t room     = (entryPos < PERSISTED_EVENT_LOG_PAGE_SIZE) ? PERSISTED_EVENT_LOG_PAGE_SIZE - entryPos : 0;
+        TLV::TLVWriter writer;
+
+        // Serialize straight into the page, after the entry header.
+        writer.Init(mFillPage + entryPos, std::min<uint32_t>(room, kMaxDataLength));
+        err = serialize(writer, event);
+        if (err == WEAVE_NO_ERROR)
+        {
+            err = writer.Finalize();
+        }
+
+        if (err == WEAVE_NO_ERROR)
+        {
+            dataLen = writer.GetLengthWritten();
+            header[headerLen - 1] = (uint8_t) dataLen;
+            memcpy(mFillPage + mFillLength, header, headerLen);
+
+            mLastUtcTimeMs = utcTimeMs;
+            mLastEventId   = eventId;
+            mLastSchema    = schema;
+
+            mFillLength = (uint16_t)(entryPos + dataLen);
+            page.EventCount++;
+            page.OfferedMs = System::Platform::Layer::GetClock_MonotonicMS();
+            WritePageHeader(mFillPage, page.Sequence, mFillLength - kPageHeaderSize, page.EventCount);
+
+            mStats.PersistedCount++;
+            mStats.EntryBytes += headerLen + dataLen;
+            mStats.ExpandedBytes += kExpandedEntryHeaderSize + dataLen;
+            appended = true;
+        }
+        else if (err == WEAVE_ERROR_BUFFER_TOO_SMALL && page.EventCount != 0 && SealFillPage())
+        {
+            // Retry in the next page.
+            err = WEAVE_NO_ERROR;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if (!appended)
+    {
+        mStats.DroppedCount++;
+    }
+
+    xSemaphoreGive(mLock);
+
+    if (!appended)
+    {
+        WeaveLogError(Support, "Failed to persist event 0x%" PRIx32 ": %s", eventId, ErrorStr(err));
+    }
+
+    // Only the first append of a batch schedules work on the Weave task.
+    if (!__atomic_exchange_n(&mIsFlushScheduled, true, __ATOMIC_ACQ_REL))
+    {
+        PlatformMgr().ScheduleWork(AsyncFlush);
+    }
+}
+
+// Encodes the header of an entry against the last entry of the fill page, with
+// room for its data length at the end. Returns its size. Called with mLock held.
+size_t PersistedEventLog::EncodeEntryHeader(const EventSchema & schema, event_id_t eventId, uint64_t utcTimeMs,
+                                            uint8_t * header) const
+{
+    uint8_t * p    = header;
+    bool hasSchema = (mPages[mFillSlot].EventCount == 0 || !IsSameSchema(schema, mLastSchema));
+
+    WriteVarint(p, ZigZagEncode((int64_t)(utcTimeMs - mLastUtcTimeMs)));
+    WriteVarint(p, (ZigZagEncode((int32_t)(eventId - mLastEventId)) << 1) | (hasSchema ? kEntryFlag_Schema : 0));
+
+    if (hasSchema)
+    {
+        LittleEndian::Write32(p, schema.mProfileId);
+        LittleEndian::Write16(p, (uint16_t) schema.mStructureType);
+        Write8(p, (uint8_t) schema.mImportance);
+        Write8(p, (uint8_t) schema.mDataSchemaVersion);
+    }
+
+    // Data length, set once the data is serialized.
+    p++;
+
+    return p - header;
+}
+
+// Called with mLock held, or before the other tasks log events.
+void PersistedEventLog::StartNewPage(void)
+{
+    PageInfo & page = mPages[mFillSlot];
+
+    if (IsPending(page) && page.EventCount != 0)
+    {
+        mStats.DroppedCount += page.EventCount;
+        WeaveLogError(Support, "Persisted event log full: %u events overwritten before their offload", page.EventCount);
+    }
+
+    memset(&page, 0, sizeof(page));
+    page.Sequence = mNextSequence++;
+
+    mFillLength    = kPageHeaderSize;
+    mFlushedLength = kPageHeaderSize;
+    mLastUtcTimeMs = 0;
+    mLastEventId   = 0;
+    WritePageHeader(mFillPage, page.Sequence, 0, 0);
+}
+
+// Hands the full fill page to the Weave task for writing and starts the next one.
+// Returns false if the previous page is not written yet. Called with mLock held.
+bool PersistedEventLog::SealFillPage(void)
+{
+    if (mWriteBufferState != kWriteBuffer_Free)
+    {
+        return false;
+    }
+
+    memcpy(mWriteBuffer, mFillPage, mFillLength);
+    mWriteLength      = mFillLength;
+    mWriteSlot        = mFillSlot;
+    mWriteBufferState = kWriteBuffer_Sealed;
+
+    mFillSlot = (mFillSlot + 1) % PERSISTED_EVENT_LOG_PAGE_COUNT;
+    StartNewPage();
+
+    return true;
+}
+
+// Writes the page sealed by AppendEntry(), then, with includeFillPage, the part
+// of the fill page not yet in flash.
+WEAVE_ERROR PersistedEventLog::FlushPages(bool includeFillPage)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    bool isSealed;
+    bool isCopied = false;
+
+    xSemaphoreTake(mLock, portMAX_DELAY);
+    isSealed = (mWriteBufferState == kWriteBuffer_Sealed);
+    if (isSealed)
+    {
+        mWriteBufferState = kWriteBuffer_InUse;
+    }
+    xSemaphoreGive(mLock);
+
+    if (isSealed)
+    {
+        err = WritePage(mWriteSlot, mWriteBuffer, mWriteLength);
+        ReleaseWriteBuffer();
+        SuccessOrExit(err);
+    }
+
+    if (!includeFillPage)
+    {
+        ExitNow();
+    }
+
+    xSemaphoreTake(mLock, portMAX_DELAY);
+    if (mWriteBufferState == kWriteBuffer_Free && mFillLength != mFlushedLength)
+    {
+        memcpy(mWriteBuffer, mFillPage, mFillLength);
+        mWriteLength      = mFillLength;
+        mWriteSlot        = mFillSlot;
+        mWriteBufferState = kWriteBuffer_InUse;
+        mFlushedLength    = mFillLength;
+        isCopied          = true;
+    }
+    xSemaphoreGive(mLock);
+
+    if (isCopied)
+    {
+        // The same record is rewritten as the page fills up.
+        err = WritePage(mWriteSlot, mWriteBuffer, mWriteLength);
+        if (err != WEAVE_NO_ERROR)
+        {
+            xSemaphoreTake(mLock, portMAX_DELAY);
+            if (mFillSlot == mWriteSlot)
+            {
+                mFlushedLength = 0;
+            }
+            xSemaphoreGive(mLock);
+        }
+        ReleaseWriteBuffer();
+    }
+
+exit:
+    return err;
+}
+
+WEAVE_ERROR PersistedEventLog::WritePage(uint8_t slot, const uint8_t * page, size_t len)
+{
+    WEAVE_ERROR err = AppPersistentStorage::Write(GetPageRecordId(slot), page, len);
+
+    xSemaphoreTake(mLock, portMAX_DELAY);
+    mStats.PageWriteCount++;
+    xSemaphoreGive(mLock);
+
+    if (err != WEAVE_NO_ERROR)
+    {
+        WeaveLogError(Support, "Failed to write persisted event page %u: %s", slot, ErrorStr(err));
+    }
+
+    return err;
+}
+
+// Reads the page of slot into mWriteBuffer, which the caller owns.
+WEAVE_ERROR PersistedEventLog::ReadPage(uint8_t slot, size_t & len)
+{
+    WEAVE_ERROR err;
+    const uint8_t * p = mWriteBuffer + 4;
+
+    err = AppPersistentStorage::Read(GetPageRecordId(slot), mWriteBuffer, sizeof(mWriteBuffer), len);
+    SuccessOrExit(err);
+
+    VerifyOrExit(len >= kPageHeaderSize && LittleEndian::Read16(p) == len - kPageHeaderSize,
+                 err = WEAVE_ERROR_PERSISTED_STORAGE_VALUE_INVALID);
+
+exit:
+    if (err != WEAVE_NO_ERROR && err != WEAVE_DEVICE_ERROR_CONFIG_NOT_FOUND)
+    {
+        WeaveLogError(Support, "Failed to read persisted event page %u: %s", slot, ErrorStr(err));
+    }
+    return err;
+}
+
+void PersistedEventLog::ReleaseWriteBuffer(void)
+{
+    xSemaphoreTake(mLock, portMAX_DELAY);
+    mWriteBufferState = kWriteBuffer_Free;
+    xSemaphoreGive(mLock);
+}
+
+// Logs again the events of the page of slot that the RAM log does not hold,
+// from entry entryIndex on. Sets entryIndex to the first entry not handled, so
+// that a replay that fails partway resumes there. With dryRun, only copies
+// their data as LogEvent() would, for the benchmark.
+WEAVE_ERROR PersistedEventLog::ReplayPage(uint8_t slot, bool dryRun, uint16_t & entryIndex, uint32_t & replayedCount)
+{
+    WEAVE_ERROR err         = WEAVE_NO_ERROR;
+    const uint8_t * p       = mWriteBuffer + kPageHeaderSize;
+    const uint8_t * pageEnd = mWriteBuffer;
+    uint64_t utcTimeMs      = 0;
+    event_id_t eventId      = 0;
+    bool hasSchema          = false;
+    uint16_t index          = 0;
+    EventSchema schema;
+    PageInfo page;
+    size_t len;
+
+    replayedCount = 0;
+
+    xSemaphoreTake(mLock, portMAX_DELAY);
+    page = mPages[slot];
+    if (mWriteBufferState == kWriteBuffer_Free)
+    {
+        mWriteBufferState = kWriteBuffer_InUse;
+    }
+    else
+    {
+        err = WEAVE_ERROR_INCORRECT_STATE;
+    }
+    xSemaphoreGive(mLock);
+    if (err != WEAVE_NO_ERROR)
+    {
+        return err;
+    }
+
+    err = ReadPage(slot, len);
+    SuccessOrExit(err);
+
+    VerifyOrExit(LittleEndian::Get32(mWriteBuffer) == page.Sequence, err = WEAVE_ERROR_PERSISTED_STORAGE_VALUE_INVALID);
+    pageEnd += len;
+
+    while (p < pageEnd)
+    {
+        uint64_t utcDelta;
+        uint64_t eventIdField;
+        EntryData entry;
+
+        // Expand the entry header.
+        VerifyOrExit(ReadVarint(p, pageEnd, utcDelta) && ReadVarint(p, pageEnd, eventIdField),
+                     err = WEAVE_ERROR_PERSISTED_STORAGE_VALUE_INVALID);
+        utcTimeMs += ZigZagDecode(utcDelta);
+        eventId += (event_id_t) ZigZagDecode(eventIdField >> 1);
+
+        if (eventIdField & kEntryFlag_Schema)
+        {
+            VerifyOrExit(p + kSchemaSize <= pageEnd, err = WEAVE_ERROR_PERSISTED_STORAGE_VALUE_INVALID);
+            schema.mProfileId                      = LittleEndian::Read32(p);
+            schema.mStructureType                  = LittleEndian::Read16(p);
+            schema.mImportance                     = static_cast<ImportanceType>(Read8(p));
+            schema.mDataSchemaVersion              = Read8(p);
+            schema.mMinCompatibleDataSchemaVersion = 1;
+            hasSchema                              = true;
+        }
+
+        VerifyOrExit(hasSchema && p < pageEnd, err = WEAVE_ERROR_PERSISTED_STORAGE_VALUE_INVALID);
+        entry.Length = Read8(p);
+        entry.Data   = p;
+
+        p += entry.Length;
+        VerifyOrExit(p <= pageEnd, err = WEAVE_ERROR_PERSISTED_STORAGE_VALUE_INVALID);
+
+        // Handled by a previous attempt.
+        if (index++ < entryIndex)
+        {
+            continue;
+        }
+
+        if (dryRun)
+        {
+            uint8_t scratch[kMaxDataLength + 8];
+            TLV::TLVWriter writer;
+
+            writer.Init(scratch, sizeof(scratch));
+            err = WriteEntryData(writer, kTag_EventData, &entry);
+            SuccessOrExit(err);
+        }
+        else
+        {
+            // Still in the RAM log unless logged before this boot or evicted.
+            if (!page.FromPreviousBoot && eventId >= LoggingManagement::GetInstance().GetFirstEventID(schema.mImportance))
+            {
+                entryIndex = index;
+                continue;
+            }
+
+            // The copy gets a new event id: it points at the original one, so
+            // that the service can drop a copy of an event it already has.
+            EventOptions options(false);
+            options.relatedEventID    = eventId;
+            options.relatedImportance = schema.mImportance;
+            if (utcTimeMs != 0)
+            {
+                options.timestamp.utcTimestamp = utcTimeMs;
+                options.timestampType          = kTimestampType_UTC;
+            }
+
+            VerifyOrExit(LogEvent(schema, WriteEntryData, &entry, &options) != 0, err = WEAVE_ERROR_NO_MEMORY);
+            WDMFeatureBase::GetBaseInstance().OnEventLogged(schema.mImportance, entry.Length);
+        }
+
+        entryIndex = index;
+        replayedCount++;
+    }
+
+exit:
+    ReleaseWriteBuffer();
+    return err;
+}
+
+void PersistedEventLog::OnServiceCounterSubscriptionChange(bool established)
+{
+    mIsServiceConnected = established;
+
+    if (established)
+    {
+        mConnectedSinceMs     = System::Platform::Layer::GetClock_MonotonicMS();
+        mOffloadReplayedCount = 0;
+
+        // Events logged during the disconnection may have been evicted from
+        // the RAM log. The fill page holds the most recent ones.
+        xSemaphoreTake(mLock, portMAX_DELAY);
+        for (uint8_t slot = 0; slot < PERSISTED_EVENT_LOG_PAGE_COUNT; slot++)
+        {
+            PageInfo & page = mPages[slot];
+
+            if (IsPending(page) && page.EventCount != 0 && slot != mFillSlot)
+            {
+                page.NeedsReplay     = true;
+                page.ReplayedEntries = 0;
+                mIsOffloadPending    = true;
+            }
+        }
+        xSemaphoreGive(mLock);
+    }
+
+    RunMaintenance();
+}
+
+void PersistedEventLog::OnEventsDelivered(uint64_t loggedBeforeMs)
+{
+    if (loggedBeforeMs > mDeliveredBeforeMs)
+    {
+        mDeliveredBeforeMs = loggedBeforeMs;
+        RunMaintenance();
+    }
+}
+
+// Logs again the next page that needs it, retires the pages the service has,
+// and arms the maintenance timer for what is left. Called on the Weave task.
+void PersistedEventLog::RunMaintenance(void)
+{
+    uint64_t nowMs   = System::Platform::Layer::GetClock_MonotonicMS();
+    bool needsReplay = false;
+    uint32_t delayMs = UINT32_MAX;
+
+    SystemLayer.CancelTimer(HandleMaintenanceTimer, this);
+    if (!mIsServiceConnected)
+    {
+        ExitNow();
+    }
+
+    // One page at a time, in the order they were written. The slots are shared
+    // with the tasks logging events, which may seal the fill page meanwhile.
+    while (!needsReplay)
+    {
+        uint8_t slot        = 0;
+        uint32_t sequence   = 0;
+        uint16_t entryIndex = 0;
+        bool found          = false;
+        bool isDone         = true;
+        bool isLost;
+        uint32_t replayedCount;
+        WEAVE_ERROR err;
+
+        xSemaphoreTake(mLock, portMAX_DELAY);
+        for (uint8_t i = 1; i <= PERSISTED_EVENT_LOG_PAGE_COUNT && !found; i++)
+        {
+            slot       = (mFillSlot + i) % PERSISTED_EVENT_LOG_PAGE_COUNT;
+            sequence   = mPages[slot].Sequence;
+            entryIndex = mPages[slot].ReplayedEntries;
+            found      = mPages[slot].NeedsReplay;
+        }
+        xSemaphoreGive(mLock);
+
+        if (!found)
+        {
+            break;
+        }
+
+        err = ReplayPage(slot, false, entryIndex, replayedCount);
+        if (err == WEAVE_ERROR_INCORRECT_STATE)
+        {
+            // The write buffer is busy; try again later.
+            needsReplay = true;
+            break;
+        }
+        isLost = (err == WEAVE_ERROR_PERSISTED_STORAGE_VALUE_INVALID || err == WEAVE_DEVICE_ERROR_CONFIG_NOT_FOUND);
+        if (isLost)
+        {
+            // A missing or corrupt page never reads better: give up on the rest of it.
+            WeaveLogError(Support, "Persisted event page %u unreadable after %u entries: %s", slot, entryIndex, ErrorStr(err));
+        }
+        else if (err != WEAVE_NO_ERROR)
+        {
+            // Resume from the first entry not logged again, after the replay interval.
+            WeaveLogError(Support, "Failed to log persisted events again: %s", ErrorStr(err));
+            isDone = false;
+        }
+
+        xSemaphoreTake(mLock, portMAX_DELAY);
+        // Unless the slot was overwritten meanwhile.
+        if (mPages[slot].Sequence == sequence)
+        {
+            mPages[slot].NeedsReplay     = !isDone;
+            mPages[slot].ReplayedEntries = isDone ? 0 : entryIndex;
+            if (replayedCount != 0)
+            {
+                mPages[slot].OfferedMs = System::Platform::Layer::GetClock_MonotonicMS();
+            }
+            if (isLost)
+            {
+                mStats.DroppedCount += mPages[slot].EventCount - std::min(entryIndex, mPages[slot].EventCount);
+            }
+        }
+        mStats.ReplayedCount += replayedCount;
+        xSemaphoreGive(mLock);
+
+        mOffloadReplayedCount += replayedCount;
+
+        // Leave the RAM log the time to be offloaded before the next page, or
+        // before another attempt at a page that failed.
+        if (replayedCount != 0 || !isDone)
+        {
+            needsReplay = true;
+        }
+    }
+
+    if (needsReplay)
+    {
+        delayMs = PERSISTED_EVENT_LOG_REPLAY_INTERVAL_MS;
+    }
+    else if (mIsOffloadPending)
+    {
+        mIsOffloadPending = false;
+        if (mOffloadReplayedCount != 0)
+        {
+            uint32_t offloadMs = (uint32_t)(nowMs - mConnectedSinceMs);
+
+            xSemaphoreTake(mLock, portMAX_DELAY);
+            mStats.LastOffloadMs = offloadMs;
+            xSemaphoreGive(mLock);
+
+            WeaveLogProgress(Support, "Logged %" PRIu32 " persisted events again %" PRIu32 " ms after connecting",
+                             mOffloadReplayedCount, offloadMs);
+        }
+    }
+
+    RetirePages();
+
+    if (delayMs != UINT32_MAX)
+    {
+        SystemLayer.StartTimer(delayMs, HandleMaintenanceTimer, this);
+    }
+
+exit:
+    return;
+}
+
+// Retires the oldest pages whose events all entered the RAM log before
+// mDeliveredBeforeMs, and are not to be logged again.
+void PersistedEventLog::RetirePages(void)
+{
+    WEAVE_ERROR err;
+    uint32_t retiredSequence = mRetiredSequence;
+    uint32_t retiredCount    = 0;
+    bool retireFillPage      = false;
+
+    xSemaphoreTake(mLock, portMAX_DELAY);
+
+    for (uint8_t i = 1; i <= PERSISTED_EVENT_LOG_PAGE_COUNT; i++)
+    {
+        uint8_t slot          = (mFillSlot + i) % PERSISTED_EVENT_LOG_PAGE_COUNT;
+        const PageInfo & page = mPages[slot];
+
+        if (!IsPending(page) || page.EventCount == 0)
+        {
+            continue;
+        }
+
+        if (page.NeedsReplay || page.OfferedMs >= mDeliveredBeforeMs)
+        {
+            break;
+        }
+
+        retiredSequence = page.Sequence;
+        retiredCount += page.EventCount;
+        retireFillPage = (slot == mFillSlot);
+    }
+
+    xSemaphoreGive(mLock);
+
+    if (retiredSequence == mRetiredSequence)
+    {
+        ExitNow();
+    }
+
+    // A single record write retires all the pages at once.
+    err = AppPersistentStorage::WriteRecord(AppPersistentStorage::kRecordId_EventLogRetired, retiredSequence);
+
+    xSemaphoreTake(mLock, portMAX_DELAY);
+    mStats.MetaWriteCount++;
+    if (err == WEAVE_NO_ERROR)
+    {
+        mRetiredSequence = retiredSequence;
+        mStats.RetiredCount += retiredCount;
+
+        // Its events are offloaded: later ones go to a new page.
+        if (retireFillPage && mPages[mFillSlot].Sequence == retiredSequence)
+        {
+            mFillSlot = (mFillSlot + 1) % PERSISTED_EVENT_LOG_PAGE_COUNT;
+            StartNewPage();
+        }
+    }
+    xSemaphoreGive(mLock);
+
+    if (err != WEAVE_NO_ERROR)
+    {
+        WeaveLogError(Support, "Failed to retire persisted events: %s", ErrorStr(err));
+    }
+
+exit:
+    return;
+}
+
+void PersistedEventLog::AsyncFlush(intptr_t arg)
+{
+    PersistedEventLog & self = sInstance;
+
+    __atomic_store_n(&self.mIsFlushScheduled, false, __ATOMIC_RELEASE);
+
+    // Full pages are written right away, the fill page after a delay so that
+    // the events that follow share the write.
+    self.FlushPages(false);
+
+    if (!self.mIsFlushTimerArmed &&
+        SystemLayer.StartTimer(PERSISTED_EVENT_LOG_FLUSH_DELAY_MS, HandleFlushTimer, NULL) == WEAVE_SYSTEM_NO_ERROR)
+    {
+        self.mIsFlushTimerArmed = true;
+    }
+
+    if (self.mIsServiceConnected)
+    {
+        self.RunMaintenance();
+    }
+}
+
+void PersistedEventLog::HandleFlushTimer(System::Layer * systemLayer, void * appState, System::Error error)
+{
+    sInstance.mIsFlushTimerArmed = false;
+    sInstance.FlushPages(true);
+}
+
+void PersistedEventLog::HandleMaintenanceTimer(System::Layer * systemLayer, void * appState, System::Error error)
+{
+    static_cast<PersistedEventLog *>(appState)->RunMaintenance();
+}
+
+void PersistedEventLog::GetStats(Stats & stats)
+{
+    xSemaphoreTake(mLock, portMAX_DELAY);
+    stats = mStats;
+    xSemaphoreGive(mLock);
+}
+
+void PersistedEventLog::LogStats(void)
+{
+    Stats stats;
+
+    GetStats(stats);
+
+    WeaveLogProgress(Support,
+                     "Persisted events: %" PRIu32 " persisted in %" PRIu32 " bytes (%" PRIu32 " expanded), %" PRIu32
+                     " dropped, %" PRIu32 " replayed, %" PRIu32 " retired, %" PRIu32 "+%" PRIu32 " flash writes",
+                     stats.PersistedCount, stats.EntryBytes, stats.ExpandedBytes, stats.DroppedCount, stats.ReplayedCount,
+                     stats.RetiredCount, stats.PageWriteCount, stats.MetaWriteCount);
+}
+
+#if PERSISTED_EVENT_LOG_BENCHMARK
+void PersistedEventLog::RunBenchmark(const EventSchema & schema, SerializeFunct serialize, const void * event,
+                                     const char * name)
+{
+    enum
+    {
+        kEventCount = 1000
+    };
+    Stats before;
+    Stats after;
+    uint64_t startUs;
+    uint32_t persistUs;
+    uint32_t offloadUs;
+    uint32_t readCount = 0;
+    uint32_t writeCount;
+
+    GetStats(before);
+
+    // As if the service were unreachable: every event stays pending. Full pages
+    // are written as soon as they are sealed, as the Weave task would.
+    startUs = System::Platform::Layer::GetClock_MonotonicHiRes();
+    for (uint32_t i = 0; i < kEventCount; i++)
+    {
+        AppendEntry(schema, i + 1, serialize, event);
+        FlushPages(false);
+    }
+    FlushPages(true);
+    persistUs = (uint32_t)(System::Platform::Layer::GetClock_MonotonicHiRes() - startUs);
+
+    // Read the pages back and copy each event as logging it again would.
+    startUs = System::Platform::Layer::GetClock_MonotonicHiRes();
+    for (uint8_t i = 1; i <= PERSISTED_EVENT_LOG_PAGE_COUNT; i++)
+    {
+        uint8_t slot = (mFillSlot + i) % PERSISTED_EVENT_LOG_PAGE_COUNT;
+        uint16_t entryIndex = 0;
+        uint32_t replayedCount;
+
+        if (IsPending(mPages[slot]) && mPages[slot].EventCount != 0 &&
+            ReplayPage(slot, true, entryIndex, replayedCount) == WEAVE_NO_ERROR)
+        {
+            readCount += replayedCount;
+        }
+    }
+    offloadUs = (uint32_t)(System::Platform::Layer::GetClock_MonotonicHiRes() - startUs);
+
+    GetStats(after);
+    writeCount = after.PageWriteCount - before.PageWriteCount;
+
+    WeaveLogProgress(Support,
+                     "%s persist: %" PRIu32 "/%d events in %" PRIu32 " us (%" PRIu32 " events/s), %" PRIu32
+                     " flash writes (%" PRIu32 " per 1000 events)",
+                     name, after.PersistedCount - before.PersistedCount, kEventCount, persistUs,
+                     (uint32_t)((uint64_t) kEventCount * 1000000 / std::max<uint32_t>(persistUs, 1)), writeCount,
+                     (uint32_t)((uint64_t) writeCount * 1000 / kEventCount));
+    WeaveLogProgress(Support, "%s offload: %" PRIu32 " events read back in %" PRIu32 " us", name, readCount, offloadUs);
+
+    // Retire the benchmark events so they are not offloaded.
+    xSemaphoreTake(mLock, portMAX_DELAY);
+    mFillSlot        = (mFillSlot + 1) % PERSISTED_EVENT_LOG_PAGE_COUNT;
+    mRetiredSequence = mNextSequence - 1;
+    StartNewPage();
+    xSemaphoreGive(mLock);
+    AppPersistentStorage::WriteRecord(AppPersistentStorage::kRecordId_EventLogRetired, mRetiredSequence);
+}
+#endif // PERSISTED_EVENT_LOG_BENCHMARK
+
+#endif // PERSISTED_EVENT_LOG_PAGE_COUNT
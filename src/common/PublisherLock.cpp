@@ -0,0 +1,110 @@
+/*
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "PublisherLock.h"
+
+#include "task.h"
+
+#include <algorithm>
+#include <inttypes.h>
+#include <string.h>
+
+using namespace ::nl::Weave;
+
+int PublisherLock::Init()
+{
+#if APP_USE_STATIC_ALLOCATION
+    mRecursiveLock = xSemaphoreCreateRecursiveMutexStatic(&mRecursiveLockStruct);
+#else
+    mRecursiveLock = xSemaphoreCreateRecursiveMutex();
+#endif
+    mDepth = 0;
+    memset(&mStats, 0, sizeof(mStats));
+
+    return ((mRecursiveLock == NULL) ? WEAVE_ERROR_NO_MEMORY : WEAVE_NO_ERROR);
+}
+
+WEAVE_ERROR PublisherLock::Lock()
+{
+    uint64_t startUs = System::Platform::Layer::GetClock_MonotonicHiRes();
+    bool contended   = false;
+
+    if (pdTRUE != xSemaphoreTakeRecursive((SemaphoreHandle_t) mRecursiveLock, 0))
+    {
+        contended = true;
+        if (pdTRUE != xSemaphoreTakeRecursive((SemaphoreHandle_t) mRecursiveLock, portMAX_DELAY))
+        {
+            return WEAVE_ERROR_LOCKING_FAILURE;
+        }
+    }
+
+    if (mDepth++ == 0)
+    {
+        mAcquiredTimeUs = System::Platform::Layer::GetClock_MonotonicHiRes();
+
+        taskENTER_CRITICAL();
+        mStats.LockCount++;
+        if (contended)
+        {
+            uint32_t waitUs = (uint32_t)(mAcquiredTimeUs - startUs);
+            mStats.ContendedCount++;
+            mStats.MaxWaitUs = std::max(mStats.MaxWaitUs, waitUs);
+        }
+        taskEXIT_CRITICAL();
+    }
+
+    return WEAVE_NO_ERROR;
+}
+
+WEAVE_ERROR PublisherLock::Unlock()
+{
+    if (mDepth != 0 && --mDepth == 0)
+    {
+        uint32_t holdUs = (uint32_t)(System::Platform::Layer::GetClock_MonotonicHiRes() - mAcquiredTimeUs);
+
+        taskENTER_CRITICAL();
+        mStats.MaxHoldUs = std::max(mStats.MaxHoldUs, holdUs);
+        mStats.TotalHoldUs += holdUs;
+        taskEXIT_CRITICAL();
+    }
+
+    if (pdTRUE != xSemaphoreGiveRecursive((SemaphoreHandle_t) mRecursiveLock))
+    {
+        return WEAVE_ERROR_LOCKING_FAILURE;
+    }
+
+    return WEAVE_NO_ERROR;
+}
+
+void PublisherLock::GetStats(Stats & stats)
+{
+    taskENTER_CRITICAL();
+    stats = mStats;
+    taskEXIT_CRITICAL();
+}
+
+void PublisherLock::LogStats(void)
+{
+    Stats stats;
+
+    GetStats(stats);
+    WeaveLogProgress(Support,
+                     "PublisherLock: %" PRIu32 " locks, %" PRIu32 " contended, wait max %" PRIu32 " us, hold avg %" PRIu32
+                     " us, max %" PRIu32 " us",
+                     stats.LockCount, stats.ContendedCount, stats.MaxWaitUs,
+                     (stats.LockCount != 0) ? (uint32_t)(stats.TotalHoldUs / stats.LockCount) : 0, stats.MaxHoldUs);
+}
@@ -0,0 +1,113 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "ResponseBufferPool.h"
+
+#include <string.h>
+
+using namespace ::nl::Weave;
+using namespace ::nl::Weave::DeviceLayer;
+
+ResponseBufferPool::ResponseBufferPool(void) : mCount(0), mIsRefillTimerArmed(false)
+{
+    memset(mBuffers, 0, sizeof(mBuffers));
+    memset(&mStats, 0, sizeof(mStats));
+    mPublishedStats.Init(mStats);
+}
+
+void ResponseBufferPool::Init(void)
+{
+    if (!Refill())
+    {
+        ScheduleRefill(RESPONSE_BUFFER_POOL_RETRY_MS);
+    }
+}
+
+System::PacketBuffer * ResponseBufferPool::Take(void)
+{
+    System::PacketBuffer * buf = NULL;
+
+    if (mCount != 0)
+    {
+        buf              = mBuffers[--mCount];
+        mBuffers[mCount] = NULL;
+        mStats.TakenCount++;
+    }
+    else
+    {
+        WeaveLogError(Support, "Response buffer pool empty");
+
+        buf = System::PacketBuffer::New();
+        if (buf != NULL)
+        {
+            mStats.AllocatedCount++;
+        }
+        else
+        {
+            mStats.FailedCount++;
+        }
+    }
+    mPublishedStats.Publish(mStats);
+
+    // Replace it once the handler returns and the command buffers are freed.
+    ScheduleRefill(0);
+
+    return buf;
+}
+
+// Returns false if the packet buffers are exhausted before the pool is full.
+bool ResponseBufferPool::Refill(void)
+{
+    bool isFull = true;
+
+    while (mCount < RESPONSE_BUFFER_POOL_SIZE)
+    {
+        System::PacketBuffer * buf = System::PacketBuffer::New();
+
+        if (buf == NULL)
+        {
+            mStats.RefillFailureCount++;
+            mPublishedStats.Publish(mStats);
+            isFull = false;
+            break;
+        }
+
+        mBuffers[mCount++] = buf;
+    }
+
+    return isFull;
+}
+
+void ResponseBufferPool::ScheduleRefill(uint32_t delayMs)
+{
+    if (!mIsRefillTimerArmed && SystemLayer.StartTimer(delayMs, HandleRefillTimer, this) == WEAVE_SYSTEM_NO_ERROR)
+    {
+        mIsRefillTimerArmed = true;
+    }
+}
+
+void ResponseBufferPool::HandleRefillTimer(System::Layer * systemLayer, void * appState, System::Error error)
+{
+    ResponseBufferPool * pool = static_cast<ResponseBufferPool *>(appState);
+
+    pool->mIsRefillTimerArmed = false;
+    if (!pool->Refill())
+    {
+        pool->ScheduleRefill(RESPONSE_BUFFER_POOL_RETRY_MS);
+    }
+}
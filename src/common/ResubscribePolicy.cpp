@@ -0,0 +1,71 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "ResubscribePolicy.h"
+
+#include <Weave/DeviceLayer/WeaveDeviceLayer.h>
+#include <Weave/Support/RandUtils.h>
+#include <Weave/Support/crypto/WeaveRNG.h>
+
+#include <algorithm>
+
+// The jitter must differ between devices, so it is drawn from the DRBG, which
+// is seeded from device entropy, rather than from rand().
+static uint32_t GetRandomU32(void)
+{
+    uint32_t value;
+
+    if (nl::Weave::Platform::Security::GetSecureRandomData(reinterpret_cast<uint8_t *>(&value), sizeof(value)) !=
+        WEAVE_NO_ERROR)
+    {
+        value = nl::Weave::GetRandU32();
+    }
+
+    return value;
+}
+
+DecorrelatedJitterResubscribePolicy::DecorrelatedJitterResubscribePolicy(uint32_t baseIntervalMs, uint32_t maxIntervalMs) :
+    mBaseIntervalMs(baseIntervalMs), mMaxIntervalMs(maxIntervalMs), mLastIntervalMs(baseIntervalMs), mRetryNow(false)
+{}
+
+uint32_t DecorrelatedJitterResubscribePolicy::GetRetryIntervalMs(uint32_t retryCount)
+{
+    uint32_t upperMs;
+
+    if (mRetryNow)
+    {
+        mRetryNow       = false;
+        mLastIntervalMs = mBaseIntervalMs;
+        return 0;
+    }
+
+    if (retryCount == 0)
+    {
+        mLastIntervalMs = mBaseIntervalMs;
+    }
+
+    upperMs         = std::min(mMaxIntervalMs, std::max(mBaseIntervalMs, mLastIntervalMs * 3));
+    mLastIntervalMs = mBaseIntervalMs + GetRandomU32() % (upperMs - mBaseIntervalMs + 1);
+
+    return mLastIntervalMs;
+}
+
+void DecorrelatedJitterResubscribePolicy::OnLinkRestored(void)
+{
+    mRetryNow = true;
+}
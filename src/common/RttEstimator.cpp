@@ -0,0 +1,89 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "RttEstimator.h"
+
+#include <algorithm>
+#include <string.h>
+
+void RttEstimator::Init(uint32_t minTimeoutMs, uint32_t maxTimeoutMs, uint32_t granularityMs)
+{
+    mMinTimeoutMs     = minTimeoutMs;
+    mMaxTimeoutMs     = maxTimeoutMs;
+    mGranularityMs    = granularityMs;
+    mScaledSrtt       = 0;
+    mScaledRttVar     = 0;
+    mRetransTimeoutMs = maxTimeoutMs;
+
+    memset(&mStats, 0, sizeof(mStats));
+    mStats.MinRttMs         = UINT32_MAX;
+    mStats.RetransTimeoutMs = mRetransTimeoutMs;
+    mPublishedStats.Init(mStats);
+}
+
+bool RttEstimator::AddSample(uint32_t rttMs)
+{
+    if (mStats.SampleCount == 0)
+    {
+        // SRTT = R, RTTVAR = R / 2
+        mScaledSrtt   = rttMs << 3;
+        mScaledRttVar = rttMs << 1;
+    }
+    else
+    {
+        int32_t delta = (int32_t) rttMs - (int32_t)(mScaledSrtt >> 3);
+
+        // RTTVAR = 3/4 RTTVAR + 1/4 |SRTT - R|, then SRTT = 7/8 SRTT + 1/8 R
+        mScaledRttVar += (uint32_t)((delta < 0) ? -delta : delta) - (mScaledRttVar >> 2);
+        mScaledSrtt += delta;
+    }
+
+    mStats.SampleCount++;
+    mStats.LastRttMs = rttMs;
+    mStats.MinRttMs  = std::min(mStats.MinRttMs, rttMs);
+    mStats.MaxRttMs  = std::max(mStats.MaxRttMs, rttMs);
+    mStats.SrttMs    = mScaledSrtt >> 3;
+    mStats.RttVarMs  = mScaledRttVar >> 2;
+
+    // 4 * RTTVAR is the scaled RTTVAR itself.
+    return SetRetransTimeout(mStats.SrttMs + std::max(mGranularityMs, mScaledRttVar));
+}
+
+bool RttEstimator::Backoff(void)
+{
+    mStats.BackoffCount++;
+
+    return SetRetransTimeout(mRetransTimeoutMs * 2);
+}
+
+void RttEstimator::DiscardSample(void)
+{
+    mStats.DiscardedCount++;
+    mPublishedStats.Publish(mStats);
+}
+
+bool RttEstimator::SetRetransTimeout(uint32_t timeoutMs)
+{
+    uint32_t previousTimeoutMs = mRetransTimeoutMs;
+
+    mRetransTimeoutMs       = std::min(std::max(timeoutMs, mMinTimeoutMs), mMaxTimeoutMs);
+    mStats.RetransTimeoutMs = mRetransTimeoutMs;
+    mPublishedStats.Publish(mStats);
+
+    return (mRetransTimeoutMs != previousTimeoutMs);
+}
@@ -0,0 +1,78 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      Small binary records of the application kept across reboots, next to
+ *      (but separate from) the Weave configuration of the Device Layer.
+ *
+ *      Each platform provides the backend in its AppPersistentStorage.cpp:
+ *      nvm3 objects on EFR32, FDS records on nRF5 and files on posix.
+ */
+
+#ifndef APP_PERSISTENT_STORAGE_H
+#define APP_PERSISTENT_STORAGE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <Weave/DeviceLayer/WeaveDeviceLayer.h>
+
+class AppPersistentStorage
+{
+public:
+    enum RecordId
+    {
+        kRecordId_SettingsSink     = 1, // Data version and state of the settings trait sink.
+        kRecordId_EventLogRetired  = 2, // Last page sequence of the persisted event log known to be offloaded.
+        kRecordId_LocalPeer        = 3, // Node id of the device allowed to subscribe locally (see GenericWDMFeature.h).
+        kRecordId_AssociatedSensor = 4, // Node id and address of the sensor associated with the lock (see AssociatedSensor.h).
+
+        // Pages of the persisted event log (see PersistedEventLog.h).
+        kRecordId_EventLogPageFirst = 0x40,
+        kRecordId_EventLogPageLast  = 0x7F,
+
+        kRecordId_Max = 0x7F
+    };
+
+    // Returns WEAVE_DEVICE_ERROR_CONFIG_NOT_FOUND if the record does not exist
+    // and WEAVE_ERROR_BUFFER_TOO_SMALL if it does not fit in buf.
+    static WEAVE_ERROR Read(RecordId id, void * buf, size_t bufSize, size_t & readLen);
+    static WEAVE_ERROR Write(RecordId id, const void * data, size_t dataLen);
+
+    // Deletes all the records. Called before a factory reset, which only
+    // erases the Weave configuration.
+    static WEAVE_ERROR EraseAll(void);
+
+    // Reads a record of exactly sizeof(T) bytes.
+    template <typename T>
+    static bool ReadRecord(RecordId id, T & record)
+    {
+        size_t readLen;
+
+        return (Read(id, &record, sizeof(record), readLen) == WEAVE_NO_ERROR) && (readLen == sizeof(record));
+    }
+
+    template <typename T>
+    static WEAVE_ERROR WriteRecord(RecordId id, const T & record)
+    {
+        return Write(id, &record, sizeof(record));
+    }
+};
+
+#endif // APP_PERSISTENT_STORAGE_H
@@ -19,6 +19,17 @@
 #ifndef APP_TASK_H
 #define APP_TASK_H
 
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+
+// Returned by an EventLoopCycleCallback_t (and the LED/Button deadline helpers)
+// when nothing needs to happen until the next event is posted.
+#define APP_EVENT_LOOP_NO_DEADLINE UINT32_MAX
+
+// Size of the data that can be carried inline by an AppTaskEvent.
+#define APP_TASK_EVENT_PAYLOAD_SIZE 16
+
 /**
  * The FreeRTOS Application Task.
  */
@@ -32,35 +43,112 @@ public:
      * [FIXME: provide additional details on this.]
      * The mechanism used to make this possible is to simply post an AppTaskEvent
      * to the event queue of the application task. That event has two components:
-     * 1) information about the specific hardware event (void * data),
+     * 1) information about the specific hardware event (Payload),
      * and 2) the callback function that is to be invoked (AppTaskEventHandler_t).
+     *
+     * The payload is stored inline and copied by value into the queue, so the data
+     * posted may live on the caller's stack (ISR, timer callback, Weave task).
+     * The handler gets a pointer to the copy, valid for the duration of the call.
      */
     typedef void (*AppTaskEventHandler_t)(void * eventData);
 
+    /**
+     * Events are posted on one of several lanes (one FreeRTOS queue each).
+     * The AppTask drains the lanes in strict priority order: an event is only
+     * dispatched from a lane when all higher priority lanes are empty, so
+     * lock-critical events never wait behind UI work.
+     */
+    enum EventLane_t
+    {
+        kEventLane_Actuator = 0, // Actuator completions (highest priority).
+        kEventLane_Command,      // Commands: service requests, auto-lock.
+        kEventLane_UI,           // Buttons, software update, other UI work.
+
+        kEventLane_Count,
+    };
+
+    // Counters for a lane. Latency is the time between PostEvent and dispatch.
+    // Per-handler histograms are kept by AppTaskStats.
+    struct LaneStats
+    {
+        uint32_t DispatchCount;
+        uint32_t DropCount;
+        uint32_t HighWaterMark; // Most events ever waiting in the lane.
+        uint32_t MaxLatencyMs;
+        uint64_t TotalLatencyMs;
+    };
+
     struct AppTaskEvent
     {
         AppTaskEventHandler_t Handler;
-        void * Data;
+        uint32_t PostedTimeUs; // Set by PostEvent (low 32 bits of the monotonic hi-res clock).
+        uint32_t PostedTick;   // Set by PostEventFromISR (FreeRTOS tick count).
+        bool PostedFromISR;
+        union
+        {
+            uint8_t Bytes[APP_TASK_EVENT_PAYLOAD_SIZE];
+            uint64_t AlignAs64;
+            void * AlignAsPtr;
+        } Payload;
     };
 
     // The function called at every cycle of the AppTask event loop.
     // This is a static method on the DeviceController so it can update the state
     // of LEDs, Buttons, etc.
-    typedef void (*EventLoopCycleCallback_t)(void);
+    // Returns the number of milliseconds after which it must be called again
+    // (e.g. next LED blink phase, next long press threshold), or
+    // APP_EVENT_LOOP_NO_DEADLINE. AppTask sleeps until then or until an event is posted.
+    typedef uint32_t (*EventLoopCycleCallback_t)(void);
 
     // Called my 'main' to start the AppTask.
     int StartAppTask(EventLoopCycleCallback_t callback);
 
-    // Posts an event on the AppTask event queue.
-    void PostEvent(const AppTaskEvent * event);
+    // Posts an event on an AppTask event lane. Returns false if the event was
+    // dropped because the lane is full.
+    bool PostEvent(AppTaskEvent * event, EventLane_t lane = kEventLane_UI);
+
+    // Posts an event without data on an AppTask event lane.
+    bool PostEvent(AppTaskEventHandler_t handler, EventLane_t lane = kEventLane_UI);
+
+    // Posts an event on an AppTask event lane; 'data' is copied into the event.
+    // The handler receives a pointer to a T.
+    template <typename T>
+    bool PostEvent(AppTaskEventHandler_t handler, const T & data, EventLane_t lane = kEventLane_UI);
+
+    // Same as PostEvent, for use from interrupt context. Never blocks (the
+    // event is dropped if the lane is full) and yields on exit if the AppTask
+    // was woken, so the event is handled as soon as the ISR returns.
+    void PostEventFromISR(AppTaskEvent * event, EventLane_t lane = kEventLane_UI);
+
+    template <typename T>
+    void PostEventFromISR(AppTaskEventHandler_t handler, const T & data, EventLane_t lane = kEventLane_UI);
+
+    // Returns the latency counters of a lane.
+    void GetLaneStats(EventLane_t lane, LaneStats & stats);
+
+    // Number of times the AppTask woke up (event posted or deadline reached) since it started.
+    uint32_t GetWakeupCount(void);
+
+    // Average number of wakeups per hour since the AppTask started.
+    uint32_t GetWakeupsPerHour(void);
 
 private:
     // Callback method called at every event loop cycle.
     static EventLoopCycleCallback_t sEventLoopCycleCallback;
 
+    // Wakeup accounting.
+    static uint32_t sWakeupCount;
+    static uint64_t sStartTimeMs;
+    static uint64_t sLastStatsLogTimeMs;
+    static void LogStats(void);
+
+    // Per lane latency accounting.
+    static LaneStats sLaneStats[kEventLane_Count];
+
     int Init();
     static void AppTaskMain(void * pvParameter);
-    void DispatchEvent(const AppTaskEvent * event);
+    static bool DispatchNextEvent(void);
+    void DispatchEvent(const AppTaskEvent * event, EventLane_t lane);
 
     // Singleton.
     friend AppTask & GetAppTask(void);
@@ -73,4 +161,28 @@ inline AppTask & GetAppTask(void)
     return AppTask::sAppTask;
 }
 
+template <typename T>
+bool AppTask::PostEvent(AppTaskEventHandler_t handler, const T & data, EventLane_t lane)
+{
+    static_assert(sizeof(T) <= APP_TASK_EVENT_PAYLOAD_SIZE, "Event data does not fit in AppTaskEvent payload");
+    static_assert(std::is_trivially_copyable<T>::value, "Event data must be trivially copyable");
+
+    AppTaskEvent event;
+    event.Handler = handler;
+    memcpy(event.Payload.Bytes, &data, sizeof(T));
+    return PostEvent(&event, lane);
+}
+
+template <typename T>
+void AppTask::PostEventFromISR(AppTaskEventHandler_t handler, const T & data, EventLane_t lane)
+{
+    static_assert(sizeof(T) <= APP_TASK_EVENT_PAYLOAD_SIZE, "Event data does not fit in AppTaskEvent payload");
+    static_assert(std::is_trivially_copyable<T>::value, "Event data must be trivially copyable");
+
+    AppTaskEvent event;
+    event.Handler = handler;
+    memcpy(event.Payload.Bytes, &data, sizeof(T));
+    PostEventFromISR(&event, lane);
+}
+
 #endif // APP_TASK_H
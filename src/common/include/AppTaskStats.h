@@ -0,0 +1,105 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#ifndef APP_TASK_STATS_H
+#define APP_TASK_STATS_H
+
+#include <stdint.h>
+
+#include "AppTask.h"
+
+// Number of distinct event handlers tracked. Events for handlers beyond this
+// limit are accounted in a shared "other" entry.
+#ifndef APP_TASK_STATS_MAX_HANDLERS
+#define APP_TASK_STATS_MAX_HANDLERS 12
+#endif
+
+// Number of log2 buckets in each histogram. Bucket 0 counts values of 0 us,
+// bucket i counts values in [2^(i-1), 2^i) us, and the last bucket also
+// counts everything above.
+#define APP_TASK_STATS_HISTOGRAM_BUCKETS 20
+
+/**
+ * Per-handler AppTask dispatch instrumentation.
+ *
+ * For each event handler, records how long its events waited in the AppTask
+ * event queue (PostEvent to dispatch) and how long the handler ran, as log2
+ * histograms in microseconds. Times come from the Weave monotonic hi-res clock,
+ * except the queue latency of events posted from interrupt context, which is
+ * measured in FreeRTOS ticks.
+ *
+ * Recording is done by the AppTask only, with interrupts masked only for the
+ * counter updates. The accessors may be called from any task.
+ */
+class AppTaskStats
+{
+public:
+    struct Histogram
+    {
+        uint32_t Buckets[APP_TASK_STATS_HISTOGRAM_BUCKETS];
+        uint32_t MaxUs;
+    };
+
+    struct HandlerStats
+    {
+        // NULL for the shared "other" entry.
+        AppTask::AppTaskEventHandler_t Handler;
+        uint32_t DispatchCount;
+        Histogram QueueLatency;
+        Histogram Runtime;
+    };
+
+    // Records a dispatched event. Called by the AppTask.
+    void RecordDispatch(AppTask::AppTaskEventHandler_t handler, uint32_t queueLatencyUs, uint32_t runtimeUs);
+
+    // Number of entries that can be read with GetHandlerStats().
+    uint8_t GetHandlerCount(void);
+
+    // Copies the stats of entry 'index'. Returns false if there is no such entry.
+    bool GetHandlerStats(uint8_t index, HandlerStats & stats);
+
+    // Clears all entries.
+    void Reset(void);
+
+    // Logs all entries.
+    void LogStats(void);
+
+    // Returns the bucket a value falls in.
+    static uint8_t GetBucket(uint32_t valueUs);
+
+private:
+    // The last entry is the shared "other" entry.
+    HandlerStats mHandlers[APP_TASK_STATS_MAX_HANDLERS + 1];
+    uint8_t mHandlerCount;
+
+    HandlerStats * FindOrAddHandler(AppTask::AppTaskEventHandler_t handler);
+    static void RecordValue(Histogram & histogram, uint8_t bucket, uint32_t valueUs);
+    static void LogHistogram(const char * name, const Histogram & histogram);
+
+    // Expose singleton object.
+    friend AppTaskStats & GetAppTaskStats(void);
+    static AppTaskStats sAppTaskStats;
+};
+
+// Exposes singleton object.
+inline AppTaskStats & GetAppTaskStats(void)
+{
+    return AppTaskStats::sAppTaskStats;
+}
+
+#endif // APP_TASK_STATS_H
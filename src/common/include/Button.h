@@ -74,7 +74,7 @@ public:
     typedef void (*ButtonEventHandler_t)(void);
 
     // Physical button actions are triggered by the hardware platform and dispatched
-    // to the static method "ButtonHwEventHandler" via the Application Task.
+    // to the static method "PhysicalButtonEventHandler" via the Application Task.
     enum PhysicalButtonAction
     {
         kPhysicalButtonAction_Press = 0, // Button has been pressed
@@ -83,8 +83,10 @@ public:
 
     struct PhysicalButtonAppTaskEventData
     {
-        PhysicalButtonAction Action;
         Button * ButtonPtr;
+        PhysicalButtonAction Action;
+        // FreeRTOS tick count at the GPIO edge, used to measure press-to-handler latency.
+        uint32_t EdgeTick;
     };
 
     // Initializes the Button.
@@ -106,6 +108,14 @@ public:
     // of button press logic.
     ButtonPressState UpdateButtonPressState(void);
 
+    // Number of milliseconds until the button press reaches its next long press
+    // threshold (and UpdateButtonPressState() must be called again), or
+    // APP_EVENT_LOOP_NO_DEADLINE if no threshold is pending.
+    uint32_t GetNextPressStateDeadlineMs(void);
+
+    // Largest time seen between a GPIO edge and PhysicalButtonEventHandler.
+    static uint32_t GetMaxEdgeLatencyMs(void);
+
 private:
     ButtonPressState mButtonPressState;
 
@@ -119,6 +129,8 @@ private:
     // The long press event handler.
     ButtonEventHandler_t mLongPressEventHandler;
 
+    static uint32_t sMaxEdgeLatencyMs;
+
     // Button press processing.
     void StartButtonPress(void);
     void EndButtonPress(void);
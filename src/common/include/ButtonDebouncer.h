@@ -0,0 +1,80 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#ifndef BUTTON_DEBOUNCER_H
+#define BUTTON_DEBOUNCER_H
+
+#include <stdint.h>
+
+#include <FreeRTOS.h>
+#include <timers.h>
+
+#include "Button.h"
+
+// Maximum number of buttons handled by a ButtonDebouncer.
+#define BUTTON_DEBOUNCER_MAX_BUTTONS 4
+
+/**
+ * Leading-edge button debouncer, shared by the hardware platforms.
+ *
+ * The platform GPIO interrupt calls OnEdgeFromISR() with the sampled pin level.
+ * The first edge that changes the button state is posted straight to the AppTask
+ * from the ISR (timestamped with the tick count at the edge), then further edges
+ * are ignored for the lockout period. A press is therefore reported with no
+ * debounce delay at all.
+ *
+ * If edges were ignored during the lockout, the pin is sampled again once the
+ * lockout expires (from a FreeRTOS timer) and the final level is reported if it
+ * differs, so a bounce that ends in the other state is never lost.
+ */
+class ButtonDebouncer
+{
+public:
+    // Returns true if the button is currently pressed. Called from the timer task.
+    typedef bool (*ReadButtonFunct_t)(uint8_t buttonIndex);
+
+    int Init(Button * buttons, uint8_t buttonCount, uint32_t lockoutMs, ReadButtonFunct_t readButton);
+
+    // Must be called from the GPIO interrupt on every edge of button 'buttonIndex'.
+    void OnEdgeFromISR(uint8_t buttonIndex, bool pressed);
+
+private:
+    struct ButtonState
+    {
+        ButtonDebouncer * Debouncer;
+        uint8_t Index;
+        bool Pressed;              // Last state reported to the AppTask.
+        uint32_t LastReportedTick; // Tick count of the edge last reported.
+        uint32_t LastEdgeTick;     // Tick count of the last edge, reported or not.
+        TimerHandle_t SettleTimer;
+#if APP_USE_STATIC_ALLOCATION
+        StaticTimer_t SettleTimerStruct;
+#endif
+    };
+
+    ButtonState mStates[BUTTON_DEBOUNCER_MAX_BUTTONS];
+    Button * mButtons;
+    uint8_t mButtonCount;
+    TickType_t mLockoutTicks;
+    ReadButtonFunct_t mReadButton;
+
+    Button::PhysicalButtonAppTaskEventData MakeEventData(ButtonState & state);
+    static void SettleTimerCallback(TimerHandle_t timer);
+};
+
+#endif // BUTTON_DEBOUNCER_H
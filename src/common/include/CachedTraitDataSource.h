@@ -0,0 +1,86 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#ifndef CACHED_TRAIT_DATA_SOURCE_H
+#define CACHED_TRAIT_DATA_SOURCE_H
+
+#include <stdint.h>
+
+#include <Weave/DeviceLayer/WeaveDeviceLayer.h>
+#include <Weave/Profiles/data-management/TraitData.h>
+
+/** Defines the size of the buffer holding the pre-encoded leaves of a trait.
+ */
+#ifndef CACHED_TRAIT_DATA_SOURCE_BUFFER_SIZE
+#define CACHED_TRAIT_DATA_SOURCE_BUFFER_SIZE 160
+#endif
+
+/** Defines the largest number of leaves a cached trait may have.
+ */
+#ifndef CACHED_TRAIT_DATA_SOURCE_MAX_LEAVES
+#define CACHED_TRAIT_DATA_SOURCE_MAX_LEAVES 10
+#endif
+
+static_assert(CACHED_TRAIT_DATA_SOURCE_BUFFER_SIZE <= UINT8_MAX + 1, "Leaf offsets are 8-bit");
+
+/**
+ * Trait data source whose leaves are encoded once into a TLV cache.
+ *
+ * For traits whose data rarely changes: each leaf is encoded with an anonymous
+ * tag by EncodeLeaf() on the first GetLeafData() call, and copied from the cache
+ * (re-tagged) on the next ones, until InvalidateCache() is called. If the leaves
+ * do not fit, they are encoded directly until the next invalidation.
+ *
+ * All the schema handles following the root must be leaves. Owned by the Weave task.
+ */
+class CachedTraitDataSource : public ::nl::Weave::Profiles::DataManagement_Current::TraitDataSource
+{
+public:
+    void InvalidateCache(void);
+
+protected:
+    CachedTraitDataSource(const ::nl::Weave::Profiles::DataManagement_Current::TraitSchemaEngine * aEngine, uint8_t aLeafCount);
+
+    // Encodes a leaf from the data of the trait.
+    virtual WEAVE_ERROR EncodeLeaf(::nl::Weave::Profiles::DataManagement_Current::PropertyPathHandle aLeafHandle,
+                                   uint64_t aTagToWrite, ::nl::Weave::TLV::TLVWriter & aWriter) = 0;
+
+    WEAVE_ERROR GetLeafData(::nl::Weave::Profiles::DataManagement_Current::PropertyPathHandle aLeafHandle, uint64_t aTagToWrite,
+                            ::nl::Weave::TLV::TLVWriter & aWriter) override;
+
+private:
+    enum CacheState
+    {
+        kCacheState_Invalid = 0,
+        kCacheState_Valid,
+        kCacheState_Unusable, // Does not fit; encode directly until the next invalidation.
+    };
+
+    WEAVE_ERROR CopyCachedLeaf(::nl::Weave::Profiles::DataManagement_Current::PropertyPathHandle aLeafHandle,
+                               uint64_t aTagToWrite, ::nl::Weave::TLV::TLVWriter & aWriter);
+    WEAVE_ERROR BuildCache(void);
+
+    // Leaves encoded with anonymous tags. A leaf of length 0 is not written.
+    uint8_t mCache[CACHED_TRAIT_DATA_SOURCE_BUFFER_SIZE];
+    uint8_t mLeafOffsets[CACHED_TRAIT_DATA_SOURCE_MAX_LEAVES];
+    uint8_t mLeafLengths[CACHED_TRAIT_DATA_SOURCE_MAX_LEAVES];
+    uint8_t mLeafCount;
+    CacheState mCacheState;
+};
+
+#endif // CACHED_TRAIT_DATA_SOURCE_H
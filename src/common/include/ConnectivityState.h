@@ -21,6 +21,8 @@
 
 #include "LED.h"
 
+#include <Weave/DeviceLayer/WeaveDeviceLayer.h>
+
 /**
  * Shows the current connectivity state via LED.
  *
@@ -38,34 +40,80 @@
  *    or service connectivity.
  *  Fullly provisioned and connected: Solid On
  *    The device is fully provisioned and has full network and service connectivity.
+ *
+ * The state is recomputed on the Weave task on every Weave device event (and on
+ * Refresh()), so it never has to lock the Weave stack. The AppTask only gets an
+ * event, and the LED is only updated, when the state actually changes.
  */
 class ConnectivityState
 {
 public:
-    /** Sets the LED used to show the current Connectivity state. */
-    void SetLED(LED * aLEDPtr);
+    // Returns whether the subscriptions with the service are established.
+    // Called on the Weave task.
+    typedef bool (*ServiceSubscriptionStateFunct_t)(void);
+
+    /**
+     * Sets the LED used to show the current Connectivity state and starts tracking
+     * the state. There is one ConnectivityState per application.
+     */
+    void Init(LED * aLEDPtr, ServiceSubscriptionStateFunct_t areServiceSubscriptionsEstablished);
+
+    /**
+     * Recomputes the connectivity state. Must be called on the Weave task whenever
+     * something that is not signaled by a Weave device event changes (e.g. the
+     * state of the service subscriptions).
+     */
+    static void Refresh(void);
 
     /**
-     * Collects provisioning (connectivity and configuration) state from the Weave stack
-     * and updates the LED if that state has changed.
-     * This should be called at each cycle of the event loop of the application task.
+     * Enables/disables updates of the LED (e.g. while the LED is used for something
+     * else). State changes are still tracked; the LED shows the current state as
+     * soon as updates are enabled again.
      */
-    void Update(bool areServiceSubscriptionsEstablished);
+    void SetLEDUpdatesEnabled(bool enabled);
 
 private:
+    // Snapshot of the connectivity state, computed on the Weave task and posted
+    // to the AppTask when it changes.
+    struct Snapshot
+    {
+        // State of the device with respect to the Thread network.
+        bool isThreadProvisioned;
+        bool isThreadEnabled;
+        bool isThreadAttached;
+
+        bool hasBLEConnections;
+
+        bool isPairedToAccount;
+        bool isServiceSubscriptionEstablished;
+        bool hasServiceConnectivity;
+    };
+
+    enum
+    {
+        kPostRetryDelayMs = 100, // Delay before posting again a snapshot dropped by a full AppTask lane.
+    };
+
     // The LED that shows the provisioning state.
     LED * connectivityStateLEDPtr;
+    bool isLEDUpdateEnabled = true;
+
+    ServiceSubscriptionStateFunct_t areServiceSubscriptionsEstablishedFunct;
+
+    // Last snapshot successfully posted (Weave task only).
+    Snapshot publishedSnapshot;
+    bool hasPublishedSnapshot = false;
 
-    // State of the device with respect to the Thread network.
-    bool isThreadProvisioned = false;
-    bool isThreadEnabled     = false;
-    bool isThreadAttached    = false;
+    // Current snapshot (AppTask only).
+    Snapshot currentSnapshot = {};
 
-    bool hasBLEConnections = false;
+    static ConnectivityState * sInstance;
 
-    bool isPairedToAccount                = false;
-    bool isServiceSubscriptionEstablished = false;
-    bool hasServiceConnectivity           = false;
+    void UpdateLED(void);
+    static void PlatformEventHandler(const ::nl::Weave::DeviceLayer::WeaveDeviceEvent * event, intptr_t arg);
+    static void RefreshWork(intptr_t arg);
+    static void HandleRetryTimer(::nl::Weave::System::Layer * systemLayer, void * appState, ::nl::Weave::System::Error error);
+    static void SnapshotEventHandler(void * data);
 };
 
 #endif // CONNECTIVITY_STATE_H
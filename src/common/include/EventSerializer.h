@@ -0,0 +1,227 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      Event logging through serializers written for one event structure.
+ *
+ *      nl::LogEvent() serializes an event by walking the field descriptors of
+ *      its schema, switching on the type of each field at runtime. An event
+ *      logged with LogEventDirect() is serialized instead by the overload of
+ *
+ *        WEAVE_ERROR SerializeEvent(TLVWriter & writer, uint64_t tag, const FooEvent & event);
+ *
+ *      declared next to the schema of FooEvent, which writes each field with
+ *      its known tag and type. The field descriptors remain the source of
+ *      truth: SerializeEvent() must produce the same TLV, which
+ *      EVENT_SERIALIZER_SELF_CHECK verifies on every event logged. Their tags
+ *      and nullable indices are copied by hand, as the descriptor tables are
+ *      not constant expressions, so the check is on in posix builds, and in
+ *      device builds made with EVENT_SELF_CHECK=1.
+ */
+
+#ifndef EVENT_SERIALIZER_H
+#define EVENT_SERIALIZER_H
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <Weave/DeviceLayer/WeaveDeviceLayer.h>
+#include <Weave/Profiles/data-management/DataManagement.h>
+#include <Weave/Support/SerializationUtils.h>
+
+#include "GenericWDMFeature.h"
+#include "PersistedEventLog.h"
+
+// Set to 1 to also serialize each event with its field descriptors, and log an
+// error if the two encodings differ.
+#ifndef EVENT_SERIALIZER_SELF_CHECK
+#define EVENT_SERIALIZER_SELF_CHECK 0
+#endif
+
+// Set to 1 to log the serialization cost of the events of the device at startup.
+#ifndef EVENT_SERIALIZER_BENCHMARK
+#define EVENT_SERIALIZER_BENCHMARK 0
+#endif
+
+// Large enough for any event of the example devices.
+#define EVENT_SERIALIZER_SCRATCH_SIZE 96
+
+namespace EventSerializerInternal {
+
+// Serializes event with its field descriptors (fromDescriptors) or with its
+// SerializeEvent() overload, as the only member of an anonymous structure.
+template <typename EventT>
+WEAVE_ERROR SerializeToScratch(const EventT & event, bool fromDescriptors, uint8_t * buf, uint32_t bufSize, uint32_t & outLen)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    ::nl::Weave::TLV::TLVWriter writer;
+    ::nl::Weave::TLV::TLVType container;
+    ::nl::StructureSchemaPointerPair pair;
+
+    writer.Init(buf, bufSize);
+
+    // Context tags are only valid inside a structure.
+    err = writer.StartContainer(::nl::Weave::TLV::AnonymousTag, ::nl::Weave::TLV::kTLVType_Structure, container);
+    SuccessOrExit(err);
+
+    if (fromDescriptors)
+    {
+        pair.mStructureData = const_cast<EventT *>(&event);
+        pair.mFieldSchema   = &EventT::FieldSchema;
+        err                 = ::nl::SerializedDataToTLVWriterHelper(writer, ::nl::Weave::Profiles::DataManagement::kTag_EventData,
+                                                    &pair);
+    }
+    else
+    {
+        err = SerializeEvent(writer, ::nl::Weave::TLV::ContextTag(::nl::Weave::Profiles::DataManagement::kTag_EventData), event);
+    }
+    SuccessOrExit(err);
+
+    err = writer.EndContainer(container);
+    SuccessOrExit(err);
+
+    err = writer.Finalize();
+    SuccessOrExit(err);
+
+    outLen = writer.GetLengthWritten();
+
+exit:
+    return err;
+}
+
+#if EVENT_SERIALIZER_SELF_CHECK
+template <typename EventT>
+void CheckSerializer(const EventT & event)
+{
+    uint8_t expected[EVENT_SERIALIZER_SCRATCH_SIZE];
+    uint8_t actual[EVENT_SERIALIZER_SCRATCH_SIZE];
+    uint32_t expectedLen = 0;
+    uint32_t actualLen   = 0;
+    WEAVE_ERROR err;
+
+    err = SerializeToScratch(event, true, expected, sizeof(expected), expectedLen);
+    SuccessOrExit(err);
+
+    err = SerializeToScratch(event, false, actual, sizeof(actual), actualLen);
+    SuccessOrExit(err);
+
+    if (expectedLen != actualLen || memcmp(expected, actual, actualLen) != 0)
+    {
+        WeaveLogError(Support, "Serializer of event 0x%08" PRIX32 ":%" PRIu32 " does not match its field descriptors",
+                      (uint32_t) EventT::Schema.mProfileId, (uint32_t) EventT::Schema.mStructureType);
+    }
+
+exit:
+    if (err != WEAVE_NO_ERROR)
+    {
+        WeaveLogError(Support, "Event serializer self-check failed: %s", ::nl::ErrorStr(err));
+    }
+}
+#endif // EVENT_SERIALIZER_SELF_CHECK
+
+// Application data of WriteEvent().
+template <typename EventT>
+struct WriteEventContext
+{
+    const EventT * Event;
+    uint32_t DataLength; // Set by WriteEvent().
+};
+
+// EventWriterFunct of LogEventDirect().
+template <typename EventT>
+WEAVE_ERROR WriteEvent(::nl::Weave::TLV::TLVWriter & writer, uint8_t dataTag, void * appData)
+{
+    WriteEventContext<EventT> & context = *static_cast<WriteEventContext<EventT> *>(appData);
+    uint32_t startLen                   = writer.GetLengthWritten();
+    WEAVE_ERROR err;
+
+#if EVENT_SERIALIZER_SELF_CHECK
+    CheckSerializer(*context.Event);
+#endif
+
+    err                = SerializeEvent(writer, ::nl::Weave::TLV::ContextTag(dataTag), *context.Event);
+    context.DataLength = writer.GetLengthWritten() - startLen;
+
+    return err;
+}
+
+} // namespace EventSerializerInternal
+
+// Same as nl::LogEvent(&event, options), through the SerializeEvent() overload
+// of EventT. The offload is scheduled by the importance of the event (see
+// WDMFeatureBase::OnEventLogged()), so options.urgent is ignored. Important
+// events are also persisted (see PersistedEventLog.h).
+template <typename EventT>
+::nl::Weave::Profiles::DataManagement::event_id_t LogEventDirect(const EventT & event,
+                                                                 ::nl::Weave::Profiles::DataManagement::EventOptions & options)
+{
+    EventSerializerInternal::WriteEventContext<EventT> context = { &event, 0 };
+    ::nl::Weave::Profiles::DataManagement::event_id_t eventId;
+
+    options.urgent = false;
+    eventId = ::nl::Weave::Profiles::DataManagement::LogEvent(EventT::Schema, EventSerializerInternal::WriteEvent<EventT>, &context,
+                                                              &options);
+    if (eventId != 0)
+    {
+        WDMFeatureBase::GetBaseInstance().OnEventLogged(EventT::Schema.mImportance, context.DataLength);
+
+#if PERSISTED_EVENT_LOG_PAGE_COUNT
+        PersistedEventLog::GetInstance().Append(event, eventId);
+#endif
+    }
+
+    return eventId;
+}
+
+#if EVENT_SERIALIZER_BENCHMARK
+// Logs the cost of serializing event with its field descriptors and with its
+// SerializeEvent() overload. The copy into the event log buffers that follows
+// is the same for both.
+template <typename EventT>
+void RunEventSerializerBenchmark(const EventT & event, const char * name)
+{
+    enum
+    {
+        kIterations = 1000
+    };
+    uint8_t buf[EVENT_SERIALIZER_SCRATCH_SIZE];
+    uint32_t len[2] = { 0, 0 };
+    uint64_t elapsedUs[2];
+
+    for (int direct = 0; direct < 2; direct++)
+    {
+        uint64_t startUs = ::nl::Weave::System::Platform::Layer::GetClock_MonotonicHiRes();
+
+        for (int iteration = 0; iteration < kIterations; iteration++)
+        {
+            EventSerializerInternal::SerializeToScratch(event, !direct, buf, sizeof(buf), len[direct]);
+        }
+
+        elapsedUs[direct] = ::nl::Weave::System::Platform::Layer::GetClock_MonotonicHiRes() - startUs;
+    }
+
+    WeaveLogProgress(Support, "%s serialize: %" PRIu32 " ns from descriptors, %" PRIu32 " ns direct (%" PRIu32 "/%" PRIu32
+                     " bytes, %d iterations)",
+                     name, (uint32_t)(elapsedUs[0] * 1000 / kIterations), (uint32_t)(elapsedUs[1] * 1000 / kIterations), len[0],
+                     len[1], kIterations);
+}
+#endif // EVENT_SERIALIZER_BENCHMARK
+
+#endif // EVENT_SERIALIZER_H
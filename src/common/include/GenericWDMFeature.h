@@ -0,0 +1,693 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      WDM feature shared by the example devices.
+ *
+ *      A device declares the traits it publishes and subscribes to as two type
+ *      lists, and gets a WDMFeature that owns one instance of each trait, sizes
+ *      the trait catalogs for them and manages the service subscriptions:
+ *
+ *        typedef GenericWDMFeature<TraitList<FooTraitDataSource, DeviceIdentityTraitDataSource>,
+ *                                  TraitList<FooSettingsTraitDataSink>>
+ *            WDMFeature;
+ *
+ *      Traits are numbered in list order, starting at handle 0, and a
+ *      TraitArray<Trait, N> entry publishes N instances of Trait (e.g. one
+ *      BoltLockTrait per door of a multi-door controller).
+ */
+
+#ifndef GENERIC_WDM_FEATURE_H
+#define GENERIC_WDM_FEATURE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <Weave/DeviceLayer/WeaveDeviceLayer.h>
+#include <Weave/Profiles/data-management/Current/DataManagement.h>
+
+#include "MultiResourceTraitCatalog.h"
+#include "PublisherLock.h"
+#include "ResubscribePolicy.h"
+#include "RttEstimator.h"
+#include "SeqLock.h"
+
+/** Defines how long an intermediate trait state (e.g. "locking") may be held back
+ *  before being notified, so that it can be sent together with a following change.
+ *  Final states are always notified right away. 0 disables holding.
+ */
+#ifndef WDM_NOTIFY_AGGREGATION_WINDOW_MS
+#define WDM_NOTIFY_AGGREGATION_WINDOW_MS 300
+#endif
+
+/** Defines how many bytes of event data below ProductionCritical importance are
+ *  held before being offloaded. ProductionCritical events are offloaded right away.
+ */
+#ifndef WDM_EVENT_OFFLOAD_BATCH_BYTES
+#define WDM_EVENT_OFFLOAD_BATCH_BYTES 256
+#endif
+
+/** Defines how long events below ProductionCritical importance may be held when
+ *  no other notify carries them first.
+ */
+#ifndef WDM_EVENT_OFFLOAD_MAX_HOLD_MS
+#define WDM_EVENT_OFFLOAD_MAX_HOLD_MS (5 * 60 * 1000)
+#endif
+
+/** Defines how many local subscriptions a device accepts at once after
+ *  AcceptLocalSubscribers(), e.g. phones and peer devices of its network. Each
+ *  also needs a handler of the subscription engine
+ *  (WDM_PUBLISHER_MAX_NUM_SUBSCRIPTION_HANDLERS) and a binding.
+ */
+#ifndef WDM_MAX_LOCAL_SUBSCRIBERS
+#define WDM_MAX_LOCAL_SUBSCRIBERS 1
+#endif
+
+// -----------------------------------------------------------------------------
+// Trait lists
+
+template <typename... Traits>
+struct TraitList
+{
+};
+
+// Count instances of Trait, published at consecutive handles with instance ids
+// 0 to Count - 1. A plain trait in a list is a single instance with id 0.
+template <typename Trait, size_t Count>
+struct TraitArray
+{
+};
+
+// Number of instances of a list entry.
+template <typename Entry>
+struct TraitCount
+{
+    static constexpr size_t value = 1;
+};
+
+template <typename Trait, size_t Count>
+struct TraitCount<TraitArray<Trait, Count>>
+{
+    static_assert(Count > 0, "TraitArray must hold at least one instance");
+    static constexpr size_t value = Count;
+};
+
+// Number of instances of all the entries of a list.
+template <typename... Entries>
+struct TraitTotalCount;
+
+template <>
+struct TraitTotalCount<>
+{
+    static constexpr size_t value = 0;
+};
+
+template <typename Entry, typename... Entries>
+struct TraitTotalCount<Entry, Entries...>
+{
+    static constexpr size_t value = TraitCount<Entry>::value + TraitTotalCount<Entries...>::value;
+};
+
+// Trait data handle of the first instance of Entry in Entries.
+template <typename Entry, typename... Entries>
+struct TraitIndex;
+
+template <typename Entry, typename... Entries>
+struct TraitIndex<Entry, Entry, Entries...>
+{
+    static constexpr uint16_t value = 0;
+};
+
+template <typename Entry, typename Other, typename... Entries>
+struct TraitIndex<Entry, Other, Entries...>
+{
+    static constexpr uint16_t value = TraitCount<Other>::value + TraitIndex<Entry, Entries...>::value;
+};
+
+// Holds the instances of one list entry of a GenericWDMFeature.
+template <typename Entry>
+struct WDMTraitInstance
+{
+    typedef Entry Trait;
+    Trait mTraits[1];
+};
+
+template <typename T, size_t Count>
+struct WDMTraitInstance<TraitArray<T, Count>>
+{
+    typedef T Trait;
+    Trait mTraits[Count];
+};
+
+// Trait data handles 0 to sizeof...(Handles) - 1, for the expansion of a
+// catalog store.
+template <size_t... Handles>
+struct TraitHandleSequence
+{
+};
+
+template <size_t Count, size_t... Handles>
+struct MakeTraitHandleSequence : MakeTraitHandleSequence<Count - 1, Count - 1, Handles...>
+{
+};
+
+template <size_t... Handles>
+struct MakeTraitHandleSequence<0, Handles...>
+{
+    typedef TraitHandleSequence<Handles...> Type;
+};
+
+// Catalog item of the instance at a handle of the list Entries, whose
+// instances are held by feature.
+template <typename Catalog, typename... Entries>
+struct WDMCatalogItemAt;
+
+template <typename Catalog>
+struct WDMCatalogItemAt<Catalog>
+{
+    template <typename Feature>
+    static constexpr typename Catalog::CatalogItem Get(Feature & feature, size_t handle)
+    {
+        return Catalog::MakeItem(NULL, 0);
+    }
+};
+
+template <typename Catalog, typename Entry, typename... Entries>
+struct WDMCatalogItemAt<Catalog, Entry, Entries...>
+{
+    template <typename Feature>
+    static constexpr typename Catalog::CatalogItem Get(Feature & feature, size_t handle)
+    {
+        return (handle < TraitCount<Entry>::value)
+            ? Catalog::MakeItem(&static_cast<WDMTraitInstance<Entry> &>(feature).mTraits[handle], handle)
+            : WDMCatalogItemAt<Catalog, Entries...>::Get(feature, handle - TraitCount<Entry>::value);
+    }
+};
+
+// Catalog store of the instances of the list Entries: an item per handle, and
+// an array per entry.
+template <typename Catalog, typename HandleSequence, typename... Entries>
+struct WDMCatalogStore;
+
+template <typename Catalog, size_t... Handles, typename... Entries>
+struct WDMCatalogStore<Catalog, TraitHandleSequence<Handles...>, Entries...>
+{
+    typename Catalog::CatalogItem mItems[sizeof...(Handles)];
+    typename Catalog::ItemArray mArrays[sizeof...(Entries)];
+
+    template <typename Entry>
+    static constexpr uint16_t FirstHandle(void)
+    {
+        return TraitIndex<Entry, Entries...>::value;
+    }
+
+    template <typename Feature>
+    static constexpr WDMCatalogStore Make(Feature & feature)
+    {
+        return { { WDMCatalogItemAt<Catalog, Entries...>::Get(feature, Handles)... },
+                 { Catalog::MakeArray(static_cast<WDMTraitInstance<Entries> &>(feature).mTraits, TraitCount<Entries>::value,
+                                      FirstHandle<Entries>())... } };
+    }
+};
+
+// Calls trait.OnPlatformEvent(event) for the traits that have one.
+template <typename Trait>
+inline auto ForwardPlatformEvent(Trait & trait, const ::nl::Weave::DeviceLayer::WeaveDeviceEvent * event, int)
+    -> decltype(trait.OnPlatformEvent(event), void())
+{
+    trait.OnPlatformEvent(event);
+}
+
+template <typename Trait>
+inline void ForwardPlatformEvent(Trait & trait, const ::nl::Weave::DeviceLayer::WeaveDeviceEvent * event, long)
+{
+}
+
+// Calls trait.Init() for the traits that have one.
+template <typename Trait>
+inline auto InitTrait(Trait & trait, int) -> decltype(trait.Init())
+{
+    return trait.Init();
+}
+
+template <typename Trait>
+inline WEAVE_ERROR InitTrait(Trait & trait, long)
+{
+    return WEAVE_NO_ERROR;
+}
+
+// -----------------------------------------------------------------------------
+// WDMFeatureBase
+
+/**
+ * Subscription management, independent of the traits of the device.
+ *
+ * Publishes the source catalog to the service, subscribes to the sink catalog
+ * and accepts the service counter-subscription. There is a single instance,
+ * the GenericWDMFeature of the application.
+ */
+class WDMFeatureBase
+{
+    typedef ::nl::Weave::Profiles::DataManagement_Current::SubscriptionClient SubscriptionClient;
+    typedef ::nl::Weave::Profiles::DataManagement_Current::SubscriptionEngine SubscriptionEngine;
+    typedef ::nl::Weave::Profiles::DataManagement_Current::SubscriptionHandler SubscriptionHandler;
+    typedef ::nl::Weave::Profiles::DataManagement_Current::TraitDataSink TraitDataSink;
+    typedef ::nl::Weave::Profiles::DataManagement_Current::TraitDataSource TraitDataSource;
+    typedef ::nl::Weave::Profiles::DataManagement_Current::TraitPath TraitPath;
+
+public:
+    typedef MultiResourceTraitCatalog<TraitDataSource> SourceTraitCatalog;
+    typedef MultiResourceTraitCatalog<TraitDataSink> SinkTraitCatalog;
+
+    enum TraitChangeType
+    {
+        kTraitChange_Final = 0,   // Notified right away.
+        kTraitChange_Intermediate // May be held for WDM_NOTIFY_AGGREGATION_WINDOW_MS.
+    };
+
+    // Counters for the aggregation of ProcessTraitChanges() requests.
+    struct AggregationStats
+    {
+        uint32_t RequestCount;       // Calls to ProcessTraitChanges().
+        uint32_t CoalescedRunCount;  // Requests merged into an already scheduled run.
+        uint32_t HeldCount;          // Intermediate states held back.
+        uint32_t NotifiesSavedCount; // Held states merged with a later change.
+    };
+
+    // Recoveries of the service subscription after it was lost.
+    struct ResubscribeStats
+    {
+        uint32_t ResubscribeCount;        // Subscriptions re-established.
+        uint32_t AttemptCount;            // Attempts of all the recoveries.
+        uint32_t LastAttemptCount;        // Attempts of the last recovery.
+        uint32_t LastTimeToResubscribeMs; // From the loss of the subscription to its re-establishment.
+        uint32_t MaxTimeToResubscribeMs;
+    };
+
+    // Time for both service subscriptions (outbound and counter-subscription)
+    // to be established.
+    struct ConnectStats
+    {
+        uint32_t BootToConnectedMs;          // 0 until first connected.
+        uint32_t ReattachCount;              // Service connectivity restorations followed by a connection.
+        uint32_t LastReattachToConnectedMs;
+        uint32_t MaxReattachToConnectedMs;
+    };
+
+    // Event importances, from ProductionCritical to Debug.
+    enum
+    {
+        kEventImportanceCount = ::nl::Weave::Profiles::DataManagement::Debug -
+            ::nl::Weave::Profiles::DataManagement::ProductionCritical + 1
+    };
+
+    // Counters of the events offloaded, indexed by importance - ProductionCritical.
+    // An offload is the confirmation by the service of the notifies that carried
+    // the events of that importance pending, however many they took.
+    struct EventOffloadStats
+    {
+        uint32_t LoggedCount[kEventImportanceCount];
+        uint32_t OffloadCount[kEventImportanceCount];
+        uint32_t OffloadedEventCount[kEventImportanceCount];
+        uint64_t TotalAgeMs[kEventImportanceCount]; // From logging to confirmation, for all the offloaded events.
+        uint32_t MaxAgeMs[kEventImportanceCount];
+    };
+
+    WEAVE_ERROR Init(void);
+    void ProcessTraitChanges(TraitChangeType type = kTraitChange_Final);
+
+    // Schedules the offload of an event of dataLen bytes just logged. May be
+    // called from any task; LogEventDirect() calls it for every event.
+    void OnEventLogged(::nl::Weave::Profiles::DataManagement::ImportanceType importance, uint32_t dataLen);
+    void TearDownSubscriptions(void);
+
+    void GetAggregationStats(AggregationStats & stats);
+    void GetEventOffloadStats(EventOffloadStats & stats);
+
+    // Round-trip times to the service and the resulting WRMP retransmission
+    // timeout. May be called from any task.
+    void GetServiceRttStats(RttEstimator::Stats & stats) { mServiceRtt.GetStats(stats); }
+
+    // Replaces the default decorrelated jitter backoff of the service
+    // subscription. Must be called on the Weave task, or before Init().
+    void SetResubscribePolicy(ResubscribePolicy & policy) { mResubscribePolicy = &policy; }
+
+    // May be called from any task.
+    void GetResubscribeStats(ResubscribeStats & stats) { mPublishedResubscribeStats.Read(stats); }
+    void GetConnectStats(ConnectStats & stats) { mPublishedConnectStats.Read(stats); }
+
+    // Accepts the subscription of one device of the local network (e.g. the lock
+    // associated with this sensor) to the source trait instance at handle, in
+    // addition to the service counter-subscription. The device is the last one
+    // to subscribe while this device is in user selected mode, and is remembered
+    // across reboots. Requests from other nodes, for other paths, or for a second
+    // subscription are refused. Must be called before Init().
+    void AcceptLocalSubscription(uint16_t handle)
+    {
+        mLocalSubPolicy      = kLocalSubPolicy_AssociatedPeer;
+        mLocalSubTraitHandle = handle;
+    }
+
+    // Accepts the subscriptions of up to WDM_MAX_LOCAL_SUBSCRIBERS devices of the
+    // local network (e.g. phones) to any source trait instance, in addition to
+    // the service counter-subscription. Requests beyond that limit are refused.
+    // Must be called before Init().
+    void AcceptLocalSubscribers(void) { mLocalSubPolicy = kLocalSubPolicy_AnyPeer; }
+
+    // The single instance, for code that does not know the traits of the device.
+    static WDMFeatureBase & GetBaseInstance(void) { return *sInstance; }
+
+    bool AreServiceSubscriptionsEstablished(void);
+
+    nl::Weave::Profiles::DataManagement::SubscriptionEngine mSubscriptionEngine;
+
+protected:
+    WDMFeatureBase(const SourceTraitCatalog::CatalogItem * sourceItems, uint32_t sourceCount,
+                   const SourceTraitCatalog::ItemArray * sourceArrays, uint32_t sourceArrayCount,
+                   const SinkTraitCatalog::CatalogItem * sinkItems, uint32_t sinkCount,
+                   const SinkTraitCatalog::ItemArray * sinkArrays, uint32_t sinkArrayCount, TraitPath * sinkTraitPaths);
+
+    // Initializes the trait instances, e.g. restores persisted sink data, before
+    // the first subscription. Called once by Init().
+    virtual WEAVE_ERROR InitTraits(void) = 0;
+
+    // Passes a device event to the trait instances. Called on the Weave task.
+    virtual void OnPlatformEvent(const ::nl::Weave::DeviceLayer::WeaveDeviceEvent * event) = 0;
+
+private:
+    // SubscriptionEngine::GetInstance() returns the engine of sInstance.
+    friend class ::nl::Weave::Profiles::DataManagement_Current::SubscriptionEngine;
+
+    void InitiateSubscriptionToService(void);
+    static void AsyncProcessChanges(intptr_t arg);
+    static void HandleHoldTimerExpired(::nl::Weave::System::Layer * systemLayer, void * appState,
+                                       ::nl::Weave::System::Error error);
+    static void HandleEventHoldTimerExpired(::nl::Weave::System::Layer * systemLayer, void * appState,
+                                            ::nl::Weave::System::Error error);
+    bool ScheduleChanges(uint8_t changes);
+    void RunNotificationEngine(void);
+    void AccountEventOffload(void);
+    void LogStats(void);
+
+    void StartServiceRttSample(::nl::Weave::ExchangeContext * ec);
+    void ApplyServiceRetransTimeout(void);
+    static void HandleServiceAckRcvd(::nl::Weave::ExchangeContext * ec, void * msgCtxt);
+
+    bool AcceptLocalSubscribeRequest(SubscriptionHandler * handler, const ::nl::Weave::WeaveMessageInfo * msgInfo);
+
+    void OnServiceNotifyStart(::nl::Weave::ExchangeContext * ec);
+    static void HandleServiceNotifyResponse(::nl::Weave::ExchangeContext * ec, const ::nl::Inet::IPPacketInfo * pktInfo,
+                                            const ::nl::Weave::WeaveMessageInfo * msgInfo, uint32_t profileId, uint8_t msgType,
+                                            ::nl::Weave::System::PacketBuffer * payload);
+
+    void OnServiceSubscriptionLost(void);
+    void OnServiceSubscriptionEstablished(void);
+    void PrepareServiceBinding(void);
+    void UpdateConnectStats(void);
+    static void HandleResubscribePolicy(void * const appState, SubscriptionClient::ResubscribeParam & inParam,
+                                        uint32_t & outIntervalMsec);
+
+    static void PlatformEventHandler(const ::nl::Weave::DeviceLayer::WeaveDeviceEvent * event, intptr_t arg);
+    static void HandleSubscriptionEngineEvent(void * appState, SubscriptionEngine::EventID eventType,
+                                              const SubscriptionEngine::InEventParam & inParam,
+                                              SubscriptionEngine::OutEventParam & outParam);
+    static void HandleServiceBindingEvent(void * appState, ::nl::Weave::Binding::EventType eventType,
+                                          const ::nl::Weave::Binding::InEventParam & inParam,
+                                          ::nl::Weave::Binding::OutEventParam & outParam);
+    static void HandleOutboundServiceSubscriptionEvent(void * appState, SubscriptionClient::EventID eventType,
+                                                       const SubscriptionClient::InEventParam & inParam,
+                                                       SubscriptionClient::OutEventParam & outParam);
+    static void HandleInboundSubscriptionEvent(void * aAppState, SubscriptionHandler::EventID eventType,
+                                               const SubscriptionHandler::InEventParam & inParam,
+                                               SubscriptionHandler::OutEventParam & outParam);
+
+    // Sink Catalog
+    SinkTraitCatalog mServiceSinkTraitCatalog;
+
+    // Source Catalog
+    SourceTraitCatalog mServiceSourceTraitCatalog;
+
+    // One root path per sink, subscribed to as a whole.
+    TraitPath * mServiceSinkTraitPaths;
+    uint32_t mServiceSinkTraitPathCount;
+
+    // Subscription Clients
+    nl::Weave::Profiles::DataManagement::SubscriptionClient * mServiceSubClient;
+
+    // Subscription Handler
+    nl::Weave::Profiles::DataManagement::SubscriptionHandler * mServiceCounterSubHandler;
+
+    // Notify of the counter-subscription awaiting its response (NULL if none),
+    // and the message handler the subscription handler set on its exchange.
+    nl::Weave::ExchangeContext * mServiceNotifyExchange;
+    nl::Weave::ExchangeContext::MessageReceiveFunct mServiceNotifyResponseHandler;
+
+    // Binding
+    nl::Weave::Binding * mServiceSubBinding;
+
+    // WRMP configuration of the service bindings, with the retransmission
+    // timeout of mServiceRtt.
+    nl::Weave::WRMPConfig mServiceWRMPConfig;
+    RttEstimator mServiceRtt;
+    // Exchange whose first message is being timed (NULL if none).
+    nl::Weave::ExchangeContext * mRttSampleExchange;
+    uint64_t mRttSampleStartMs;
+    uint32_t mRttSampleTimeoutMs;
+
+    DecorrelatedJitterResubscribePolicy mDefaultResubscribePolicy;
+    ResubscribePolicy * mResubscribePolicy;
+    // Owned by the Weave task, published for the other tasks.
+    ResubscribeStats mResubscribeStats;
+    SeqLock<ResubscribeStats> mPublishedResubscribeStats;
+    // Monotonic time at which the subscription was lost (0 while established).
+    uint64_t mSubToServiceLostTimeMs;
+    // Monotonic time of the next resubscribe attempt set by the policy (0 if none).
+    uint64_t mNextResubscribeTimeMs;
+    uint32_t mResubscribeAttemptCount;
+    bool mHadServiceConnectivity;
+
+    ConnectStats mConnectStats;
+    SeqLock<ConnectStats> mPublishedConnectStats;
+    // Monotonic time at which service connectivity was restored (0 if not pending).
+    uint64_t mReattachTimeMs;
+
+    enum
+    {
+        kNoLocalSubscription = 0xFFFF
+    };
+
+    enum LocalSubPolicy
+    {
+        kLocalSubPolicy_None,           // Only the service counter-subscription is accepted.
+        kLocalSubPolicy_AssociatedPeer, // See AcceptLocalSubscription().
+        kLocalSubPolicy_AnyPeer,        // See AcceptLocalSubscribers().
+    };
+
+    // Source trait instance open to the associated peer (kNoLocalSubscription if
+    // none), node allowed to subscribe to it (kNodeIdNotSpecified until
+    // associated) and handlers of the local subscriptions (NULL if free). The
+    // associated peer only uses the first handler. Owned by the Weave task.
+    LocalSubPolicy mLocalSubPolicy;
+    uint16_t mLocalSubTraitHandle;
+    uint64_t mLocalPeerNodeId;
+    SubscriptionHandler * mLocalSubHandlers[WDM_MAX_LOCAL_SUBSCRIBERS];
+
+    static WDMFeatureBase * sInstance;
+    PublisherLock mPublisherLock;
+
+    // kPendingChange_* bits, set by ProcessTraitChanges() and cleared by AsyncProcessChanges().
+    uint8_t mPendingChanges;
+    // Owned by the Weave task.
+    bool mIsHoldTimerArmed;
+    AggregationStats mAggregationStats;
+
+    // Events logged since the last offload, per importance. Guarded by a
+    // critical section, as events are logged from any task.
+    struct PendingEvents
+    {
+        uint32_t Count;
+        uint32_t Bytes;
+        uint64_t FirstLoggedMs;
+        uint64_t LoggedMsSum; // For the total age at offload.
+    };
+    PendingEvents mPendingEvents[kEventImportanceCount];
+    EventOffloadStats mEventOffloadStats;
+    // Start time of mServiceNotifyExchange and the events pending then, which
+    // it carries (the oldest of them, if they do not all fit). Owned by the Weave task.
+    uint64_t mServiceNotifyStartMs;
+    PendingEvents mServiceNotifyEvents[kEventImportanceCount];
+    bool mServiceNotifyHasEvents;
+    // Owned by the Weave task.
+    bool mIsEventHoldTimerArmed;
+
+    bool mIsSubToServiceEstablished;
+    bool mIsServiceCounterSubEstablished;
+    bool mIsSubToServiceActivated;
+};
+
+// -----------------------------------------------------------------------------
+// GenericWDMFeature
+
+// Sink paths of a GenericWDMFeature. Constructed before WDMFeatureBase, which
+// hands them to the service subscription.
+template <size_t SinkCount>
+struct WDMSinkTraitPathStorage
+{
+    ::nl::Weave::Profiles::DataManagement_Current::TraitPath mSinkTraitPaths[SinkCount];
+};
+
+template <typename SourceList, typename SinkList>
+class GenericWDMFeature;
+
+/**
+ * WDM feature of a device publishing the trait data sources Sources and
+ * subscribing to the trait data sinks Sinks. An entry of either list is a
+ * trait class, or a TraitArray of a trait class for several instances.
+ *
+ * The sink paths and the trait instances are members sized at compile time.
+ * The catalog stores are generated from the lists by constexpr expansions, with
+ * each entry at its handle, and are constant-initialized: adding a trait to a
+ * device only takes adding it to a list, and costs no catalog setup at startup.
+ */
+template <typename... Sources, typename... Sinks>
+class GenericWDMFeature<TraitList<Sources...>, TraitList<Sinks...>>
+    : private WDMSinkTraitPathStorage<TraitTotalCount<Sinks...>::value>,
+      private WDMTraitInstance<Sources>...,
+      private WDMTraitInstance<Sinks>...,
+      public WDMFeatureBase
+{
+    static_assert(sizeof...(Sources) > 0 && sizeof...(Sinks) > 0, "GenericWDMFeature needs at least one source and one sink");
+
+    typedef WDMSinkTraitPathStorage<TraitTotalCount<Sinks...>::value> Storage;
+    typedef WDMCatalogStore<SourceTraitCatalog, typename MakeTraitHandleSequence<TraitTotalCount<Sources...>::value>::Type,
+                            Sources...>
+        SourceCatalogStore;
+    typedef WDMCatalogStore<SinkTraitCatalog, typename MakeTraitHandleSequence<TraitTotalCount<Sinks...>::value>::Type,
+                            Sinks...>
+        SinkCatalogStore;
+
+    // The stores reach the trait instances through the private bases.
+    template <typename, typename...>
+    friend struct WDMCatalogItemAt;
+    template <typename, typename, typename...>
+    friend struct WDMCatalogStore;
+
+public:
+    static GenericWDMFeature & GetInstance(void) { return sWDMFeature; }
+
+    // Instance index of list entry Source (0 unless Source is a TraitArray).
+    template <typename Source>
+    typename WDMTraitInstance<Source>::Trait & GetSource(size_t index = 0)
+    {
+        return static_cast<WDMTraitInstance<Source> &>(*this).mTraits[index];
+    }
+
+    template <typename Sink>
+    typename WDMTraitInstance<Sink>::Trait & GetSink(size_t index = 0)
+    {
+        return static_cast<WDMTraitInstance<Sink> &>(*this).mTraits[index];
+    }
+
+    // Trait data handles of the first instance of an entry.
+    template <typename Source>
+    static constexpr uint16_t SourceHandle(void)
+    {
+        return TraitIndex<Source, Sources...>::value;
+    }
+
+    template <typename Sink>
+    static constexpr uint16_t SinkHandle(void)
+    {
+        return TraitIndex<Sink, Sinks...>::value;
+    }
+
+private:
+    GenericWDMFeature(void) :
+        WDMFeatureBase(sSourceCatalogStore.mItems, TraitTotalCount<Sources...>::value, sSourceCatalogStore.mArrays,
+                       sizeof...(Sources), sSinkCatalogStore.mItems, TraitTotalCount<Sinks...>::value, sSinkCatalogStore.mArrays,
+                       sizeof...(Sinks), Storage::mSinkTraitPaths)
+    {
+        using ::nl::Weave::Profiles::DataManagement_Current::kRootPropertyPathHandle;
+
+        for (uint16_t handle = 0; handle < TraitTotalCount<Sinks...>::value; handle++)
+        {
+            Storage::mSinkTraitPaths[handle].mTraitDataHandle    = handle;
+            Storage::mSinkTraitPaths[handle].mPropertyPathHandle = kRootPropertyPathHandle;
+        }
+    }
+
+    template <typename Entry>
+    WEAVE_ERROR InitEntry(WEAVE_ERROR err)
+    {
+        for (size_t i = 0; i < TraitCount<Entry>::value && err == WEAVE_NO_ERROR; i++)
+        {
+            err = InitTrait(static_cast<WDMTraitInstance<Entry> &>(*this).mTraits[i], 0);
+        }
+
+        return err;
+    }
+
+    WEAVE_ERROR InitTraits(void) override
+    {
+        WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+        int expandSources[] = { (err = InitEntry<Sources>(err), 0)... };
+        int expandSinks[]   = { (err = InitEntry<Sinks>(err), 0)... };
+        (void) expandSources;
+        (void) expandSinks;
+
+        return err;
+    }
+
+    template <typename Entry>
+    void ForwardPlatformEventToEntry(const ::nl::Weave::DeviceLayer::WeaveDeviceEvent * event)
+    {
+        for (size_t i = 0; i < TraitCount<Entry>::value; i++)
+        {
+            ForwardPlatformEvent(static_cast<WDMTraitInstance<Entry> &>(*this).mTraits[i], event, 0);
+        }
+    }
+
+    void OnPlatformEvent(const ::nl::Weave::DeviceLayer::WeaveDeviceEvent * event) override
+    {
+        int expandSources[] = { (ForwardPlatformEventToEntry<Sources>(event), 0)... };
+        int expandSinks[]   = { (ForwardPlatformEventToEntry<Sinks>(event), 0)... };
+        (void) expandSources;
+        (void) expandSinks;
+    }
+
+    static const SourceCatalogStore sSourceCatalogStore;
+    static const SinkCatalogStore sSinkCatalogStore;
+    static GenericWDMFeature sWDMFeature;
+};
+
+// Constant initializers: the stores only hold addresses within sWDMFeature.
+template <typename... Sources, typename... Sinks>
+const typename GenericWDMFeature<TraitList<Sources...>, TraitList<Sinks...>>::SourceCatalogStore
+    GenericWDMFeature<TraitList<Sources...>, TraitList<Sinks...>>::sSourceCatalogStore = SourceCatalogStore::Make(sWDMFeature);
+
+template <typename... Sources, typename... Sinks>
+const typename GenericWDMFeature<TraitList<Sources...>, TraitList<Sinks...>>::SinkCatalogStore
+    GenericWDMFeature<TraitList<Sources...>, TraitList<Sinks...>>::sSinkCatalogStore = SinkCatalogStore::Make(sWDMFeature);
+
+template <typename... Sources, typename... Sinks>
+GenericWDMFeature<TraitList<Sources...>, TraitList<Sinks...>>
+    GenericWDMFeature<TraitList<Sources...>, TraitList<Sinks...>>::sWDMFeature;
+
+#endif // GENERIC_WDM_FEATURE_H
@@ -20,6 +20,7 @@
 #define LED_H
 
 #include <stdint.h>
+#include "AppTask.h"
 #include "PlatformLED.h"
 
 /**
@@ -49,10 +50,11 @@ public:
     void Blink(uint32_t onTimeMS, uint32_t offTimeMS);
 
     /**
-     * Animates the LED. Must be called at regular intervals to properly handle
-     * blinking (either via a changeRate or on/off periods).
+     * Animates the LED. Must be called again no later than the returned number of
+     * milliseconds to properly handle blinking (either via a changeRate or on/off periods).
+     * Returns APP_EVENT_LOOP_NO_DEADLINE if the LED is not blinking.
      */
-    void Animate();
+    uint32_t Animate();
 
 private:
     // The delegate which implements platform-specific behavior.
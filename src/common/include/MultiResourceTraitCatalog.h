@@ -0,0 +1,348 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      Trait catalog holding any number of trait instances of any number of
+ *      resources, in a store of items filled by the owner.
+ *
+ *      Unlike SingleResourceTraitCatalog, every item carries its own resource
+ *      and instance ids, so a single node can publish e.g. one BoltLockTrait
+ *      instance per door it controls, or act as a bridge for other resources.
+ *
+ *      The trait data handle is the index of the item in the store, making
+ *      handle to instance lookups O(1). Instances are also described as arrays
+ *      (MakeArray()), which makes instance to handle lookups O(1) per array
+ *      rather than O(number of instances).
+ *
+ *      Items and arrays are literal types built by constexpr functions, so a
+ *      store whose trait instances have static storage (e.g. the catalogs of
+ *      GenericWDMFeature) is constant-initialized in read-only data, and the
+ *      catalog costs no setup at startup.
+ */
+
+#ifndef MULTI_RESOURCE_TRAIT_CATALOG_H
+#define MULTI_RESOURCE_TRAIT_CATALOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <Weave/DeviceLayer/WeaveDeviceLayer.h>
+#include <Weave/Profiles/data-management/Current/DataManagement.h>
+
+template <typename T>
+class MultiResourceTraitCatalog : public ::nl::Weave::Profiles::DataManagement_Current::TraitCatalogBase<T>
+{
+    typedef ::nl::Weave::Profiles::DataManagement_Current::TraitDataHandle TraitDataHandle;
+    typedef ::nl::Weave::Profiles::DataManagement_Current::ResourceIdentifier ResourceIdentifier;
+    typedef ::nl::Weave::Profiles::DataManagement_Current::SchemaVersionRange SchemaVersionRange;
+    typedef typename ::nl::Weave::Profiles::DataManagement_Current::TraitCatalogBase<T>::IteratorCallback IteratorCallback;
+
+public:
+    struct CatalogItem
+    {
+        T * mItem; // NULL if no instance has this handle.
+        const ResourceIdentifier * mResourceId;
+        uint64_t mInstanceId;
+    };
+
+    // Instances of an array of trait instances, at consecutive handles.
+    struct ItemArray
+    {
+        T * mFirst;     // First item.
+        size_t mStride; // Distance between two items.
+        uint32_t mCount;
+        TraitDataHandle mFirstHandle;
+    };
+
+    // Resource of the node itself.
+    static const ResourceIdentifier sSelfResourceId;
+
+    // Item of trait instance aItem, with instance id aInstanceId, of resource
+    // aResourceId (the node itself by default).
+    static constexpr CatalogItem MakeItem(T * aItem, uint64_t aInstanceId,
+                                          const ResourceIdentifier * aResourceId = &sSelfResourceId)
+    {
+        return { aItem, aResourceId, aInstanceId };
+    }
+
+    // The aCount trait instances of array aItems, at the handles starting at aFirstHandle.
+    template <typename U>
+    static constexpr ItemArray MakeArray(U * aItems, uint32_t aCount, TraitDataHandle aFirstHandle)
+    {
+        return { aItems, sizeof(U), aCount, aFirstHandle };
+    }
+
+    // The item at handle h is aCatalogStore[h]. Each instance of aCatalogStore
+    // must be in exactly one of the aArrayCount arrays of aArrays. Both stay
+    // owned by the caller.
+    MultiResourceTraitCatalog(const CatalogItem * aCatalogStore, uint32_t aCatalogSize, const ItemArray * aArrays,
+                              uint32_t aArrayCount) :
+        mCatalogStore(aCatalogStore), mCatalogSize(aCatalogSize), mArrays(aArrays), mArrayCount(aArrayCount)
+    {
+    }
+
+    // TraitCatalogBase
+    WEAVE_ERROR AddressToHandle(::nl::Weave::TLV::TLVReader & aReader, TraitDataHandle & aHandle,
+                                SchemaVersionRange & aSchemaVersionRange) const;
+    WEAVE_ERROR HandleToAddress(TraitDataHandle aHandle, ::nl::Weave::TLV::TLVWriter & aWriter,
+                                SchemaVersionRange & aSchemaVersionRange) const;
+    WEAVE_ERROR Locate(TraitDataHandle aHandle, T ** aTraitInstance) const;
+    WEAVE_ERROR Locate(T * aTraitInstance, TraitDataHandle & aHandle) const;
+    WEAVE_ERROR DispatchEvent(uint16_t aEvent, void * aContext) const;
+    WEAVE_ERROR Iterate(IteratorCallback aCallback, void * aContext);
+#if WEAVE_CONFIG_ENABLE_WDM_UPDATE
+    WEAVE_ERROR GetInstanceId(TraitDataHandle aHandle, uint64_t & aInstanceId) const;
+    WEAVE_ERROR GetResourceId(TraitDataHandle aHandle, ResourceIdentifier & aResourceId) const;
+#endif
+
+private:
+    bool IsValid(TraitDataHandle aHandle) const { return (aHandle < mCatalogSize && mCatalogStore[aHandle].mItem != NULL); }
+
+    const CatalogItem * mCatalogStore;
+    uint32_t mCatalogSize;
+    const ItemArray * mArrays;
+    uint32_t mArrayCount;
+};
+
+template <typename T>
+const ::nl::Weave::Profiles::DataManagement_Current::ResourceIdentifier MultiResourceTraitCatalog<T>::sSelfResourceId(
+    ::nl::Weave::Profiles::DataManagement_Current::ResourceIdentifier::SELF_NODE_ID);
+
+template <typename T>
+WEAVE_ERROR MultiResourceTraitCatalog<T>::AddressToHandle(::nl::Weave::TLV::TLVReader & aReader, TraitDataHandle & aHandle,
+                                                          SchemaVersionRange & aSchemaVersionRange) const
+{
+    using namespace ::nl::Weave::Profiles::DataManagement_Current;
+
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    Path::Parser path;
+    uint32_t profileId;
+    uint64_t instanceId;
+    ResourceIdentifier resourceId(ResourceIdentifier::SELF_NODE_ID);
+    ::nl::Weave::TLV::TLVReader reader;
+
+    err = path.Init(aReader);
+    SuccessOrExit(err);
+
+    err = path.GetProfileID(&profileId, &aSchemaVersionRange);
+    SuccessOrExit(err);
+
+    err = path.GetInstanceID(&instanceId);
+    if (err == WEAVE_END_OF_TLV || err == WEAVE_ERROR_TLV_TAG_NOT_FOUND)
+    {
+        instanceId = 0;
+        err        = WEAVE_NO_ERROR;
+    }
+    SuccessOrExit(err);
+
+    err = path.GetResourceID(&reader);
+    if (err == WEAVE_NO_ERROR)
+    {
+        err = resourceId.FromTLV(reader);
+    }
+    else if (err == WEAVE_END_OF_TLV || err == WEAVE_ERROR_TLV_TAG_NOT_FOUND)
+    {
+        err = WEAVE_NO_ERROR;
+    }
+    SuccessOrExit(err);
+
+    // Paths are only resolved when a subscription is set up, so a scan is fine here.
+    err = WEAVE_ERROR_INVALID_PROFILE_ID;
+    for (uint32_t handle = 0; handle < mCatalogSize; handle++)
+    {
+        const CatalogItem & item = mCatalogStore[handle];
+
+        if (item.mItem != NULL && item.mInstanceId == instanceId && *item.mResourceId == resourceId &&
+            item.mItem->GetSchemaEngine()->GetProfileId() == profileId)
+        {
+            aHandle = handle;
+            err     = WEAVE_NO_ERROR;
+            break;
+        }
+    }
+    SuccessOrExit(err);
+
+    // Leave the reader on the tags following the instance locator.
+    err = path.GetTags(&aReader);
+    if (err == WEAVE_END_OF_TLV)
+    {
+        err = WEAVE_NO_ERROR;
+    }
+
+exit:
+    return err;
+}
+
+template <typename T>
+WEAVE_ERROR MultiResourceTraitCatalog<T>::HandleToAddress(TraitDataHandle aHandle, ::nl::Weave::TLV::TLVWriter & aWriter,
+                                                          SchemaVersionRange & aSchemaVersionRange) const
+{
+    using namespace ::nl::Weave::Profiles::DataManagement_Current;
+    using namespace ::nl::Weave::TLV;
+
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    TLVType containerType;
+    TLVType profileContainerType;
+    uint32_t profileId;
+
+    VerifyOrExit(IsValid(aHandle), err = WEAVE_ERROR_INVALID_ARGUMENT);
+
+    profileId = mCatalogStore[aHandle].mItem->GetSchemaEngine()->GetProfileId();
+
+    err = aWriter.StartContainer(ContextTag(Path::kCsTag_InstanceLocator), kTLVType_Structure, containerType);
+    SuccessOrExit(err);
+
+    if (aSchemaVersionRange.mMinVersion != 1 || aSchemaVersionRange.mMaxVersion != 1)
+    {
+        err = aWriter.StartContainer(ContextTag(Path::kCsTag_TraitProfileID), kTLVType_Array, profileContainerType);
+        SuccessOrExit(err);
+
+        err = aWriter.Put(AnonymousTag, profileId);
+        SuccessOrExit(err);
+
+        err = aWriter.Put(AnonymousTag, aSchemaVersionRange.mMaxVersion);
+        SuccessOrExit(err);
+
+        if (aSchemaVersionRange.mMinVersion != 1)
+        {
+            err = aWriter.Put(AnonymousTag, aSchemaVersionRange.mMinVersion);
+            SuccessOrExit(err);
+        }
+
+        err = aWriter.EndContainer(profileContainerType);
+        SuccessOrExit(err);
+    }
+    else
+    {
+        err = aWriter.Put(ContextTag(Path::kCsTag_TraitProfileID), profileId);
+        SuccessOrExit(err);
+    }
+
+    if (mCatalogStore[aHandle].mInstanceId != 0)
+    {
+        err = aWriter.Put(ContextTag(Path::kCsTag_TraitInstanceID), mCatalogStore[aHandle].mInstanceId);
+        SuccessOrExit(err);
+    }
+
+    err = mCatalogStore[aHandle].mResourceId->ToTLV(aWriter);
+    SuccessOrExit(err);
+
+    err = aWriter.EndContainer(containerType);
+
+exit:
+    return err;
+}
+
+template <typename T>
+WEAVE_ERROR MultiResourceTraitCatalog<T>::Locate(TraitDataHandle aHandle, T ** aTraitInstance) const
+{
+    if (!IsValid(aHandle))
+    {
+        return WEAVE_ERROR_INVALID_ARGUMENT;
+    }
+
+    *aTraitInstance = mCatalogStore[aHandle].mItem;
+    return WEAVE_NO_ERROR;
+}
+
+template <typename T>
+WEAVE_ERROR MultiResourceTraitCatalog<T>::Locate(T * aTraitInstance, TraitDataHandle & aHandle) const
+{
+    const char * item = reinterpret_cast<const char *>(aTraitInstance);
+
+    // Called for every SetDirty(), so look the item up by address within its array.
+    for (uint32_t i = 0; i < mArrayCount; i++)
+    {
+        const ItemArray & array = mArrays[i];
+        const char * first      = reinterpret_cast<const char *>(array.mFirst);
+        size_t offset;
+
+        if (item < first)
+        {
+            continue;
+        }
+
+        offset = (size_t)(item - first);
+        if (offset < array.mStride * array.mCount && (offset % array.mStride) == 0)
+        {
+            aHandle = (TraitDataHandle)(array.mFirstHandle + offset / array.mStride);
+            return WEAVE_NO_ERROR;
+        }
+    }
+
+    return WEAVE_ERROR_INVALID_ARGUMENT;
+}
+
+template <typename T>
+WEAVE_ERROR MultiResourceTraitCatalog<T>::DispatchEvent(uint16_t aEvent, void * aContext) const
+{
+    for (uint32_t handle = 0; handle < mCatalogSize; handle++)
+    {
+        if (mCatalogStore[handle].mItem != NULL)
+        {
+            mCatalogStore[handle].mItem->OnEvent(aEvent, aContext);
+        }
+    }
+
+    return WEAVE_NO_ERROR;
+}
+
+template <typename T>
+WEAVE_ERROR MultiResourceTraitCatalog<T>::Iterate(IteratorCallback aCallback, void * aContext)
+{
+    for (uint32_t handle = 0; handle < mCatalogSize; handle++)
+    {
+        if (mCatalogStore[handle].mItem != NULL)
+        {
+            aCallback(mCatalogStore[handle].mItem, (TraitDataHandle) handle, aContext);
+        }
+    }
+
+    return WEAVE_NO_ERROR;
+}
+
+#if WEAVE_CONFIG_ENABLE_WDM_UPDATE
+
+template <typename T>
+WEAVE_ERROR MultiResourceTraitCatalog<T>::GetInstanceId(TraitDataHandle aHandle, uint64_t & aInstanceId) const
+{
+    if (!IsValid(aHandle))
+    {
+        return WEAVE_ERROR_INVALID_ARGUMENT;
+    }
+
+    aInstanceId = mCatalogStore[aHandle].mInstanceId;
+    return WEAVE_NO_ERROR;
+}
+
+template <typename T>
+WEAVE_ERROR MultiResourceTraitCatalog<T>::GetResourceId(TraitDataHandle aHandle, ResourceIdentifier & aResourceId) const
+{
+    if (!IsValid(aHandle))
+    {
+        return WEAVE_ERROR_INVALID_ARGUMENT;
+    }
+
+    aResourceId = *mCatalogStore[aHandle].mResourceId;
+    return WEAVE_NO_ERROR;
+}
+
+#endif // WEAVE_CONFIG_ENABLE_WDM_UPDATE
+
+#endif // MULTI_RESOURCE_TRAIT_CATALOG_H
@@ -0,0 +1,284 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      Copy in flash of the important events, kept until the service has them.
+ *
+ *      The event log of the Device Layer only lives in RAM: a reset while the
+ *      service is unreachable loses the events that were not offloaded yet, and
+ *      a long disconnection evicts the oldest ones. Events logged with
+ *      LogEventDirect() at PERSISTED_EVENT_LOG_IMPORTANCE or above are also
+ *      appended to a ring of pages, each an AppPersistentStorage record, so the
+ *      underlying nvm3 / FDS store spreads the writes over its flash pages.
+ *
+ *      Entries store their timestamp and event id as a difference with the
+ *      previous entry of the page, and their schema only when it changes, so a
+ *      page holds about twice as many small events as with full headers. They
+ *      are expanded when logged again. This only applies to the pages: the RAM
+ *      event buffers of the Device Layer, which assign the event ids, keep
+ *      full headers.
+ *
+ *      Events are batched in a RAM page, written when it fills up or
+ *      PERSISTED_EVENT_LOG_FLUSH_DELAY_MS after the first event of a batch. Once
+ *      the service counter-subscription is established, the events it cannot
+ *      get from the RAM log (logged before a reboot, or evicted) are logged
+ *      again, one page at a time, with their original UTC timestamps: the
+ *      notification engine sends them in as few notifies as they fit in. Pages
+ *      are retired once the service has confirmed their events: on the response
+ *      to a notify of the counter-subscription that carried the events pending
+ *      when it started, and was not followed by another one for the events that
+ *      did not fit. Delivery is at least once: a reboot before then sends them
+ *      again.
+ *
+ *      An event logged again gets a new event id from the RAM log, and carries
+ *      the id and importance of the original as its related event. The service
+ *      may receive several copies of an event (the original before an
+ *      eviction or a reboot, or copies from replays that were not confirmed):
+ *      copies with the same related event id and importance, or whose related
+ *      event id it already has, are duplicates.
+ */
+
+#ifndef PERSISTED_EVENT_LOG_H
+#define PERSISTED_EVENT_LOG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <Weave/DeviceLayer/WeaveDeviceLayer.h>
+#include <Weave/Profiles/data-management/DataManagement.h>
+
+#include "AppPersistentStorage.h"
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+/** Defines the number of pages of the ring. 0 disables the persisted event log.
+ */
+#ifndef PERSISTED_EVENT_LOG_PAGE_COUNT
+#define PERSISTED_EVENT_LOG_PAGE_COUNT 16
+#endif
+
+/** Defines the size of a page, header included. Within the default maximum
+ *  nvm3 object size of the EFR32 SDK.
+ */
+#ifndef PERSISTED_EVENT_LOG_PAGE_SIZE
+#define PERSISTED_EVENT_LOG_PAGE_SIZE 240
+#endif
+
+/** Defines the least important events persisted.
+ */
+#ifndef PERSISTED_EVENT_LOG_IMPORTANCE
+#define PERSISTED_EVENT_LOG_IMPORTANCE nl::Weave::Profiles::DataManagement::ProductionCritical
+#endif
+
+/** Defines how long a partially filled page may stay in RAM only.
+ */
+#ifndef PERSISTED_EVENT_LOG_FLUSH_DELAY_MS
+#define PERSISTED_EVENT_LOG_FLUSH_DELAY_MS 1000
+#endif
+
+/** Defines the interval between two pages logged again, so that the RAM log
+ *  is offloaded before the next page is added to it.
+ */
+#ifndef PERSISTED_EVENT_LOG_REPLAY_INTERVAL_MS
+#define PERSISTED_EVENT_LOG_REPLAY_INTERVAL_MS 500
+#endif
+
+// Set to 1 to log the cost of persisting and offloading 1000 events at startup.
+// Retires all the pages of the ring.
+#ifndef PERSISTED_EVENT_LOG_BENCHMARK
+#define PERSISTED_EVENT_LOG_BENCHMARK 0
+#endif
+
+#if PERSISTED_EVENT_LOG_PAGE_COUNT
+
+static_assert(PERSISTED_EVENT_LOG_PAGE_COUNT <=
+                  AppPersistentStorage::kRecordId_EventLogPageLast - AppPersistentStorage::kRecordId_EventLogPageFirst + 1,
+              "PERSISTED_EVENT_LOG_PAGE_COUNT exceeds the record ids reserved for the event log");
+
+class PersistedEventLog
+{
+    typedef ::nl::Weave::Profiles::DataManagement::event_id_t event_id_t;
+    typedef ::nl::Weave::Profiles::DataManagement::EventSchema EventSchema;
+    typedef ::nl::Weave::TLV::TLVWriter TLVWriter;
+
+public:
+    struct Stats
+    {
+        uint32_t PersistedCount;   // Events appended to the ring.
+        uint32_t DroppedCount;     // Events lost: no page buffer free, or their page overwritten before retirement.
+        uint32_t PageWriteCount;   // Flash writes of pages.
+        uint32_t MetaWriteCount;   // Flash writes of the retirement record.
+        uint32_t ReplayedCount;    // Events logged again after a reboot or an eviction.
+        uint32_t RetiredCount;     // Events known to be offloaded.
+        uint32_t LastOffloadMs;    // From the service connection to the last page logged again.
+        uint32_t EntryBytes;       // Size of the entries appended.
+        uint32_t ExpandedBytes;    // Size they would take with full headers.
+    };
+
+    // Reads the ring left by the previous boot. Called by WDMFeatureBase::Init().
+    WEAVE_ERROR Init(void);
+
+    // Appends an event just logged as eventId, if important enough. May be called from any task.
+    template <typename EventT>
+    void Append(const EventT & event, event_id_t eventId)
+    {
+        if (EventT::Schema.mImportance <= PERSISTED_EVENT_LOG_IMPORTANCE)
+        {
+            AppendEntry(EventT::Schema, eventId, SerializeEntry<EventT>, &event);
+        }
+    }
+
+    // Called on the Weave task when the service counter-subscription, which
+    // carries the events, is established or terminated.
+    void OnServiceCounterSubscriptionChange(bool established);
+
+    // Called on the Weave task when the service has confirmed all the events
+    // logged before the monotonic time loggedBeforeMs.
+    void OnEventsDelivered(uint64_t loggedBeforeMs);
+
+    // May be called from any task.
+    void GetStats(Stats & stats);
+    void LogStats(void);
+
+    static PersistedEventLog & GetInstance(void) { return sInstance; }
+
+#if PERSISTED_EVENT_LOG_BENCHMARK
+    // Persists event 1000 times then reads the pages back as an offload would.
+    template <typename EventT>
+    void RunBenchmark(const EventT & event, const char * name)
+    {
+        RunBenchmark(EventT::Schema, SerializeEntry<EventT>, &event, name);
+    }
+#endif
+
+private:
+    typedef WEAVE_ERROR (*SerializeFunct)(TLVWriter & writer, const void * event);
+
+    // Page, in flash and in RAM:
+    //   Sequence (4), Length of the entries (2), EventCount (2)
+    // followed by EventCount entries, each relative to the previous entry of the page:
+    //   UtcTimestampMs delta (zigzag varint),
+    //   EventId delta << 1 | kEntryFlag_Schema (zigzag varint),
+    //   if kEntryFlag_Schema: ProfileId (4), StructureType (2), Importance (1), DataSchemaVersion (1),
+    //   DataLength (1), anonymous TLV structure of the event data
+    // The first entry of a page is relative to 0 and carries its schema.
+    enum
+    {
+        kPageHeaderSize          = 8,
+        kSchemaSize              = 8,
+        kMaxEntryHeaderSize      = 10 + 5 + kSchemaSize + 1,
+        kExpandedEntryHeaderSize = 8 + 4 + kSchemaSize + 1,
+        kMaxDataLength           = UINT8_MAX,
+        kEntryFlag_Schema        = 0x01,
+    };
+
+    // RAM state of a slot of the ring.
+    struct PageInfo
+    {
+        uint32_t Sequence; // Order of the page in the ring, 0 if the slot was never written.
+        uint16_t EventCount;
+        bool FromPreviousBoot;    // Its events are not in the RAM log.
+        bool NeedsReplay;         // Some of its events may have to be logged again.
+        uint16_t ReplayedEntries; // Entries already handled by a replay that failed partway.
+        uint64_t OfferedMs;       // Last time events of the page entered the RAM log.
+    };
+
+    template <typename EventT>
+    static WEAVE_ERROR SerializeEntry(TLVWriter & writer, const void * event)
+    {
+        return SerializeEvent(writer, ::nl::Weave::TLV::AnonymousTag, *static_cast<const EventT *>(event));
+    }
+
+    void AppendEntry(const EventSchema & schema, event_id_t eventId, SerializeFunct serialize, const void * event);
+    size_t EncodeEntryHeader(const EventSchema & schema, event_id_t eventId, uint64_t utcTimeMs, uint8_t * header) const;
+    bool IsPending(const PageInfo & page) const { return page.Sequence > mRetiredSequence; }
+    void StartNewPage(void);
+    bool SealFillPage(void);
+
+    WEAVE_ERROR FlushPages(bool includeFillPage);
+    WEAVE_ERROR WritePage(uint8_t slot, const uint8_t * page, size_t len);
+    WEAVE_ERROR ReadPage(uint8_t slot, size_t & len);
+    void ReleaseWriteBuffer(void);
+    WEAVE_ERROR ReplayPage(uint8_t slot, bool dryRun, uint16_t & entryIndex, uint32_t & replayedCount);
+    void RunMaintenance(void);
+    void RetirePages(void);
+
+    static void AsyncFlush(intptr_t arg);
+    static void HandleFlushTimer(::nl::Weave::System::Layer * systemLayer, void * appState, ::nl::Weave::System::Error error);
+    static void HandleMaintenanceTimer(::nl::Weave::System::Layer * systemLayer, void * appState,
+                                       ::nl::Weave::System::Error error);
+
+#if PERSISTED_EVENT_LOG_BENCHMARK
+    void RunBenchmark(const EventSchema & schema, SerializeFunct serialize, const void * event, const char * name);
+#endif
+
+    // Guards the fill page, the write buffer state, the slots and the stats,
+    // shared with the tasks logging events.
+    SemaphoreHandle_t mLock;
+#if APP_USE_STATIC_ALLOCATION
+    StaticSemaphore_t mLockStruct;
+#endif
+
+    PageInfo mPages[PERSISTED_EVENT_LOG_PAGE_COUNT];
+    uint32_t mNextSequence;
+    uint32_t mRetiredSequence; // Pages up to this sequence are offloaded.
+
+    // Page being filled, and its slot.
+    uint8_t mFillPage[PERSISTED_EVENT_LOG_PAGE_SIZE];
+    uint16_t mFillLength;
+    uint16_t mFlushedLength; // Part of mFillLength already in flash.
+    uint8_t mFillSlot;
+
+    // Last entry of the fill page, which the next one is encoded against.
+    uint64_t mLastUtcTimeMs;
+    event_id_t mLastEventId;
+    EventSchema mLastSchema;
+
+    // Copy of a page being written, or a page read back.
+    enum WriteBufferState
+    {
+        kWriteBuffer_Free = 0,
+        kWriteBuffer_Sealed, // Full page handed over by AppendEntry(), to be written.
+        kWriteBuffer_InUse,  // Being written or read by FlushPages() or ReplayPage().
+    };
+    uint8_t mWriteBuffer[PERSISTED_EVENT_LOG_PAGE_SIZE];
+    uint16_t mWriteLength;
+    uint8_t mWriteSlot;
+    WriteBufferState mWriteBufferState;
+
+    // Set by AppendEntry() with atomic operations, cleared by AsyncFlush().
+    bool mIsFlushScheduled;
+
+    // Owned by the Weave task.
+    bool mIsFlushTimerArmed;
+    bool mIsServiceConnected;
+    bool mIsOffloadPending; // Pages must be logged again since the last connection.
+    uint64_t mConnectedSinceMs;
+    uint64_t mDeliveredBeforeMs; // Events that entered the RAM log before are confirmed.
+    uint32_t mOffloadReplayedCount;
+
+    Stats mStats;
+
+    static PersistedEventLog sInstance;
+};
+
+#endif // PERSISTED_EVENT_LOG_PAGE_COUNT
+
+#endif // PERSISTED_EVENT_LOG_H
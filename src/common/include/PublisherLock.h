@@ -0,0 +1,70 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#ifndef PUBLISHER_LOCK_H
+#define PUBLISHER_LOCK_H
+
+#include <stdint.h>
+
+#include <Weave/DeviceLayer/WeaveDeviceLayer.h>
+#include <Weave/Profiles/data-management/Current/DataManagement.h>
+
+#include "FreeRTOS.h"
+#include "semphr.h"
+
+class PublisherLock : public nl::Weave::Profiles::DataManagement::IWeavePublisherLock
+{
+public:
+    // Creates a recursice mutex
+    int Init();
+
+    // Takes the mutex recursively.
+    WEAVE_ERROR Lock();
+
+    // Gives the mutex recursively.
+    WEAVE_ERROR Unlock();
+
+    // Counters for the outermost Lock()/Unlock() pairs.
+    struct Stats
+    {
+        uint32_t LockCount;      // Number of acquisitions.
+        uint32_t ContendedCount; // Acquisitions that had to wait for another task.
+        uint32_t MaxWaitUs;
+        uint32_t MaxHoldUs;
+        uint64_t TotalHoldUs;
+    };
+
+    // Copies the counters. May be called from any task.
+    void GetStats(Stats & stats);
+
+    void LogStats(void);
+
+private:
+    SemaphoreHandle_t mRecursiveLock;
+#if APP_USE_STATIC_ALLOCATION
+    StaticSemaphore_t mRecursiveLockStruct;
+#endif
+
+    // Owned by the task holding the mutex.
+    uint32_t mDepth;
+    uint64_t mAcquiredTimeUs;
+
+    Stats mStats;
+};
+
+#endif // PUBLISHER_LOCK_H
@@ -0,0 +1,92 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#ifndef RESPONSE_BUFFER_POOL_H
+#define RESPONSE_BUFFER_POOL_H
+
+#include <stdint.h>
+
+#include <Weave/DeviceLayer/WeaveDeviceLayer.h>
+
+#include "SeqLock.h"
+
+/** Defines the number of packet buffers reserved for the responses to commands.
+ */
+#ifndef RESPONSE_BUFFER_POOL_SIZE
+#define RESPONSE_BUFFER_POOL_SIZE 2
+#endif
+
+/** Defines how long to wait before replacing a reserved buffer again when the
+ *  packet buffers are exhausted.
+ */
+#ifndef RESPONSE_BUFFER_POOL_RETRY_MS
+#define RESPONSE_BUFFER_POOL_RETRY_MS 1000
+#endif
+
+static_assert(RESPONSE_BUFFER_POOL_SIZE > 0, "RESPONSE_BUFFER_POOL_SIZE must be at least 1");
+
+/**
+ * Packet buffers allocated ahead of time for the responses to commands.
+ *
+ * A command is carried out before its response is built: allocating the
+ * response when the packet buffers are exhausted tells the sender that a
+ * command the device executed failed. A buffer taken from the pool goes to the
+ * stack with the response, and is replaced after the handler returns, once the
+ * buffers of the command are released.
+ *
+ * Owned by the Weave task. The statistics are published through a SeqLock and
+ * may be read from any task.
+ */
+class ResponseBufferPool
+{
+public:
+    struct Stats
+    {
+        uint32_t TakenCount;         // Responses built in a reserved buffer.
+        uint32_t AllocatedCount;     // Responses built in a new buffer, the pool being empty.
+        uint32_t FailedCount;        // Responses without a buffer.
+        uint32_t RefillFailureCount; // Reserved buffers that could not be replaced right away.
+    };
+
+    ResponseBufferPool(void);
+
+    // Reserves the buffers. Called once the Weave stack is initialized, on the
+    // Weave task or with the Weave stack lock held.
+    void Init(void);
+
+    // Returns an empty buffer for a response: a reserved one, or a new one if
+    // none is left. NULL if the packet buffers are exhausted too.
+    ::nl::Weave::System::PacketBuffer * Take(void);
+
+    void GetStats(Stats & stats) const { mPublishedStats.Read(stats); }
+
+private:
+    bool Refill(void);
+    void ScheduleRefill(uint32_t delayMs);
+
+    static void HandleRefillTimer(::nl::Weave::System::Layer * systemLayer, void * appState, ::nl::Weave::System::Error error);
+
+    ::nl::Weave::System::PacketBuffer * mBuffers[RESPONSE_BUFFER_POOL_SIZE];
+    uint8_t mCount;
+    bool mIsRefillTimerArmed;
+
+    Stats mStats;
+    SeqLock<Stats> mPublishedStats;
+};
+
+#endif // RESPONSE_BUFFER_POOL_H
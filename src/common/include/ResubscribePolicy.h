@@ -0,0 +1,66 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#ifndef RESUBSCRIBE_POLICY_H
+#define RESUBSCRIBE_POLICY_H
+
+#include <stdint.h>
+
+/**
+ * Backoff between the resubscribe attempts of a subscription client.
+ *
+ * Called on the Weave task, through the resubscribe policy callback of the
+ * client, before each attempt.
+ */
+class ResubscribePolicy
+{
+public:
+    // Delay before the next attempt. retryCount is 0 for the first attempt
+    // after the subscription was lost or ResetResubscribe() was called.
+    virtual uint32_t GetRetryIntervalMs(uint32_t retryCount) = 0;
+
+    // The link to the publisher is back; the next attempt should not wait.
+    virtual void OnLinkRestored(void) = 0;
+
+protected:
+    virtual ~ResubscribePolicy(void) {}
+};
+
+/**
+ * "Decorrelated jitter" backoff: each interval is drawn uniformly from
+ * [base, 3 * previous interval], capped at max. Devices that lose their
+ * subscriptions at the same time (e.g. on a border router reboot) spread their
+ * attempts instead of retrying in lockstep, while the expected interval still
+ * grows exponentially.
+ */
+class DecorrelatedJitterResubscribePolicy : public ResubscribePolicy
+{
+public:
+    DecorrelatedJitterResubscribePolicy(uint32_t baseIntervalMs, uint32_t maxIntervalMs);
+
+    uint32_t GetRetryIntervalMs(uint32_t retryCount) override;
+    void OnLinkRestored(void) override;
+
+private:
+    uint32_t mBaseIntervalMs;
+    uint32_t mMaxIntervalMs;
+    uint32_t mLastIntervalMs;
+    bool mRetryNow;
+};
+
+#endif // RESUBSCRIBE_POLICY_H
@@ -0,0 +1,78 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#ifndef RTT_ESTIMATOR_H
+#define RTT_ESTIMATOR_H
+
+#include <stdint.h>
+
+#include "SeqLock.h"
+
+/**
+ * Round-trip time estimator of RFC 6298, computing the retransmission timeout
+ * of a peer as SRTT + max(G, 4 * RTTVAR) within [min, max].
+ *
+ * Samples are added by a single task (the Weave task). The statistics are
+ * published through a SeqLock and may be read from any task.
+ */
+class RttEstimator
+{
+public:
+    struct Stats
+    {
+        uint32_t SampleCount;      // Samples taken into the estimate.
+        uint32_t DiscardedCount;   // Ambiguous samples (the message was retransmitted).
+        uint32_t BackoffCount;     // Timeouts that doubled the retransmission timeout.
+        uint32_t SrttMs;           // Smoothed round-trip time.
+        uint32_t RttVarMs;         // Round-trip time variation.
+        uint32_t LastRttMs;
+        uint32_t MinRttMs;
+        uint32_t MaxRttMs;
+        uint32_t RetransTimeoutMs; // Current retransmission timeout.
+    };
+
+    // The timeout is maxTimeoutMs until the first sample.
+    void Init(uint32_t minTimeoutMs, uint32_t maxTimeoutMs, uint32_t granularityMs);
+
+    // Each returns true if the retransmission timeout changed.
+    bool AddSample(uint32_t rttMs);
+    bool Backoff(void);
+
+    // Karn's algorithm: the round trip of a retransmitted message is unknown.
+    void DiscardSample(void);
+
+    uint32_t GetRetransTimeoutMs(void) const { return mRetransTimeoutMs; }
+    void GetStats(Stats & stats) const { mPublishedStats.Read(stats); }
+
+private:
+    bool SetRetransTimeout(uint32_t timeoutMs);
+
+    uint32_t mMinTimeoutMs;
+    uint32_t mMaxTimeoutMs;
+    uint32_t mGranularityMs;
+
+    // SRTT << 3 and RTTVAR << 2, so that the 1/8 and 1/4 gains stay in integers.
+    uint32_t mScaledSrtt;
+    uint32_t mScaledRttVar;
+    uint32_t mRetransTimeoutMs;
+
+    Stats mStats;
+    SeqLock<Stats> mPublishedStats;
+};
+
+#endif // RTT_ESTIMATOR_H
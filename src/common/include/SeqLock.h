@@ -0,0 +1,89 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#ifndef SEQ_LOCK_H
+#define SEQ_LOCK_H
+
+#include <stdint.h>
+
+/**
+ * Double-buffered sequence lock publishing a snapshot of a small, trivially
+ * copyable value from a single writer task to any number of reader tasks.
+ *
+ * The value is kept in two slots. The writer bumps the sequence number before
+ * updating each slot, which steers readers to the other, stable slot. A reader
+ * picks the slot from the sequence number, copies it and retries only if the
+ * writer ran in the meantime. Neither side ever blocks, and a reader that
+ * preempts the writer in the middle of Publish() still completes without
+ * spinning, which a single-slot seqlock cannot guarantee under the priority
+ * based FreeRTOS scheduler.
+ */
+template <typename T>
+class SeqLock
+{
+public:
+    SeqLock(void) : mSequence(0) {}
+
+    // Sets both slots. Must be called before any reader can run.
+    void Init(const T & value)
+    {
+        mSlots[0] = value;
+        mSlots[1] = value;
+    }
+
+    // Publishes a new value. Must only be called by the writer task.
+    void Publish(const T & value)
+    {
+        // Readers move to slot 1 while slot 0 is updated...
+        Bump();
+        mSlots[0] = value;
+
+        // ...then back to slot 0 while slot 1 is updated.
+        Bump();
+        mSlots[1] = value;
+    }
+
+    // Copies the last published value. May be called from any task.
+    void Read(T & value) const
+    {
+        uint32_t sequence;
+
+        do
+        {
+            sequence = __atomic_load_n(&mSequence, __ATOMIC_ACQUIRE);
+            value    = mSlots[sequence & 1];
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        } while (sequence != __atomic_load_n(&mSequence, __ATOMIC_RELAXED));
+    }
+
+    // Number of Publish() calls so far. May be called from any task.
+    uint32_t GetPublishCount(void) const { return __atomic_load_n(&mSequence, __ATOMIC_ACQUIRE) >> 1; }
+
+private:
+    void Bump(void)
+    {
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        __atomic_store_n(&mSequence, mSequence + 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+    }
+
+    uint32_t mSequence;
+    T mSlots[2];
+};
+
+#endif // SEQ_LOCK_H
@@ -0,0 +1,170 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      Table-driven GetLeafData/SetLeafData for trait data sources and sinks.
+ *
+ *      A trait declares one entry per schema property handle, in handle order,
+ *      binding the handle to an encoder (sources) or a decoder (sinks) that is
+ *      instantiated at compile time for a given member. Leaf lookup is then a
+ *      plain array index, and IsTraitLeafTableValid() lets a static_assert
+ *      reject a table that does not match the handles generated for the schema.
+ *
+ *      Example:
+ *
+ *        static constexpr TraitLeafEncoder<TraitState> kLeafEncoders[] = {
+ *            TRAIT_LEAF_FIELD(FooTrait::kPropertyHandle_Bar, TraitState, Bar),
+ *            TRAIT_LEAF_NULL(FooTrait::kPropertyHandle_Baz, TraitState),
+ *        };
+ *        static_assert(IsTraitLeafTableValid(kLeafEncoders, FooTrait::kLastSchemaHandle), "FooTrait leaf table mismatch");
+ */
+
+#ifndef TRAIT_LEAF_TABLE_H
+#define TRAIT_LEAF_TABLE_H
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <Weave/DeviceLayer/WeaveDeviceLayer.h>
+#include <Weave/Profiles/data-management/DataManagement.h>
+
+// Binds a property handle to the encoder of a leaf of a data source.
+template <typename StateT>
+struct TraitLeafEncoder
+{
+    ::nl::Weave::Profiles::DataManagement_Current::PropertyPathHandle Handle;
+    // NULL for handles that are not leaves.
+    WEAVE_ERROR (*Encode)(const StateT & state, uint64_t tag, ::nl::Weave::TLV::TLVWriter & writer);
+};
+
+// Binds a property handle to the decoder of a leaf of a data sink.
+template <typename SinkT>
+struct TraitLeafDecoder
+{
+    ::nl::Weave::Profiles::DataManagement_Current::PropertyPathHandle Handle;
+    // NULL for handles that are not leaves or that are ignored.
+    WEAVE_ERROR (*Decode)(SinkT & sink, ::nl::Weave::TLV::TLVReader & reader);
+};
+
+// Table entries.
+#define TRAIT_LEAF_FIELD(handle, StateT, field)                                                                                    \
+    { (handle), &EncodeTraitLeafField<StateT, decltype(StateT::field), &StateT::field> }
+#define TRAIT_LEAF_NULL(handle, StateT) { (handle), &EncodeTraitLeafNull<StateT> }
+#define TRAIT_LEAF_SETTER(handle, SinkT, ValueT, setter) { (handle), &DecodeTraitLeafValue<SinkT, ValueT, &SinkT::setter> }
+#define TRAIT_LEAF_NONE(handle) { (handle), NULL }
+
+// -----------------------------------------------------------------------------
+// Encoders and decoders
+
+inline WEAVE_ERROR PutTraitLeafValue(::nl::Weave::TLV::TLVWriter & writer, uint64_t tag, bool value)
+{
+    return writer.PutBoolean(tag, value);
+}
+
+template <typename ValueT>
+inline WEAVE_ERROR PutTraitLeafValue(::nl::Weave::TLV::TLVWriter & writer, uint64_t tag, ValueT value)
+{
+    return writer.Put(tag, value);
+}
+
+template <typename StateT, typename FieldT, FieldT StateT::*Field>
+WEAVE_ERROR EncodeTraitLeafField(const StateT & state, uint64_t tag, ::nl::Weave::TLV::TLVWriter & writer)
+{
+    return PutTraitLeafValue(writer, tag, state.*Field);
+}
+
+template <typename StateT>
+WEAVE_ERROR EncodeTraitLeafNull(const StateT & state, uint64_t tag, ::nl::Weave::TLV::TLVWriter & writer)
+{
+    return writer.PutNull(tag);
+}
+
+template <typename SinkT, typename ValueT, void (SinkT::*Setter)(ValueT)>
+WEAVE_ERROR DecodeTraitLeafValue(SinkT & sink, ::nl::Weave::TLV::TLVReader & reader)
+{
+    ValueT value;
+    WEAVE_ERROR err = reader.Get(value);
+
+    if (err == WEAVE_NO_ERROR)
+    {
+        (sink.*Setter)(value);
+    }
+
+    return err;
+}
+
+// -----------------------------------------------------------------------------
+// Table validation and lookup
+
+// Entry i must bind the handle of the (i + 1)th property after the root, and
+// there must be exactly one entry per property of the schema.
+template <typename EntryT, size_t N>
+constexpr bool IsTraitLeafTableValid(const EntryT (&table)[N], uint32_t lastSchemaHandle, size_t index = 0)
+{
+    return (N == lastSchemaHandle - ::nl::Weave::Profiles::DataManagement_Current::kRootPropertyPathHandle) &&
+        ((index == N) ||
+         ((table[index].Handle == ::nl::Weave::Profiles::DataManagement_Current::kRootPropertyPathHandle + 1 + index) &&
+          IsTraitLeafTableValid(table, lastSchemaHandle, index + 1)));
+}
+
+template <typename EntryT, size_t N>
+inline const EntryT * FindTraitLeaf(const EntryT (&table)[N],
+                                    ::nl::Weave::Profiles::DataManagement_Current::PropertyPathHandle handle)
+{
+    size_t index = ::nl::Weave::Profiles::DataManagement_Current::GetPropertySchemaHandle(handle) -
+        ::nl::Weave::Profiles::DataManagement_Current::kRootPropertyPathHandle - 1;
+
+    // Handles below the first leaf wrap around and fail this check too.
+    return (index < N) ? &table[index] : NULL;
+}
+
+template <typename StateT, size_t N>
+WEAVE_ERROR EncodeTraitLeaf(const TraitLeafEncoder<StateT> (&table)[N],
+                            ::nl::Weave::Profiles::DataManagement_Current::PropertyPathHandle handle, const StateT & state,
+                            uint64_t tag, ::nl::Weave::TLV::TLVWriter & writer)
+{
+    const TraitLeafEncoder<StateT> * entry = FindTraitLeaf(table, handle);
+
+    if (entry == NULL || entry->Encode == NULL)
+    {
+        WeaveLogError(Support, "Unexpected Leaf %" PRIu32, (uint32_t) handle);
+        return WEAVE_NO_ERROR;
+    }
+
+    return entry->Encode(state, tag, writer);
+}
+
+template <typename SinkT, size_t N>
+WEAVE_ERROR DecodeTraitLeaf(const TraitLeafDecoder<SinkT> (&table)[N],
+                            ::nl::Weave::Profiles::DataManagement_Current::PropertyPathHandle handle, SinkT & sink,
+                            ::nl::Weave::TLV::TLVReader & reader)
+{
+    const TraitLeafDecoder<SinkT> * entry = FindTraitLeaf(table, handle);
+
+    if (entry == NULL || entry->Decode == NULL)
+    {
+        WeaveLogDetail(Support, "Ignored Leaf %" PRIu32, (uint32_t) handle);
+        return WEAVE_NO_ERROR;
+    }
+
+    return entry->Decode(sink, reader);
+}
+
+#endif // TRAIT_LEAF_TABLE_H
@@ -0,0 +1,80 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#ifndef VERSIONED_SNAPSHOT_H
+#define VERSIONED_SNAPSHOT_H
+
+#include <stdint.h>
+
+#include "SeqLock.h"
+
+/**
+ * Copy of the state published by a trait data source, taken once per data
+ * version of the trait.
+ *
+ * The notification engine encodes the dirty properties of a trait once per
+ * subscriber, calling GetLeafData() for each leaf. Reading the SeqLock on every
+ * call copies the whole state once per leaf and per subscriber, and lets two
+ * subscribers notified at the same version see different data if the AppTask
+ * publishes in between. The snapshot is only refreshed when the version
+ * changes or a new state is published, so all the notifies of a version are
+ * encoded from the same copy unless the state changes in the meantime.
+ *
+ * The version alone is not enough: SetDirty() only bumps it once until the
+ * next notify, so two publishes in a row may share a version, and the second
+ * state would never be read. Owned by the Weave task.
+ */
+template <typename T>
+class VersionedSnapshot
+{
+public:
+    VersionedSnapshot(void) : mVersion(0), mPublishCount(0), mIsValid(false), mRefreshCount(0) {}
+
+    // The state at version, read from published on the first call for that
+    // version and for each state published since.
+    const T & Get(const SeqLock<T> & published, uint64_t version)
+    {
+        // Read before the value: a publish in between only costs another refresh.
+        uint32_t publishCount = published.GetPublishCount();
+
+        if (!mIsValid || version != mVersion || publishCount != mPublishCount)
+        {
+            published.Read(mValue);
+            mVersion      = version;
+            mPublishCount = publishCount;
+            mIsValid      = true;
+            mRefreshCount++;
+        }
+
+        return mValue;
+    }
+
+    void Invalidate(void) { mIsValid = false; }
+
+    // Number of reads of the published state.
+    uint32_t GetRefreshCount(void) const { return mRefreshCount; }
+
+private:
+    T mValue;
+    uint64_t mVersion;
+    uint32_t mPublishCount;
+    bool mIsValid;
+    uint32_t mRefreshCount;
+};
+
+#endif // VERSIONED_SNAPSHOT_H
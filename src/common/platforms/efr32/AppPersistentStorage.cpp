@@ -0,0 +1,103 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ * @file
+ *   Application records of the EFR32 platform, one nvm3 object per record.
+ *
+ *   The records share the default nvm3 instance, which the Device Layer opens
+ *   for the Weave configuration, and use keys outside of its key ranges.
+ */
+
+#include "AppPersistentStorage.h"
+
+#include "nvm3.h"
+#include "nvm3_default.h"
+
+// nvm3 key of record 0. Keys are 20 bits; the Weave configuration uses 0x087200 - 0x087FFF.
+#ifndef EFR32_APP_STORAGE_NVM3_KEY_BASE
+#define EFR32_APP_STORAGE_NVM3_KEY_BASE 0x0A7000
+#endif
+
+static inline nvm3_ObjectKey_t GetRecordKey(unsigned id)
+{
+    return EFR32_APP_STORAGE_NVM3_KEY_BASE + id;
+}
+
+static WEAVE_ERROR MapNvm3Error(Ecode_t ecode)
+{
+    switch (ecode)
+    {
+    case ECODE_NVM3_OK:
+        return WEAVE_NO_ERROR;
+    case ECODE_NVM3_ERR_KEY_NOT_FOUND:
+        return WEAVE_DEVICE_ERROR_CONFIG_NOT_FOUND;
+    default:
+        return WEAVE_ERROR_PERSISTED_STORAGE_FAIL;
+    }
+}
+
+WEAVE_ERROR AppPersistentStorage::Read(RecordId id, void * buf, size_t bufSize, size_t & readLen)
+{
+    WEAVE_ERROR err;
+    uint32_t objectType;
+    size_t dataLen;
+
+    err = MapNvm3Error(nvm3_getObjectInfo(nvm3_defaultHandle, GetRecordKey(id), &objectType, &dataLen));
+    SuccessOrExit(err);
+
+    VerifyOrExit(dataLen <= bufSize, err = WEAVE_ERROR_BUFFER_TOO_SMALL);
+
+    err = MapNvm3Error(nvm3_readData(nvm3_defaultHandle, GetRecordKey(id), buf, dataLen));
+    SuccessOrExit(err);
+
+    readLen = dataLen;
+
+exit:
+    return err;
+}
+
+WEAVE_ERROR AppPersistentStorage::Write(RecordId id, const void * data, size_t dataLen)
+{
+    WEAVE_ERROR err = MapNvm3Error(nvm3_writeData(nvm3_defaultHandle, GetRecordKey(id), data, dataLen));
+
+    // Reclaim the pages of deleted objects before the instance runs full.
+    if (err == WEAVE_NO_ERROR && nvm3_repackNeeded(nvm3_defaultHandle))
+    {
+        err = MapNvm3Error(nvm3_repack(nvm3_defaultHandle));
+    }
+
+    return err;
+}
+
+WEAVE_ERROR AppPersistentStorage::EraseAll(void)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+    for (unsigned id = 1; id <= kRecordId_Max; id++)
+    {
+        WEAVE_ERROR deleteErr = MapNvm3Error(nvm3_deleteObject(nvm3_defaultHandle, GetRecordKey(id)));
+
+        if (deleteErr != WEAVE_NO_ERROR && deleteErr != WEAVE_DEVICE_ERROR_CONFIG_NOT_FOUND)
+        {
+            err = deleteErr;
+        }
+    }
+
+    return err;
+}
@@ -31,6 +31,7 @@
 #include <mbedtls/threading.h>
 #include <openthread/heap.h>
 
+#include <new>
 #include <stdbool.h>
 #include <stdint.h>
 
@@ -60,7 +61,9 @@ typedef struct ButtonArray
 } ButtonArray_t;
 
 static const ButtonArray_t sButtonArray[PLATFORM_BUTTONS_COUNT] = BSP_BUTTON_INIT; // GPIO info for the 2 WDTK buttons.
-TimerHandle_t buttonTimers[PLATFORM_BUTTONS_COUNT]; // FreeRTOS timers used for debouncing buttons.
+
+// Storage for the platform LEDs (constructed in place, never freed).
+alignas(Efr32LED) static uint8_t sPlatformLEDStorage[PLATFORM_LEDS_COUNT][sizeof(Efr32LED)];
 
 // ================================================================================
 // App Error
@@ -123,7 +126,7 @@ void HardwarePlatform::InitLEDs(void)
 
     for (uint8_t i = 0; i < PLATFORM_LEDS_COUNT; i++)
     {
-         mLEDs[i].Init(new Efr32LED(i));
+        mLEDs[i].Init(new (sPlatformLEDStorage[i]) Efr32LED(i));
     }
 }
 
@@ -140,22 +143,20 @@ int HardwarePlatform::InitButtons(void)
 {
     EFR32_LOG("InitButtons()");
 
-    ButtonGpioInit();
-
     for (uint8_t i = 0; i < PLATFORM_BUTTONS_COUNT; i++)
     {
-        mButtons[0].Init();
-
-        // Create FreeRTOS sw timer for debouncing the button.
-        buttonTimers[i] =
-            xTimerCreate("BtnTmr",                      // Just a text name, not used by the RTOS kernel
-                         PLATFORM_BUTTON_DEBOUNCE_PERIOD_MS, // timer period
-                         false,                         // no timer reload (==one-shot)
-                         (void *)(int)i,                // init timer id = button index
-                         ButtonDebounceTimerCallback    // timer callback handler (all buttons use the same timer cn function)
-            );
+        mButtons[i].Init();
     }
 
+    // Debouncing is done from the GPIO interrupt (see ButtonDebouncer.h).
+    int ret = mButtonDebouncer.Init(mButtons, PLATFORM_BUTTONS_COUNT, PLATFORM_BUTTON_DEBOUNCE_PERIOD_MS, ReadButton);
+    if (ret != 0)
+    {
+        return ret;
+    }
+
+    ButtonGpioInit();
+
     return 0;
 }
 
@@ -185,7 +186,7 @@ void HardwarePlatform::Button0Isr(uint8_t pin)
 
     if (pin == sButtonArray[btnIdx].pin)
     {
-        ButtonEventHelper(btnIdx, true); // true== 'isr context'
+        GetHardwarePlatform().mButtonDebouncer.OnEdgeFromISR(btnIdx, ReadButton(btnIdx));
     }
 }
 
@@ -196,79 +197,14 @@ void HardwarePlatform::Button1Isr(uint8_t pin)
 
     if (pin == sButtonArray[btnIdx].pin)
     {
-        ButtonEventHelper(btnIdx, true); // true== 'isr context'
-    }
-}
-
-void HardwarePlatform::ButtonEventHelper(uint8_t btnIdx, bool isrContext)
-{
-    // May be called from Interrupt context so keep it short!
-
-    if (btnIdx < PLATFORM_BUTTONS_COUNT)
-    {
-        if (isrContext)
-        {
-            portBASE_TYPE taskWoken = pdFALSE; // For FreeRTOS timer (below).
-
-            // Start/restart the button debounce timer (Note ISR version of FreeRTOS api call here).
-            xTimerStartFromISR(buttonTimers[btnIdx], &taskWoken);
-            if (taskWoken != pdFALSE)
-            {
-                taskYIELD();
-            }
-        }
-        else
-        {
-            // Called by debounce timer expiry (button gpio pin is now stable).
-
-            // Get button gpio pin state.
-            bool pressed = !GPIO_PinInGet(sButtonArray[btnIdx].port, sButtonArray[btnIdx].pin);
-
-            // Notify App task of button state change.
-            ButtonHwEventHandler(btnIdx, pressed);
-        }
+        GetHardwarePlatform().mButtonDebouncer.OnEdgeFromISR(btnIdx, ReadButton(btnIdx));
     }
 }
 
-void HardwarePlatform::ButtonDebounceTimerCallback(TimerHandle_t xTimer)
+bool HardwarePlatform::ReadButton(uint8_t btnIdx)
 {
-    // Get the timerId of the expired timer and call button event helper.
-
-    uint32_t timerId;
-
-    timerId = (uint32_t)pvTimerGetTimerID(xTimer);
-    if (timerId < PLATFORM_BUTTONS_COUNT)
-    {
-        uint8_t btnIdx = timerId;
-        ButtonEventHelper(btnIdx, false); // false== 'not from isr context'
-    }
-}
-
-/**
- * Event handler called for every (debounced) hw platform button event.
- */
-void HardwarePlatform::ButtonHwEventHandler(uint8_t buttonIndex, bool pressed)
-{
-    HardwarePlatform & _this = GetHardwarePlatform();
-    Button::PhysicalButtonAction action;
-
-    if (pressed)
-    {
-        action = Button::kPhysicalButtonAction_Press;
-    }
-    else
-    {
-        action = Button::kPhysicalButtonAction_Release;
-    }
-    Button::PhysicalButtonAppTaskEventData appTaskEventData;
-    appTaskEventData.Action    = action;
-    appTaskEventData.ButtonPtr = &_this.mButtons[buttonIndex];
-
-    // We go through the AppTask so that the event is handled within that task.
-    AppTask::AppTaskEvent appTaskEvent;
-    appTaskEvent.Handler = Button::PhysicalButtonEventHandler;
-    appTaskEvent.Data    = &appTaskEventData;
-    GetAppTask().PostEvent(&appTaskEvent);
+    // Buttons are active low.
+    return !GPIO_PinInGet(sButtonArray[btnIdx].port, sButtonArray[btnIdx].pin);
 }
 
 Button * HardwarePlatform::GetButtons(void)
@@ -18,6 +18,11 @@
 
 #include "app_timer.h"
 
+#if APP_USE_STATIC_ALLOCATION
+static StaticTimer_t sTimerPool[APP_TIMER_STATIC_POOL_SIZE];
+static uint8_t sTimerPoolUsed;
+#endif
+
 ret_code_t app_timer_init(void)
 {
     // Provided for efr32 build compatibility.
@@ -27,12 +32,22 @@ ret_code_t app_timer_init(void)
 
 ret_code_t app_timer_create(xTimerHandle *handle, uint8_t timerMode, void (* timerEventHandler)(void * context))
 {
+#if APP_USE_STATIC_ALLOCATION
+    // Timers are never deleted, so the pool is simply handed out in order.
+    if (sTimerPoolUsed >= APP_TIMER_STATIC_POOL_SIZE)
+    {
+        return 1;  // Error.
+    }
+    *handle = xTimerCreateStatic("tmr", 1, false, NULL, (TimerCallbackFunction_t)timerEventHandler,
+                                 &sTimerPool[sTimerPoolUsed++]);
+#else
     *handle = xTimerCreate("tmr",   // Just a text name, not used by the RTOS kernel.
                            1,       // == default timer period (mS).
                            false,   // no timer reload (==one-shot).
                            NULL,    // timerId context = NULL.
                            (TimerCallbackFunction_t)timerEventHandler  // timer callback fn.
     );
+#endif
 
     if (*handle == NULL)
     {
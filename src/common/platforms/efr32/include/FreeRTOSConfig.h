@@ -159,6 +159,12 @@ runs at 32768/8=4096Hz.  Ensure the tick rate is a multiple of the clock. */
 #define configTIMER_QUEUE_LENGTH (10)
 #define configTIMER_TASK_STACK_DEPTH (configMINIMAL_STACK_SIZE)
 
+/* Static allocation of the application's kernel objects (build option). */
+#ifndef APP_USE_STATIC_ALLOCATION
+#define APP_USE_STATIC_ALLOCATION (0)
+#endif
+#define configSUPPORT_STATIC_ALLOCATION APP_USE_STATIC_ALLOCATION
+
 /* Cortex-M specific definitions. */
 #ifdef __NVIC_PRIO_BITS
 /* __BVIC_PRIO_BITS will be specified when CMSIS is being used. */
@@ -33,6 +33,7 @@
 
 #include "LED.h"
 #include "Button.h"
+#include "ButtonDebouncer.h"
 
 #define PLATFORM_LEDS_COUNT                  BSP_LED_COUNT
 #define PLATFORM_BUTTONS_COUNT               BSP_BUTTON_COUNT
@@ -65,15 +66,14 @@ public:
 private:
     LED mLEDs[PLATFORM_LEDS_COUNT];
     Button mButtons[PLATFORM_BUTTONS_COUNT];
+    ButtonDebouncer mButtonDebouncer;
 
     void InitLEDs(void);
     int InitButtons(void);
     void ButtonGpioInit(void);
     static void Button0Isr(uint8_t pin);
     static void Button1Isr(uint8_t pin);
-    static void ButtonEventHelper(uint8_t btnIdx, bool isrContext);
-    static void ButtonDebounceTimerCallback(TimerHandle_t xTimer);
-    static void ButtonHwEventHandler(uint8_t buttonIndex, bool pressed);
+    static bool ReadButton(uint8_t btnIdx);
 
     // Singleton.
     friend HardwarePlatform & GetHardwarePlatform(void);
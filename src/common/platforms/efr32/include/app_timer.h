@@ -29,6 +29,11 @@ typedef uint32_t ret_code_t;
 
 #define APP_TIMER_MODE_SINGLE_SHOT 0
 
+// Number of timers app_timer_create() can hand out with APP_USE_STATIC_ALLOCATION.
+#ifndef APP_TIMER_STATIC_POOL_SIZE
+#define APP_TIMER_STATIC_POOL_SIZE 4
+#endif
+
 ret_code_t app_timer_init(void);
 
 ret_code_t app_timer_create(xTimerHandle *handle, uint8_t timerMode, void (* timerEventHandler)(void * context));
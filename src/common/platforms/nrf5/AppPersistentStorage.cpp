@@ -0,0 +1,70 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ * @file
+ *   Application records of the nRF5 platform, one FDS record per record.
+ *
+ *   The records live in an FDS file of their own and go through NRF5Config,
+ *   which serializes the asynchronous FDS operations with the Weave
+ *   configuration ones.
+ */
+
+#include "AppPersistentStorage.h"
+
+#include <Weave/DeviceLayer/nRF5/NRF5Config.h>
+
+using namespace ::nl::Weave::DeviceLayer::Internal;
+
+// FDS file of the records, next to the Weave configuration files (0x235A - 0x235C).
+#ifndef NRF5_APP_STORAGE_FDS_FILE_ID
+#define NRF5_APP_STORAGE_FDS_FILE_ID 0x235E
+#endif
+
+static inline NRF5Config::Key GetRecordKey(unsigned id)
+{
+    // FDS record keys start at 1, as the record ids do.
+    return NRF5Config::NRF5ConfigKey(NRF5_APP_STORAGE_FDS_FILE_ID, id);
+}
+
+WEAVE_ERROR AppPersistentStorage::Read(RecordId id, void * buf, size_t bufSize, size_t & readLen)
+{
+    return NRF5Config::ReadConfigValueBin(GetRecordKey(id), static_cast<uint8_t *>(buf), bufSize, readLen);
+}
+
+WEAVE_ERROR AppPersistentStorage::Write(RecordId id, const void * data, size_t dataLen)
+{
+    return NRF5Config::WriteConfigValueBin(GetRecordKey(id), static_cast<const uint8_t *>(data), dataLen);
+}
+
+WEAVE_ERROR AppPersistentStorage::EraseAll(void)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+    for (unsigned id = 1; id <= kRecordId_Max; id++)
+    {
+        WEAVE_ERROR clearErr = NRF5Config::ClearConfigValue(GetRecordKey(id));
+
+        if (clearErr != WEAVE_NO_ERROR && clearErr != WEAVE_DEVICE_ERROR_CONFIG_NOT_FOUND)
+        {
+            err = clearErr;
+        }
+    }
+
+    return err;
+}
@@ -27,15 +27,15 @@
 #include "AppTask.h"
 #include "Nrf5LED.h"
 
+#include <new>
 #include <stdbool.h>
 #include <stdint.h>
 
 //#include "boards.h"
-//#include "app_button.h"
 
 #include "nrf_log.h"
 #include "nrf_delay.h"
-#include "app_button.h"
+#include "nrf_drv_gpiote.h"
 
 #ifdef SOFTDEVICE_PRESENT
 #include "nrf_sdh.h"
@@ -89,6 +89,9 @@ using namespace ::nl::Weave::DeviceLayer;
 
 // FIXME: extern "C" size_t GetHeapTotalSize(void);
 
+// Storage for the platform LEDs (constructed in place, never freed).
+alignas(Nrf5LED) static uint8_t sPlatformLEDStorage[PLATFORM_LEDS_COUNT][sizeof(Nrf5LED)];
+
 // ================================================================================
 // Logging Support
 // ================================================================================
@@ -287,10 +290,10 @@ void HardwarePlatform::InitLEDs(void)
     nrf_gpio_cfg_output(BSP_LED_2);
     nrf_gpio_cfg_output(BSP_LED_3);
 
-    mLEDs[0].Init(new Nrf5LED(BSP_LED_0));
-    mLEDs[1].Init(new Nrf5LED(BSP_LED_1));
-    mLEDs[2].Init(new Nrf5LED(BSP_LED_2));
-    mLEDs[3].Init(new Nrf5LED(BSP_LED_3));
+    mLEDs[0].Init(new (sPlatformLEDStorage[0]) Nrf5LED(BSP_LED_0));
+    mLEDs[1].Init(new (sPlatformLEDStorage[1]) Nrf5LED(BSP_LED_1));
+    mLEDs[2].Init(new (sPlatformLEDStorage[2]) Nrf5LED(BSP_LED_2));
+    mLEDs[3].Init(new (sPlatformLEDStorage[3]) Nrf5LED(BSP_LED_3));
 }
 
 // -----------------------------------------------------------------------------
@@ -301,36 +304,37 @@ int HardwarePlatform::InitButtons(void)
 {
     int ret;
 
-    static app_button_cfg_t sButtons[] = {
-        { BUTTON_1, APP_BUTTON_ACTIVE_LOW, BUTTON_PULL, HardwarePlatform::ButtonHwEventHandler },
-        { BUTTON_2, APP_BUTTON_ACTIVE_LOW, BUTTON_PULL, HardwarePlatform::ButtonHwEventHandler },
-        { BUTTON_3, APP_BUTTON_ACTIVE_LOW, BUTTON_PULL, HardwarePlatform::ButtonHwEventHandler },
-        { BUTTON_4, APP_BUTTON_ACTIVE_LOW, BUTTON_PULL, HardwarePlatform::ButtonHwEventHandler },
-    };
+    mButtonPinNos[0] = BUTTON_1;
+    mButtonPinNos[1] = BUTTON_2;
+    mButtonPinNos[2] = BUTTON_3;
+    mButtonPinNos[3] = BUTTON_4;
 
-    ret = app_button_init(sButtons, ARRAY_SIZE(sButtons), pdMS_TO_TICKS(PLATFORM_BUTTON_DEBOUNCE_PERIOD_MS));
-    if (ret != NRF_SUCCESS)
+    for (int i = 0; i < PLATFORM_BUTTONS_COUNT; i++)
     {
-        NRF_LOG_INFO("app_button_init() failed");
-        VerifyOrExit(ret == NRF_SUCCESS, );
+        mButtons[i].Init();
     }
 
-    ret = app_button_enable();
-    if (ret != NRF_SUCCESS)
+    // Debouncing is done from the GPIOTE interrupt (see ButtonDebouncer.h).
+    ret = mButtonDebouncer.Init(mButtons, PLATFORM_BUTTONS_COUNT, PLATFORM_BUTTON_DEBOUNCE_PERIOD_MS, ReadButton);
+    VerifyOrExit(ret == 0, NRF_LOG_INFO("ButtonDebouncer init failed"));
+
+    if (!nrf_drv_gpiote_is_init())
     {
-        NRF_LOG_INFO("app_button_enable() failed");
-        VerifyOrExit(ret == NRF_SUCCESS, );
+        ret = nrf_drv_gpiote_init();
+        VerifyOrExit(ret == NRF_SUCCESS, NRF_LOG_INFO("nrf_drv_gpiote_init() failed"));
     }
 
     for (int i = 0; i < PLATFORM_BUTTONS_COUNT; i++)
     {
-        mButtons[0].Init();
-    }
+        // Port event (low power): sense both edges.
+        nrf_drv_gpiote_in_config_t config = GPIOTE_CONFIG_IN_SENSE_TOGGLE(false);
+        config.pull                       = BUTTON_PULL;
 
-    mButtonPinNos[0] = BUTTON_1;
-    mButtonPinNos[1] = BUTTON_2;
-    mButtonPinNos[2] = BUTTON_3;
-    mButtonPinNos[3] = BUTTON_4;
+        ret = nrf_drv_gpiote_in_init(mButtonPinNos[i], &config, ButtonGpioteHandler);
+        VerifyOrExit(ret == NRF_SUCCESS, NRF_LOG_INFO("nrf_drv_gpiote_in_init() failed"));
+
+        nrf_drv_gpiote_in_event_enable(mButtonPinNos[i], true);
+    }
 
 exit:
     return ret;
@@ -350,35 +354,25 @@ int HardwarePlatform::GetButtonIndex(uint8_t pinNo)
             return i;
         }
     }
-    // FIXME: proper error handling
-    NRF_LOG_ERROR("ERROR: no button associated with pinNo [%d]", pinNo);
     return -1;
 }
 
+bool HardwarePlatform::ReadButton(uint8_t buttonIndex)
+{
+    // Buttons are active low.
+    return !nrf_drv_gpiote_in_is_set(GetHardwarePlatform().mButtonPinNos[buttonIndex]);
+}
+
 /**
- * Event handler called for every hw platform button event.
+ * GPIOTE interrupt handler, called for every edge on a button pin.
  */
-void HardwarePlatform::ButtonHwEventHandler(uint8_t pin_no, uint8_t button_action)
+void HardwarePlatform::ButtonGpioteHandler(nrf_drv_gpiote_pin_t pin, nrf_gpiote_polarity_t action)
 {
     HardwarePlatform & _this = GetHardwarePlatform();
-    int buttonIndex          = _this.GetButtonIndex(pin_no);
-    Button::PhysicalButtonAction action;
+    int buttonIndex          = _this.GetButtonIndex(pin);
 
-    if (button_action == APP_BUTTON_PUSH)
-    {
-        action = Button::kPhysicalButtonAction_Press;
-    }
-    else if (button_action == APP_BUTTON_RELEASE)
+    if (buttonIndex >= 0)
     {
-        action = Button::kPhysicalButtonAction_Release;
+        _this.mButtonDebouncer.OnEdgeFromISR(buttonIndex, ReadButton(buttonIndex));
     }
-    Button::PhysicalButtonAppTaskEventData appTaskEventData;
-    appTaskEventData.Action    = action;
-    appTaskEventData.ButtonPtr = &_this.mButtons[buttonIndex];
-
-    // We go through the AppTask so that the event is handled within that task.
-    AppTask::AppTaskEvent appTaskEvent;
-    appTaskEvent.Handler = Button::PhysicalButtonEventHandler;
-    appTaskEvent.Data    = &appTaskEventData;
-    GetAppTask().PostEvent(&appTaskEvent);
 }
@@ -89,6 +89,12 @@
 /* */
 #define configSUPPORT_DYNAMIC_ALLOCATION 1
 
+/* Static allocation of the application's kernel objects (build option). */
+#ifndef APP_USE_STATIC_ALLOCATION
+#define APP_USE_STATIC_ALLOCATION 0
+#endif
+#define configSUPPORT_STATIC_ALLOCATION APP_USE_STATIC_ALLOCATION
+
 /* Debugging support. */
 #define configINCLUDE_FREERTOS_TASK_C_ADDITIONS_H 1
 #define configUSE_TRACE_FACILITY 1
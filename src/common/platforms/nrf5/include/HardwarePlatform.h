@@ -26,7 +26,9 @@
 
 #include "LED.h"
 #include "Button.h"
+#include "ButtonDebouncer.h"
 #include "boards.h"
+#include "nrf_drv_gpiote.h"
 
 #define PLATFORM_LEDS_COUNT LEDS_NUMBER
 #define PLATFORM_BUTTONS_COUNT BUTTONS_NUMBER
@@ -58,12 +60,14 @@ private:
     LED mLEDs[PLATFORM_LEDS_COUNT];
     Button mButtons[PLATFORM_BUTTONS_COUNT];
     uint8_t mButtonPinNos[PLATFORM_BUTTONS_COUNT];
+    ButtonDebouncer mButtonDebouncer;
 
     // Initialize GPIO artifacts.
     void InitLEDs(void);
     int InitButtons(void);
 
-    static void ButtonHwEventHandler(uint8_t pin_no, uint8_t button_action);
+    static void ButtonGpioteHandler(nrf_drv_gpiote_pin_t pin, nrf_gpiote_polarity_t action);
+    static bool ReadButton(uint8_t buttonIndex);
     int GetButtonIndex(uint8_t pinNo);
 
     // Singleton.
@@ -106,10 +106,11 @@
 #define NRF_STRERROR_ENABLED 1
 #define NRF_QUEUE_ENABLED 1
 #define APP_TIMER_ENABLED 1
-#define BUTTON_ENABLED 1
 
+// Buttons are handled directly by the GPIOTE driver (see ButtonDebouncer.h).
 #define GPIOTE_ENABLED 1
 #define GPIOTE_CONFIG_NUM_OF_LOW_POWER_EVENTS 4
+#define GPIOTE_CONFIG_IRQ_PRIORITY 6
 
 #define APP_TIMER_CONFIG_OP_QUEUE_SIZE 10
 
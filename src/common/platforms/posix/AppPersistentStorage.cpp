@@ -0,0 +1,111 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ * @file
+ *   Application records of the posix platform, one file per record.
+ */
+
+#include "AppPersistentStorage.h"
+#include "app.h"
+
+#include <errno.h>
+#include <stdio.h>
+
+// Directory of the record files. Files are named after the application so
+// that the lock and the sensor can run side by side.
+#ifndef POSIX_APP_STORAGE_DIR
+#define POSIX_APP_STORAGE_DIR "/tmp"
+#endif
+
+#define POSIX_APP_STORAGE_PATH_MAX_LEN 256
+
+static void GetRecordPath(AppPersistentStorage::RecordId id, char * path, const char * suffix)
+{
+    snprintf(path, POSIX_APP_STORAGE_PATH_MAX_LEN, "%s/%s-record-%02x%s", POSIX_APP_STORAGE_DIR, APP_NAME, (unsigned) id,
+             suffix);
+}
+
+WEAVE_ERROR AppPersistentStorage::Read(RecordId id, void * buf, size_t bufSize, size_t & readLen)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    char path[POSIX_APP_STORAGE_PATH_MAX_LEN];
+    FILE * file;
+
+    GetRecordPath(id, path, "");
+
+    file = fopen(path, "rb");
+    VerifyOrExit(file != NULL, err = (errno == ENOENT) ? WEAVE_DEVICE_ERROR_CONFIG_NOT_FOUND : WEAVE_ERROR_PERSISTED_STORAGE_FAIL);
+
+    readLen = fread(buf, 1, bufSize, file);
+    if (ferror(file))
+    {
+        err = WEAVE_ERROR_PERSISTED_STORAGE_FAIL;
+    }
+    else if (fgetc(file) != EOF)
+    {
+        err = WEAVE_ERROR_BUFFER_TOO_SMALL;
+    }
+    fclose(file);
+
+exit:
+    return err;
+}
+
+WEAVE_ERROR AppPersistentStorage::Write(RecordId id, const void * data, size_t dataLen)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    char path[POSIX_APP_STORAGE_PATH_MAX_LEN];
+    char tmpPath[POSIX_APP_STORAGE_PATH_MAX_LEN];
+    FILE * file;
+    bool written;
+
+    GetRecordPath(id, path, "");
+    GetRecordPath(id, tmpPath, ".tmp");
+
+    // Write a temporary file and rename it, so that an interrupted write
+    // leaves the previous record in place.
+    file = fopen(tmpPath, "wb");
+    VerifyOrExit(file != NULL, err = WEAVE_ERROR_PERSISTED_STORAGE_FAIL);
+
+    written = (fwrite(data, 1, dataLen, file) == dataLen);
+    written = (fclose(file) == 0) && written;
+    VerifyOrExit(written, err = WEAVE_ERROR_PERSISTED_STORAGE_FAIL);
+
+    VerifyOrExit(rename(tmpPath, path) == 0, err = WEAVE_ERROR_PERSISTED_STORAGE_FAIL);
+
+exit:
+    return err;
+}
+
+WEAVE_ERROR AppPersistentStorage::EraseAll(void)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    char path[POSIX_APP_STORAGE_PATH_MAX_LEN];
+
+    for (unsigned id = 1; id <= kRecordId_Max; id++)
+    {
+        GetRecordPath(static_cast<RecordId>(id), path, "");
+        if (remove(path) != 0 && errno != ENOENT)
+        {
+            err = WEAVE_ERROR_PERSISTED_STORAGE_FAIL;
+        }
+    }
+
+    return err;
+}
@@ -0,0 +1,313 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ * @file
+ *   This file implements posix (host) platform specific functionality.
+ */
+
+#include "HardwarePlatform.h"
+#include "app.h"
+#include "Button.h"
+#include "AppTask.h"
+#include "PosixLED.h"
+#include "GenericWDMFeature.h"
+
+#include <inttypes.h>
+#include <new>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/select.h>
+#include <unistd.h>
+
+#include <task.h>
+
+#define POSIX_LOG(...)       \
+    do                       \
+    {                        \
+        printf(__VA_ARGS__); \
+        printf("\n");        \
+        fflush(stdout);      \
+    } while (0)
+
+#define CONSOLE_TASK_STACK_SIZE (16384)
+#define CONSOLE_TASK_PRIORITY 1
+#define CONSOLE_LINE_MAX_LEN 64
+
+// Singleton.
+HardwarePlatform HardwarePlatform::sHardwarePlatform;
+
+static TaskHandle_t sConsoleTaskHandle;
+
+// Storage for the platform LEDs (constructed in place, never freed).
+alignas(PosixLED) static uint8_t sPlatformLEDStorage[PLATFORM_LEDS_COUNT][sizeof(PosixLED)];
+
+void HardwarePlatform::Init(void)
+{
+    // Make sure log output is not lost if the process is killed.
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    POSIX_LOG("==================================================");
+    POSIX_LOG(APP_NAME);
+    POSIX_LOG("Hardware Platform: POSIX");
+#if BUILD_RELEASE
+    POSIX_LOG("*** PSEUDO-RELEASE BUILD ***");
+#else
+    POSIX_LOG("*** DEVELOPMENT BUILD ***");
+#endif
+    POSIX_LOG("==================================================");
+
+    InitLEDs();
+
+    InitButtons();
+
+    if (StartConsoleTask() != 0)
+    {
+        POSIX_LOG("Failed to start the console task, buttons can only be injected programmatically");
+    }
+}
+
+void HardwarePlatform::InitLEDs(void)
+{
+    POSIX_LOG("InitLEDS()");
+
+    for (uint8_t i = 0; i < PLATFORM_LEDS_COUNT; i++)
+    {
+        mPosixLEDs[i] = new (sPlatformLEDStorage[i]) PosixLED(i);
+        mLEDs[i].Init(mPosixLEDs[i]);
+    }
+}
+
+LED * HardwarePlatform::GetLEDs(void)
+{
+    return mLEDs;
+}
+
+PosixLED * HardwarePlatform::GetPosixLED(uint8_t ledIndex)
+{
+    if (ledIndex >= PLATFORM_LEDS_COUNT)
+    {
+        return NULL;
+    }
+
+    return mPosixLEDs[ledIndex];
+}
+
+// -----------------------------------------------------------------------------
+// Buttons
+
+// Initialize buttons
+int HardwarePlatform::InitButtons(void)
+{
+    POSIX_LOG("InitButtons()");
+
+    for (uint8_t i = 0; i < PLATFORM_BUTTONS_COUNT; i++)
+    {
+        mButtons[i].Init();
+    }
+
+    return 0;
+}
+
+void HardwarePlatform::InjectButtonEvent(uint8_t buttonIndex, bool pressed)
+{
+    if (buttonIndex < PLATFORM_BUTTONS_COUNT)
+    {
+        // Simulated buttons do not bounce, so the event is reported right away.
+        ButtonHwEventHandler(buttonIndex, pressed);
+    }
+}
+
+/**
+ * Event handler called for every (simulated) hw platform button event.
+ */
+void HardwarePlatform::ButtonHwEventHandler(uint8_t buttonIndex, bool pressed)
+{
+    HardwarePlatform & _this = GetHardwarePlatform();
+    Button::PhysicalButtonAction action;
+
+    if (pressed)
+    {
+        action = Button::kPhysicalButtonAction_Press;
+    }
+    else
+    {
+        action = Button::kPhysicalButtonAction_Release;
+    }
+    Button::PhysicalButtonAppTaskEventData appTaskEventData;
+    appTaskEventData.Action    = action;
+    appTaskEventData.ButtonPtr = &_this.mButtons[buttonIndex];
+    appTaskEventData.EdgeTick  = xTaskGetTickCount();
+
+    // We go through the AppTask so that the event is handled within that task.
+    // The event data is copied into the event.
+    GetAppTask().PostEvent(Button::PhysicalButtonEventHandler, appTaskEventData);
+}
+
+Button * HardwarePlatform::GetButtons(void)
+{
+    return mButtons;
+}
+
+// -----------------------------------------------------------------------------
+// Console
+
+int HardwarePlatform::StartConsoleTask(void)
+{
+    if (xTaskCreate(ConsoleTaskMain, "CON", CONSOLE_TASK_STACK_SIZE / sizeof(StackType_t), NULL, CONSOLE_TASK_PRIORITY,
+                    &sConsoleTaskHandle) != pdPASS)
+    {
+        return 1;
+    }
+
+    return 0;
+}
+
+// stdin is polled rather than read in a blocking manner: a FreeRTOS task that
+// blocks in a system call would stall the FreeRTOS posix port scheduler.
+void HardwarePlatform::ConsoleTaskMain(void * pvParameter)
+{
+    char line[CONSOLE_LINE_MAX_LEN];
+    size_t lineLen = 0;
+
+    while (true)
+    {
+        fd_set readFds;
+        struct timeval timeout = { 0, 0 };
+
+        FD_ZERO(&readFds);
+        FD_SET(STDIN_FILENO, &readFds);
+
+        if (select(STDIN_FILENO + 1, &readFds, NULL, NULL, &timeout) > 0)
+        {
+            char c;
+            ssize_t len = read(STDIN_FILENO, &c, 1);
+
+            if (len <= 0)
+            {
+                // stdin was closed (e.g. running detached); stop polling it.
+                vTaskDelete(NULL);
+            }
+            else if (c == '\n' || c == '\r')
+            {
+                line[lineLen] = '\0';
+                if (lineLen > 0)
+                {
+                    HandleConsoleCommand(line);
+                }
+                lineLen = 0;
+            }
+            else if (lineLen < sizeof(line) - 1)
+            {
+                line[lineLen++] = c;
+            }
+
+            // More input may be pending.
+            continue;
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(POSIX_CONSOLE_POLL_INTERVAL_MS));
+    }
+}
+
+/**
+ * Console commands:
+ *   press <button>     Presses (and holds) a button.
+ *   release <button>   Releases a button.
+ *   click <button>     Presses then releases a button.
+ *   leds               Dumps the recorded LED transitions.
+ *   rtt                Prints the round-trip time statistics of the service.
+ *   connect            Prints the time taken to connect to the service.
+ */
+void HardwarePlatform::HandleConsoleCommand(char * line)
+{
+    HardwarePlatform & _this = GetHardwarePlatform();
+    char * command           = strtok(line, " \t");
+    char * arg               = strtok(NULL, " \t");
+    uint8_t buttonIndex      = (arg != NULL) ? (uint8_t) atoi(arg) : 0;
+
+    // A line of blanks only.
+    if (command == NULL)
+    {
+        return;
+    }
+
+    if (strcmp(command, "press") == 0)
+    {
+        _this.InjectButtonEvent(buttonIndex, true);
+    }
+    else if (strcmp(command, "release") == 0)
+    {
+        _this.InjectButtonEvent(buttonIndex, false);
+    }
+    else if (strcmp(command, "click") == 0)
+    {
+        _this.InjectButtonEvent(buttonIndex, true);
+        vTaskDelay(pdMS_TO_TICKS(POSIX_BUTTON_CLICK_DURATION_MS));
+        _this.InjectButtonEvent(buttonIndex, false);
+    }
+    else if (strcmp(command, "leds") == 0)
+    {
+        for (uint8_t i = 0; i < PLATFORM_LEDS_COUNT; i++)
+        {
+            _this.mPosixLEDs[i]->DumpHistory();
+        }
+    }
+    else if (strcmp(command, "rtt") == 0)
+    {
+        RttEstimator::Stats stats;
+
+        WDMFeatureBase::GetBaseInstance().GetServiceRttStats(stats);
+        POSIX_LOG("Service RTT: %" PRIu32 " samples (%" PRIu32 " discarded, %" PRIu32 " backoffs), last %" PRIu32
+                  " ms, min %" PRIu32 " ms, max %" PRIu32 " ms",
+                  stats.SampleCount, stats.DiscardedCount, stats.BackoffCount, stats.LastRttMs,
+                  (stats.SampleCount != 0) ? stats.MinRttMs : 0, stats.MaxRttMs);
+        POSIX_LOG("Service RTT: srtt %" PRIu32 " ms, rttvar %" PRIu32 " ms, retrans timeout %" PRIu32 " ms", stats.SrttMs,
+                  stats.RttVarMs, stats.RetransTimeoutMs);
+    }
+    else if (strcmp(command, "connect") == 0)
+    {
+        WDMFeatureBase::ConnectStats stats;
+
+        WDMFeatureBase::GetBaseInstance().GetConnectStats(stats);
+        POSIX_LOG("Service connect: %" PRIu32 " ms from boot, %" PRIu32 " reattaches (last %" PRIu32 " ms, max %" PRIu32 " ms)",
+                  stats.BootToConnectedMs, stats.ReattachCount, stats.LastReattachToConnectedMs, stats.MaxReattachToConnectedMs);
+    }
+    else
+    {
+        POSIX_LOG("Commands: press <button> | release <button> | click <button> | leds | rtt | connect");
+    }
+}
+
+// -----------------------------------------------------------------------------
+// FreeRTOS hooks
+
+extern "C" void vApplicationMallocFailedHook(void)
+{
+    POSIX_LOG("!!!!!!!!!!!! malloc failed !!!!!!!!!!!");
+    abort();
+}
+
+extern "C" void vAssertCalled(const char * const pcFileName, unsigned long ulLine)
+{
+    POSIX_LOG("!!!!!!!!!!!! FreeRTOS assert at %s:%lu !!!!!!!!!!!", pcFileName, ulLine);
+    abort();
+}
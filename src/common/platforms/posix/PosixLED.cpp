@@ -0,0 +1,86 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "PosixLED.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <time.h>
+
+static uint64_t GetMonotonicUS(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t) ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+}
+
+PosixLED::PosixLED(uint32_t aLEDId)
+{
+    mLEDId           = aLEDId;
+    mTransitionCount = 0;
+}
+
+void PosixLED::On()
+{
+    RecordTransition(true);
+}
+
+void PosixLED::Off()
+{
+    RecordTransition(false);
+}
+
+void PosixLED::RecordTransition(bool on)
+{
+    Transition & transition = mHistory[mTransitionCount % POSIX_LED_HISTORY_SIZE];
+    transition.TimestampUS  = GetMonotonicUS();
+    transition.On           = on;
+    mTransitionCount++;
+}
+
+uint32_t PosixLED::GetTransitionCount(void) const
+{
+    return mTransitionCount;
+}
+
+bool PosixLED::GetTransition(uint32_t n, Transition & aTransition) const
+{
+    if (n >= mTransitionCount || n >= POSIX_LED_HISTORY_SIZE)
+    {
+        return false;
+    }
+
+    aTransition = mHistory[(mTransitionCount - 1 - n) % POSIX_LED_HISTORY_SIZE];
+    return true;
+}
+
+void PosixLED::DumpHistory(void) const
+{
+    Transition transition;
+
+    printf("LED %" PRIu32 ": %" PRIu32 " transitions\n", mLEDId, mTransitionCount);
+
+    // Oldest first.
+    for (uint32_t n = POSIX_LED_HISTORY_SIZE; n > 0; n--)
+    {
+        if (GetTransition(n - 1, transition))
+        {
+            printf("  %" PRIu64 " us: %s\n", transition.TimestampUS, transition.On ? "ON" : "OFF");
+        }
+    }
+}
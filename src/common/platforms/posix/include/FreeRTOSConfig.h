@@ -0,0 +1,127 @@
+/*
+ * FreeRTOS Kernel V10.2.1
+ * Copyright (C) 2019 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+#include <limits.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*-----------------------------------------------------------
+ * Application specific definitions for the FreeRTOS posix port
+ * (portable/ThirdParty/GCC/Posix), used by the host build of the
+ * example applications.
+ *
+ * Every FreeRTOS task is backed by a pthread, hence the large minimal
+ * stack size.
+ *
+ * See http://www.freertos.org/a00110.html.
+ *----------------------------------------------------------*/
+
+#define configUSE_PREEMPTION (1)
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION (0)
+#define configUSE_TICKLESS_IDLE (0)
+#define configTICK_RATE_HZ (1000)
+#define configMAX_PRIORITIES (8)
+#define configMINIMAL_STACK_SIZE ((unsigned short) PTHREAD_STACK_MIN)
+#define configTOTAL_HEAP_SIZE ((size_t)(1024 * 1024))
+#define configMAX_TASK_NAME_LEN (12)
+#define configUSE_16_BIT_TICKS (0)
+#define configIDLE_SHOULD_YIELD (1)
+#define configUSE_TASK_NOTIFICATIONS (1)
+#define configUSE_MUTEXES (1)
+#define configUSE_RECURSIVE_MUTEXES (1)
+#define configUSE_COUNTING_SEMAPHORES (1)
+#define configUSE_ALTERNATIVE_API (0) /* Deprecated! */
+#define configQUEUE_REGISTRY_SIZE (10)
+#define configUSE_QUEUE_SETS (0)
+#define configUSE_TIME_SLICING (1)
+#define configUSE_NEWLIB_REENTRANT (0)
+#define configENABLE_BACKWARD_COMPATIBILITY (1)
+#define configSUPPORT_DYNAMIC_ALLOCATION (1)
+
+/* Static allocation of the application's kernel objects (build option). */
+#ifndef APP_USE_STATIC_ALLOCATION
+#define APP_USE_STATIC_ALLOCATION (0)
+#endif
+#define configSUPPORT_STATIC_ALLOCATION APP_USE_STATIC_ALLOCATION
+
+/* Hook function related definitions. */
+#define configUSE_IDLE_HOOK (0)
+#define configUSE_TICK_HOOK (0)
+#define configCHECK_FOR_STACK_OVERFLOW (0) /* Task stacks are pthread stacks, not checked by FreeRTOS. */
+#define configUSE_MALLOC_FAILED_HOOK (1)
+
+/* Run time and task stats gathering related definitions. */
+#define configGENERATE_RUN_TIME_STATS (0)
+#define configUSE_TRACE_FACILITY (0)
+
+/* Co-routine definitions. */
+#define configUSE_CO_ROUTINES (0)
+#define configMAX_CO_ROUTINE_PRIORITIES (1)
+
+/* Software timer definitions. */
+#define configUSE_TIMERS (1)
+#define configTIMER_TASK_PRIORITY (configMAX_PRIORITIES - 1) /* Highest priority */
+#define configTIMER_QUEUE_LENGTH (10)
+#define configTIMER_TASK_STACK_DEPTH (configMINIMAL_STACK_SIZE)
+
+/* Optional functions - most linkers will remove unused functions anyway. */
+#define INCLUDE_vTaskPrioritySet (1)
+#define INCLUDE_uxTaskPriorityGet (1)
+#define INCLUDE_vTaskDelete (1)
+#define INCLUDE_vTaskSuspend (1)
+#define INCLUDE_xResumeFromISR (1)
+#define INCLUDE_vTaskDelayUntil (1)
+#define INCLUDE_vTaskDelay (1)
+#define INCLUDE_xTaskGetSchedulerState (1)
+#define INCLUDE_xTaskGetCurrentTaskHandle (1)
+#define INCLUDE_uxTaskGetStackHighWaterMark (0)
+#define INCLUDE_xTaskGetIdleTaskHandle (1)
+#define INCLUDE_xTimerGetTimerDaemonTaskHandle (1)
+#define INCLUDE_pcTaskGetTaskName (1)
+#define INCLUDE_eTaskGetState (1)
+#define INCLUDE_xEventGroupSetBitFromISR (1)
+#define INCLUDE_xTimerPendFunctionCall (1)
+
+/* It is a good idea to define configASSERT() while developing.  configASSERT()
+uses the same semantics as the standard C assert() macro. */
+extern void vAssertCalled(const char * const pcFileName, unsigned long ulLine);
+#define configASSERT(x)                           \
+    if ((x) == 0)                                 \
+    {                                             \
+        vAssertCalled(__FILE__, __LINE__);        \
+    }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FREERTOS_CONFIG_H */
@@ -0,0 +1,101 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      APIs supported by all hardware platforms that run the example applications.
+ */
+
+#ifndef HARDWARE_PLATFORM_H
+#define HARDWARE_PLATFORM_H
+
+#include <FreeRTOS.h>
+#include <timers.h>
+
+#include "LED.h"
+#include "Button.h"
+#include "PosixLED.h"
+
+#define PLATFORM_LEDS_COUNT                  4
+#define PLATFORM_BUTTONS_COUNT               2
+#define PLATFORM_BUTTON_DEBOUNCE_PERIOD_MS   50
+
+// How long a "click" console command holds the simulated button down.
+#define POSIX_BUTTON_CLICK_DURATION_MS       100
+
+// How often the console task checks stdin for commands.
+#define POSIX_CONSOLE_POLL_INTERVAL_MS       50
+
+
+/**
+ * Posix host platform.
+ *
+ * LEDs are simulated by PosixLED, which records every transition. Buttons are
+ * simulated: there is no ISR and no bouncing, a button event is injected either
+ * programmatically (InjectButtonEvent) or from the console task that reads
+ * commands from stdin (see README.md).
+ */
+class HardwarePlatform
+{
+public:
+    /**
+     * Initialization of the hardware platform.
+     * Called from the application main().
+     */
+    void Init();
+
+    /** Returns an array of the LEDS available on the devkit. */
+    LED * GetLEDs();
+
+    /** Returns an array of the Buttons available on the devkit. */
+    Button * GetButtons();
+
+    /** Returns the simulated LED backing LED 'ledIndex' (NULL if out of range). */
+    PosixLED * GetPosixLED(uint8_t ledIndex);
+
+    /**
+     * Simulates a (debounced) physical button press or release.
+     * May be called from any FreeRTOS task.
+     */
+    void InjectButtonEvent(uint8_t buttonIndex, bool pressed);
+
+
+private:
+    LED mLEDs[PLATFORM_LEDS_COUNT];
+    Button mButtons[PLATFORM_BUTTONS_COUNT];
+    PosixLED * mPosixLEDs[PLATFORM_LEDS_COUNT];
+
+    void InitLEDs(void);
+    int InitButtons(void);
+    int StartConsoleTask(void);
+    static void ConsoleTaskMain(void * pvParameter);
+    static void HandleConsoleCommand(char * line);
+    static void ButtonHwEventHandler(uint8_t buttonIndex, bool pressed);
+
+    // Singleton.
+    friend HardwarePlatform & GetHardwarePlatform(void);
+    static HardwarePlatform sHardwarePlatform;
+};
+
+// Singleton.
+inline HardwarePlatform & GetHardwarePlatform(void)
+{
+    return HardwarePlatform::sHardwarePlatform;
+}
+
+#endif // HARDWARE_PLATFORM_H
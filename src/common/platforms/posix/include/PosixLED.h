@@ -0,0 +1,69 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#ifndef POSIX_LED_H
+#define POSIX_LED_H
+
+#include <stdint.h>
+
+#include "PlatformLED.h"
+
+// Number of on/off transitions remembered by each simulated LED.
+#define POSIX_LED_HISTORY_SIZE 64
+
+/**
+ * Simulated LED for the posix host platform.
+ *
+ * There is no hardware to drive, so every On()/Off() transition is recorded
+ * along with a monotonic timestamp. The history can be inspected (or dumped)
+ * to check LED behavior, e.g. blink rates, without a devkit.
+ */
+class PosixLED : public PlatformLED
+{
+public:
+    struct Transition
+    {
+        uint64_t TimestampUS;
+        bool On;
+    };
+
+    PosixLED(uint32_t ledId);
+    void On(void);
+    void Off(void);
+
+    /** Total number of transitions since boot (may exceed the history size). */
+    uint32_t GetTransitionCount(void) const;
+
+    /**
+     * Returns the n-th most recent transition (0 == latest).
+     * Returns false if that transition is no longer in the history.
+     */
+    bool GetTransition(uint32_t n, Transition & aTransition) const;
+
+    /** Prints the recorded history to stdout. */
+    void DumpHistory(void) const;
+
+private:
+    uint32_t mLEDId;
+    uint32_t mTransitionCount;
+    Transition mHistory[POSIX_LED_HISTORY_SIZE];
+
+    void RecordTransition(bool on);
+};
+
+#endif // POSIX_LED_H
@@ -0,0 +1,164 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      Unit test of RttEstimator: feeds round-trip samples, retransmissions
+ *      and timeouts through the estimator and checks the retransmission
+ *      timeout against RFC 6298. Built and run on the host with
+ *
+ *        $ make PLATFORM=posix check
+ */
+
+#include "RttEstimator.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+
+enum
+{
+    kMinTimeoutMs  = 100,
+    kMaxTimeoutMs  = 5000,
+    kGranularityMs = 10,
+};
+
+static int sFailureCount;
+
+#define CHECK_EQUAL(actual, expected)                                                                                              \
+    do                                                                                                                             \
+    {                                                                                                                              \
+        uint32_t actualValue   = (actual);                                                                                         \
+        uint32_t expectedValue = (expected);                                                                                       \
+        if (actualValue != expectedValue)                                                                                          \
+        {                                                                                                                          \
+            printf("%s:%d: %s is %" PRIu32 ", expected %" PRIu32 "\n", __FILE__, __LINE__, #actual, actualValue, expectedValue);   \
+            sFailureCount++;                                                                                                       \
+        }                                                                                                                          \
+    } while (0)
+
+static void TestInitialTimeout(void)
+{
+    RttEstimator estimator;
+    RttEstimator::Stats stats;
+
+    estimator.Init(kMinTimeoutMs, kMaxTimeoutMs, kGranularityMs);
+    estimator.GetStats(stats);
+
+    // The timeout is the maximum until the first sample.
+    CHECK_EQUAL(estimator.GetRetransTimeoutMs(), kMaxTimeoutMs);
+    CHECK_EQUAL(stats.RetransTimeoutMs, kMaxTimeoutMs);
+    CHECK_EQUAL(stats.SampleCount, 0);
+}
+
+static void TestSamples(void)
+{
+    RttEstimator estimator;
+    RttEstimator::Stats stats;
+
+    estimator.Init(kMinTimeoutMs, kMaxTimeoutMs, kGranularityMs);
+
+    // First sample: SRTT = R, RTTVAR = R / 2, RTO = SRTT + 4 * RTTVAR.
+    CHECK_EQUAL(estimator.AddSample(100), true);
+    CHECK_EQUAL(estimator.GetRetransTimeoutMs(), 100 + 4 * 50);
+
+    // Same round trip: RTTVAR = 3/4 * 50, SRTT unchanged.
+    CHECK_EQUAL(estimator.AddSample(100), true);
+    CHECK_EQUAL(estimator.GetRetransTimeoutMs(), 100 + 150);
+
+    // A steady round trip converges to SRTT + G, as RTTVAR decays.
+    for (int i = 0; i < 50; i++)
+    {
+        estimator.AddSample(100);
+    }
+    CHECK_EQUAL(estimator.GetRetransTimeoutMs(), 100 + kGranularityMs);
+    CHECK_EQUAL(estimator.AddSample(100), false);
+
+    // A slower sample: RTTVAR = 3/4 RTTVAR + 1/4 * 80, SRTT = 100 + 80 / 8.
+    CHECK_EQUAL(estimator.AddSample(180), true);
+    estimator.GetStats(stats);
+    CHECK_EQUAL(stats.SrttMs, 110);
+    CHECK_EQUAL(stats.RttVarMs, 20);
+    // 4 * RTTVAR is the unrounded scaled RTTVAR (83), not 4 * 20.
+    CHECK_EQUAL(estimator.GetRetransTimeoutMs(), 110 + 83);
+
+    CHECK_EQUAL(stats.SampleCount, 54);
+    CHECK_EQUAL(stats.LastRttMs, 180);
+    CHECK_EQUAL(stats.MinRttMs, 100);
+    CHECK_EQUAL(stats.MaxRttMs, 180);
+    CHECK_EQUAL(stats.RetransTimeoutMs, estimator.GetRetransTimeoutMs());
+}
+
+static void TestBounds(void)
+{
+    RttEstimator estimator;
+
+    // A fast link is held at the minimum...
+    estimator.Init(kMinTimeoutMs, kMaxTimeoutMs, kGranularityMs);
+    estimator.AddSample(1);
+    CHECK_EQUAL(estimator.GetRetransTimeoutMs(), kMinTimeoutMs);
+
+    // ...and a slow one at the maximum.
+    estimator.Init(kMinTimeoutMs, kMaxTimeoutMs, kGranularityMs);
+    CHECK_EQUAL(estimator.AddSample(4000), false);
+    CHECK_EQUAL(estimator.GetRetransTimeoutMs(), kMaxTimeoutMs);
+}
+
+static void TestRetransmissions(void)
+{
+    RttEstimator estimator;
+    RttEstimator::Stats stats;
+
+    estimator.Init(kMinTimeoutMs, kMaxTimeoutMs, kGranularityMs);
+    estimator.AddSample(100);
+
+    // Karn's algorithm: the ack of a retransmitted message leaves the timeout as is.
+    estimator.DiscardSample();
+    CHECK_EQUAL(estimator.GetRetransTimeoutMs(), 300);
+
+    // Each timeout doubles it, up to the maximum.
+    CHECK_EQUAL(estimator.Backoff(), true);
+    CHECK_EQUAL(estimator.GetRetransTimeoutMs(), 600);
+    CHECK_EQUAL(estimator.Backoff(), true);
+    CHECK_EQUAL(estimator.Backoff(), true);
+    CHECK_EQUAL(estimator.Backoff(), true);
+    CHECK_EQUAL(estimator.GetRetransTimeoutMs(), 4800);
+    CHECK_EQUAL(estimator.Backoff(), true);
+    CHECK_EQUAL(estimator.GetRetransTimeoutMs(), kMaxTimeoutMs);
+    CHECK_EQUAL(estimator.Backoff(), false);
+
+    // The next valid sample sets it from the estimate again.
+    CHECK_EQUAL(estimator.AddSample(100), true);
+    CHECK_EQUAL(estimator.GetRetransTimeoutMs(), 250);
+
+    estimator.GetStats(stats);
+    CHECK_EQUAL(stats.SampleCount, 2);
+    CHECK_EQUAL(stats.DiscardedCount, 1);
+    CHECK_EQUAL(stats.BackoffCount, 6);
+}
+
+int main(void)
+{
+    TestInitialTimeout();
+    TestSamples();
+    TestBounds();
+    TestRetransmissions();
+
+    printf("TestRttEstimator: %s\n", (sFailureCount == 0) ? "PASSED" : "FAILED");
+
+    return (sFailureCount == 0) ? 0 : 1;
+}
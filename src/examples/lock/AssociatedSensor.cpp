@@ -0,0 +1,221 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "AssociatedSensor.h"
+#include "AppPersistentStorage.h"
+#include "WDMFeature.h"
+
+#include <Weave/DeviceLayer/WeaveDeviceLayer.h>
+
+#include <inttypes.h>
+
+using namespace ::nl;
+using namespace ::nl::Inet;
+using namespace ::nl::Weave;
+using namespace ::nl::Weave::DeviceLayer;
+using namespace ::nl::Weave::Profiles::DataManagement_Current;
+
+/** Defines the liveness timeout of the subscription to the sensor. The sensor
+ *  is a sleepy end device, so this also bounds how long the lock may act on a
+ *  stale state after the sensor leaves the network.
+ */
+#ifndef ASSOCIATED_SENSOR_LIVENESS_TIMEOUT_SEC
+#define ASSOCIATED_SENSOR_LIVENESS_TIMEOUT_SEC 60
+#endif
+
+/** Defines the timeout for a response to a message sent to the sensor. One hop
+ *  or two over Thread, but the sensor may be asleep for a poll period.
+ */
+#define ASSOCIATED_SENSOR_MESSAGE_RESPONSE_TIMEOUT_MS 5000
+
+/** Defines the gross timeout of the subscribe request exchange.
+ */
+#define ASSOCIATED_SENSOR_SUBSCRIPTION_RESPONSE_TIMEOUT_MS 15000
+
+AssociatedSensor::AssociatedSensor(void) :
+    mCatalogStore{ SinkTraitCatalog::MakeItem(&mSink, 0) }, mArrayStore{ SinkTraitCatalog::MakeArray(&mSink, 1, 0) },
+    mCatalog(mCatalogStore, 1, mArrayStore, 1), mSubClient(NULL), mBinding(NULL), mNodeId(kNodeIdNotSpecified)
+{
+    mTraitPath.mTraitDataHandle    = 0;
+    mTraitPath.mPropertyPathHandle = kRootPropertyPathHandle;
+}
+
+WEAVE_ERROR AssociatedSensor::Associate(uint64_t nodeId, const IPAddress & nodeAddr)
+{
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    char ipAddrStr[64];
+    PersistedAssociation record;
+    uint8_t * p = record.Addr;
+
+    if (mSubClient != NULL && nodeId == mNodeId)
+    {
+        WeaveLogDetail(Support, "Sensor %" PRIX64 " already associated", nodeId);
+        ExitNow();
+    }
+
+    Dissociate();
+
+    mNodeId   = nodeId;
+    mNodeAddr = nodeAddr;
+
+    mBinding = ExchangeMgr.NewBinding(HandleBindingEvent, this);
+    VerifyOrExit(mBinding != NULL, err = WEAVE_ERROR_NO_MEMORY);
+
+    err = GetWDMFeature().mSubscriptionEngine.NewClient(&mSubClient, mBinding, this, HandleSubscriptionEvent, &mCatalog,
+                                                        ASSOCIATED_SENSOR_SUBSCRIPTION_RESPONSE_TIMEOUT_MS);
+    SuccessOrExit(err);
+
+    nodeAddr.ToString(ipAddrStr, sizeof(ipAddrStr));
+    WeaveLogProgress(Support, "Subscribing to sensor %" PRIX64 " (%s)", nodeId, ipAddrStr);
+
+    // Retries with the default backoff of the client until the sensor answers.
+    mSubClient->EnableResubscribe(NULL);
+    mSubClient->InitiateSubscription();
+
+    // The association survives a reboot of the lock. Not fatal: the
+    // subscription is already up for this boot.
+    record.NodeId = nodeId;
+    nodeAddr.WriteAddress(p);
+    if (AppPersistentStorage::WriteRecord(AppPersistentStorage::kRecordId_AssociatedSensor, record) != WEAVE_NO_ERROR)
+    {
+        WeaveLogError(Support, "Failed to persist the sensor association");
+    }
+
+exit:
+    if (err != WEAVE_NO_ERROR)
+    {
+        WeaveLogError(Support, "Failed to associate sensor %" PRIX64 ": %s", nodeId, ErrorStr(err));
+        Dissociate();
+    }
+    return err;
+}
+
+WEAVE_ERROR AssociatedSensor::Restore(void)
+{
+    PersistedAssociation record;
+    const uint8_t * p = record.Addr;
+    IPAddress nodeAddr;
+
+    if (!AppPersistentStorage::ReadRecord(AppPersistentStorage::kRecordId_AssociatedSensor, record))
+    {
+        return WEAVE_NO_ERROR;
+    }
+
+    IPAddress::ReadAddress(p, nodeAddr);
+    return Associate(record.NodeId, nodeAddr);
+}
+
+void AssociatedSensor::Dissociate(void)
+{
+    if (mSubClient != NULL)
+    {
+        mSubClient->AbortSubscription();
+        mSubClient->Free();
+        mSubClient = NULL;
+    }
+
+    if (mBinding != NULL)
+    {
+        mBinding->Release();
+        mBinding = NULL;
+    }
+
+    mSink.Reset();
+    mNodeId = kNodeIdNotSpecified;
+}
+
+void AssociatedSensor::HandleBindingEvent(void * appState, Binding::EventType eventType, const Binding::InEventParam & inParam,
+                                          Binding::OutEventParam & outParam)
+{
+    AssociatedSensor * _this = static_cast<AssociatedSensor *>(appState);
+    Binding * binding        = inParam.Source;
+
+    switch (eventType)
+    {
+    case Binding::kEvent_PrepareRequested:
+        // The lock acts on the state received, so it must come from the
+        // sensor: CASE authenticates both ends with their device certificates,
+        // and the sensor refuses local subscriptions over any other session.
+        outParam.PrepareRequested.PrepareError = binding->BeginConfiguration()
+                                                     .Target_NodeId(_this->mNodeId)
+                                                     .TargetAddress_IP(_this->mNodeAddr)
+                                                     .Transport_UDP_WRM()
+                                                     .Exchange_ResponseTimeoutMsec(ASSOCIATED_SENSOR_MESSAGE_RESPONSE_TIMEOUT_MS)
+                                                     .Security_CASESession()
+                                                     .PrepareBinding();
+        break;
+
+    case Binding::kEvent_PrepareFailed:
+        WeaveLogError(Support, "Failed to prepare sensor subscription binding: %s", ErrorStr(inParam.PrepareFailed.Reason));
+        break;
+
+    case Binding::kEvent_BindingFailed:
+        WeaveLogError(Support, "Sensor subscription binding failed: %s", ErrorStr(inParam.BindingFailed.Reason));
+        break;
+
+    default:
+        nl::Weave::Binding::DefaultEventHandler(appState, eventType, inParam, outParam);
+    }
+}
+
+void AssociatedSensor::HandleSubscriptionEvent(void * appState, SubscriptionClient::EventID eventType,
+                                               const SubscriptionClient::InEventParam & inParam,
+                                               SubscriptionClient::OutEventParam & outParam)
+{
+    AssociatedSensor * _this = static_cast<AssociatedSensor *>(appState);
+
+    switch (eventType)
+    {
+    case SubscriptionClient::kEvent_OnSubscribeRequestPrepareNeeded:
+        outParam.mSubscribeRequestPrepareNeeded.mPathList                  = &_this->mTraitPath;
+        outParam.mSubscribeRequestPrepareNeeded.mPathListSize              = 1;
+        outParam.mSubscribeRequestPrepareNeeded.mVersionedPathList         = NULL;
+        outParam.mSubscribeRequestPrepareNeeded.mNeedAllEvents             = false;
+        outParam.mSubscribeRequestPrepareNeeded.mLastObservedEventList     = NULL;
+        outParam.mSubscribeRequestPrepareNeeded.mLastObservedEventListSize = 0;
+        outParam.mSubscribeRequestPrepareNeeded.mTimeoutSecMin             = ASSOCIATED_SENSOR_LIVENESS_TIMEOUT_SEC;
+        outParam.mSubscribeRequestPrepareNeeded.mTimeoutSecMax             = ASSOCIATED_SENSOR_LIVENESS_TIMEOUT_SEC;
+        break;
+
+    case SubscriptionClient::kEvent_OnSubscriptionEstablished:
+        WeaveLogProgress(Support, "Sensor subscription established (sub id %016" PRIX64 ")",
+                         inParam.mSubscriptionEstablished.mSubscriptionId);
+        break;
+
+    case SubscriptionClient::kEvent_OnSubscriptionTerminated:
+        // Also reached when the liveness timeout expires. The last state may
+        // be stale: forget it, with its data version so that the sensor sends
+        // its state again on resubscription, and let the lock act meanwhile.
+        _this->mSink.Reset();
+        WeaveLogProgress(
+            Support, "Sensor subscription terminated: %s",
+            (inParam.mSubscriptionTerminated.mIsStatusCodeValid)
+                ? StatusReportStr(inParam.mSubscriptionTerminated.mStatusProfileId, inParam.mSubscriptionTerminated.mStatusCode)
+                : ErrorStr(inParam.mSubscriptionTerminated.mReason));
+
+        if (!inParam.mSubscriptionTerminated.mWillRetry && inParam.mSubscriptionTerminated.mClient == _this->mSubClient)
+        {
+            _this->mSubClient->InitiateSubscription();
+        }
+        break;
+
+    default:
+        SubscriptionClient::DefaultEventHandler(eventType, inParam, outParam);
+        break;
+    }
+}
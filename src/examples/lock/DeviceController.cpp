@@ -31,11 +31,15 @@
 #include "FreeRTOS.h"
 
 #include "BoltLockTrait.h"
+#include "BoltLockTraitEventSerializer.h"
+#include "AppPersistentStorage.h"
 #include "AppSoftwareUpdateManager.h"
 #include "ConnectivityState.h"
+#include "EventSerializer.h"
 #include "WDMFeature.h"
 #include "AppTask.h"
 
+#include <algorithm>
 #include <inttypes.h>
 
 using namespace ::nl::Weave::DeviceLayer;
@@ -55,6 +59,7 @@ DeviceController DeviceController::sDeviceController;
 //   - To support auto-lock of the lock device. When the bolt is unlocked,
 //     the timer is set to the period of time after which we want it to be
 //     automatically locked. (AUTOLOCK_CONTEXT)
+// With several locks, the timer is shared and set for the earliest deadline.
 APP_TIMER_DEF(sDeviceTimer);
 
 // -----------------------------------------------------------------------------
@@ -68,10 +73,16 @@ void DeviceController::Init()
     ret = app_timer_create(&sDeviceTimer, APP_TIMER_MODE_SINGLE_SHOT, DeviceTimerEventHandler);
     SuccessOrAbort(ret, "app_timer_create failed.");
 
-    // Initial state of the lock.
-    mState                        = kState_LockingCompleted;
+    // Initial state of the locks.
+    for (uint8_t i = 0; i < LOCK_INSTANCE_COUNT; i++)
+    {
+        mLocks[i].State              = kState_LockingCompleted;
+        mLocks[i].AutoLockTimerArmed = false;
+        mLocks[i].MovementDeadlineMs = 0;
+        mLocks[i].AutoLockDeadlineMs = 0;
+    }
+    mTimerContext                 = ACTUATOR_MOVEMENT_CONTEXT;
     mLongPressButtonEventInFlight = false;
-    mAutoLockTimerArmed           = false;
     mAutoLockEnabled              = false;
     mAutoLockDurationSeconds      = 0;
 
@@ -91,14 +102,53 @@ void DeviceController::Init()
     // FIXME: How do I ensure that the state of the lock in the service is in sync with
     // the current state of the physical device?
     WeaveLogProgress(Support, "Initializing WDMFeature");
+    // Phones of the fabric may subscribe to the lock directly, over CASE.
+    GetWDMFeature().AcceptLocalSubscribers();
     ret = GetWDMFeature().Init();
     SuccessOrAbort(ret, "GetWDMFeature().Init() failed.");
 
+    // The Weave event loop already runs: the pool allocates packet buffers and
+    // may arm a timer of the system layer, and the sensor subscription is
+    // initiated on the Weave task.
+    PlatformMgr().LockWeaveStack();
+    BoltLockTraitDataSource::ReserveResponseBuffers();
+    mAssociatedSensor.Restore();
+    PlatformMgr().UnlockWeaveStack();
+
+#if DEVICE_IDENTITY_TRAIT_BENCHMARK
+    GetWDMFeature().GetSource<DeviceIdentityTraitDataSource>().RunEncodeBenchmark();
+#endif
+#if LOCK_CATALOG_BENCHMARK
+    RunCatalogBenchmark();
+#endif
+#if BOLT_LOCK_TRAIT_FANOUT_BENCHMARK
+    GetWDMFeature().GetSource<BoltLockTraitDataSources>().RunFanOutBenchmark();
+#endif
+#if EVENT_SERIALIZER_BENCHMARK || PERSISTED_EVENT_LOG_BENCHMARK
+    {
+        using namespace Schema::Weave::Trait::Security::BoltLockTrait;
+
+        BoltActuatorStateChangeEvent ev;
+        ev.state                = BOLT_STATE_EXTENDED;
+        ev.actuatorState        = BOLT_ACTUATOR_STATE_LOCKING;
+        ev.lockedState          = BOLT_LOCKED_STATE_UNLOCKED;
+        ev.boltLockActor.method = BOLT_LOCK_ACTOR_METHOD_PHYSICAL;
+        ev.boltLockActor.SetOriginatorNull();
+        ev.boltLockActor.SetAgentNull();
+#if EVENT_SERIALIZER_BENCHMARK
+        RunEventSerializerBenchmark(ev, "BoltActuatorStateChangeEvent");
+#endif
+#if PERSISTED_EVENT_LOG_BENCHMARK
+        PersistedEventLog::GetInstance().RunBenchmark(ev, "BoltActuatorStateChangeEvent");
+#endif
+    }
+#endif
+
     // Initialize the Manager for Software Updates (SWU aka OTA).
     GetAppSoftwareUpdateManager().Init();
 
     // Setup the ConnectivityState object that reflects the provisioning state on a LED.
-    mConnectivityState.SetLED(mConnectivityStateLEDPtr);
+    mConnectivityState.Init(mConnectivityStateLEDPtr, AreServiceSubscriptionsEstablished);
 
     // Setup the DeviceDescription client.
     WeaveLogProgress(Support, "Initializing DeviceDescriptionClient");
@@ -114,7 +164,7 @@ void DeviceController::Init()
     WeaveLogProgress(Support, "Current Firmware Version: %s", currentFirmwareRev);
 }
 
-void DeviceController::EventLoopCycle()
+uint32_t DeviceController::EventLoopCycle()
 {
     DeviceController & _this = GetDeviceController();
     LED * leds               = GetHardwarePlatform().GetLEDs();
@@ -126,9 +176,11 @@ void DeviceController::EventLoopCycle()
     bool startLongPressInFlight = false;
     bool endLongPressInFlight   = false;
     bool allButtonsReleased     = true;    // Provides check for button released before Long_Completed state.
+    uint32_t deadlineMs         = APP_EVENT_LOOP_NO_DEADLINE;
     for (int idx = 0; idx < PLATFORM_BUTTONS_COUNT; idx++)
     {
         Button::ButtonPressState buttonPressState = (buttons + idx)->UpdateButtonPressState();
+        deadlineMs = std::min(deadlineMs, (buttons + idx)->GetNextPressStateDeadlineMs());
 
         if (buttonPressState != Button::kButtonPressState_Inactive)
         {
@@ -157,6 +209,9 @@ void DeviceController::EventLoopCycle()
     if (startLongPressInFlight)
     {
         // Indicate that long press is in flight on the LEDs by blinking all of them.
+        // The connectivity state must not override the blinking meanwhile.
+        _this.mConnectivityState.SetLEDUpdatesEnabled(false);
+
         // Turn off all LEDs before starting blink to make sure blink is co-ordinated.
         for (int led_idx = 0; led_idx < PLATFORM_LEDS_COUNT; led_idx++)
         {
@@ -179,44 +234,37 @@ void DeviceController::EventLoopCycle()
         // Set lock status LED back to show state of lock.
         _this.mLockStateLEDPtr->Set(!_this.IsUnlocked());
 
-        // Update the provisioning state shown on LED.
-        _this.mConnectivityState.Update(GetWDMFeature().AreServiceSubscriptionsEstablished());
-    }
-    else if (!_this.mLongPressButtonEventInFlight)
-    {
-        // Update the provisioning state shown on LED.
-        // _this.mConnectivityState.Update(GetWDMFeature().AreServiceSubscriptionsEstablished());
-
-        // Update the provisioning state shown on LED.
-        // Note- call to mConnectivityState.Update fn is slow and can cause system clock
-        // to increment slower than real time (disturbs button short/long press timings)
-        // => don't check for connectivity change on every EventLoopCycle iteration-
-        static uint16_t loopCount = 0;
-        ++loopCount;
-        if ((loopCount % 100) == 0)
-        {
-            _this.mConnectivityState.Update(GetWDMFeature().AreServiceSubscriptionsEstablished());
-        }
+        // Show the provisioning state on its LED again.
+        _this.mConnectivityState.SetLEDUpdatesEnabled(true);
     }
 
     // Animate the LEDs.
     for (int idx = 0; idx < PLATFORM_LEDS_COUNT; idx++)
     {
-        (leds + idx)->Animate();
+        deadlineMs = std::min(deadlineMs, (leds + idx)->Animate());
     }
+
+    return deadlineMs;
 }
 
 // -----------------------------------------------------------------------------
 // Accessors
 
-bool DeviceController::IsLockingActionInProgress()
+bool DeviceController::IsLockingActionInProgress(uint8_t aInstance)
+{
+    return (mLocks[aInstance].State == kState_LockingInitiated || mLocks[aInstance].State == kState_UnlockingInitiated);
+}
+
+bool DeviceController::IsUnlocked(uint8_t aInstance)
 {
-    return (mState == kState_LockingInitiated || mState == kState_UnlockingInitiated);
+    return (mLocks[aInstance].State == kState_UnlockingCompleted);
 }
 
-bool DeviceController::IsUnlocked()
+bool DeviceController::IsDoorReportedOpen(uint8_t aInstance)
 {
-    return (mState == kState_UnlockingCompleted);
+    // The sensor state is cached by the local subscription, so this check does
+    // not wait for the network.
+    return aInstance == PHYSICAL_LOCK_INDEX && mAssociatedSensor.IsReportedOpen();
 }
 
 void DeviceController::EnableAutoLock(bool aOn)
@@ -229,21 +277,69 @@ void DeviceController::SetAutoLockDuration(uint32_t aDurationSeconds)
     mAutoLockDurationSeconds = aDurationSeconds;
 }
 
+// Called by ConnectivityState on the Weave task.
+bool DeviceController::AreServiceSubscriptionsEstablished(void)
+{
+    return GetWDMFeature().AreServiceSubscriptionsEstablished();
+}
+
 // -----------------------------------------------------------------------------
 // Timer Management
 
-void DeviceController::StartTimer(uint32_t aTimeoutMs)
+void DeviceController::StartTimer(uint8_t aInstance, TimerContext_t aContext, uint32_t aTimeoutMs)
 {
-    ret_code_t ret;
-    ret = app_timer_start(sDeviceTimer, pdMS_TO_TICKS(aTimeoutMs), NULL);
-    SuccessOrAbort(ret, "app_timer_start() failed");
+    uint64_t deadlineMs = ::nl::Weave::System::Platform::Layer::GetClock_MonotonicMS() + aTimeoutMs;
+
+    if (aContext == AUTO_LOCK_CONTEXT)
+    {
+        mLocks[aInstance].AutoLockDeadlineMs = deadlineMs;
+    }
+    else
+    {
+        mLocks[aInstance].MovementDeadlineMs = deadlineMs;
+    }
+
+    RearmTimer();
 }
 
-void DeviceController::CancelTimer(void)
+void DeviceController::RearmTimer(void)
 {
     ret_code_t ret;
+    bool armed          = false;
+    uint64_t deadlineMs = 0;
+    uint64_t nowMs;
+
+    for (uint8_t i = 0; i < LOCK_INSTANCE_COUNT; i++)
+    {
+        const LockInstance & lock = mLocks[i];
+
+        if (IsLockingActionInProgress(i) && (!armed || lock.MovementDeadlineMs < deadlineMs))
+        {
+            armed         = true;
+            deadlineMs    = lock.MovementDeadlineMs;
+            mTimerContext = ACTUATOR_MOVEMENT_CONTEXT;
+        }
+        if (lock.AutoLockTimerArmed && (!armed || lock.AutoLockDeadlineMs < deadlineMs))
+        {
+            armed         = true;
+            deadlineMs    = lock.AutoLockDeadlineMs;
+            mTimerContext = AUTO_LOCK_CONTEXT;
+        }
+    }
+
     ret = app_timer_stop(sDeviceTimer);
     SuccessOrAbort(ret, "app_timer_stop() failed");
+
+    if (armed)
+    {
+        nowMs = ::nl::Weave::System::Platform::Layer::GetClock_MonotonicMS();
+
+        // A deadline already passed, or less than a tick away, fires on the next
+        // tick: the timer does not accept a period of 0.
+        ret = app_timer_start(
+            sDeviceTimer, std::max<TickType_t>(pdMS_TO_TICKS((deadlineMs > nowMs) ? (uint32_t)(deadlineMs - nowMs) : 0), 1), NULL);
+        SuccessOrAbort(ret, "app_timer_start() failed");
+    }
 }
 
 void DeviceController::DeviceTimerEventHandler(void * p_context)
@@ -256,120 +352,159 @@ void DeviceController::DeviceTimerEventHandler(void * p_context)
     // Posts an event to AppTask queue with the proper handler. The event will then be handled
     // in the context of the application task.
     AppTask::AppTaskEventHandler_t eventHandler;
+    AppTask::EventLane_t lane;
     switch (context)
     {
     case AUTO_LOCK_CONTEXT:
         eventHandler = AutoLockTimerEventHandler;
+        lane         = AppTask::kEventLane_Command;
         break;
     case ACTUATOR_MOVEMENT_CONTEXT:
         eventHandler = ActuatorMovementTimerEventHandler;
+        lane         = AppTask::kEventLane_Actuator;
         break;
     default:
         WeaveLogError(Support, "ERROR: Invalid context for device timer: %d", context);
+        return;
     }
-    AppTask::AppTaskEvent appTaskEvent;
-    appTaskEvent.Handler = eventHandler;
-    appTaskEvent.Data    = nullptr;
-    GetAppTask().PostEvent(&appTaskEvent);
+    GetAppTask().PostEvent(eventHandler, lane);
 }
 
 void DeviceController::AutoLockTimerEventHandler(void * data)
 {
     DeviceController & _this = GetDeviceController();
+    uint64_t nowMs           = ::nl::Weave::System::Platform::Layer::GetClock_MonotonicMS();
+    int32_t actor            = Schema::Weave::Trait::Security::BoltLockTrait::BOLT_LOCK_ACTOR_METHOD_LOCAL_IMPLICIT;
 
-    // Make sure auto lock timer is still armed.
-    if (!_this.mAutoLockTimerArmed)
+    for (uint8_t i = 0; i < LOCK_INSTANCE_COUNT; i++)
     {
-        return;
+        LockInstance & lock = _this.mLocks[i];
+
+        // Make sure auto lock is still armed and due.
+        if (!lock.AutoLockTimerArmed || lock.AutoLockDeadlineMs > nowMs)
+        {
+            continue;
+        }
+
+        WeaveLogDetail(Support, "Auto-Lock has been triggered on lock %u!", i);
+        lock.AutoLockTimerArmed = false;
+        if (!_this.InitiateAction(i, actor, LOCK_ACTION) && _this.IsDoorReportedOpen(i))
+        {
+            // Lock as soon as the door is closed again.
+            lock.AutoLockTimerArmed = true;
+            lock.AutoLockDeadlineMs = nowMs + AUTO_LOCK_DOOR_OPEN_RETRY_MS;
+        }
     }
 
-    WeaveLogDetail(Support, "Auto-Lock has been triggered!");
-    int32_t actor             = Schema::Weave::Trait::Security::BoltLockTrait::BOLT_LOCK_ACTOR_METHOD_LOCAL_IMPLICIT;
-    _this.mAutoLockTimerArmed = false;
-    _this.InitiateAction(actor, LOCK_ACTION);
+    _this.RearmTimer();
 }
 
 void DeviceController::ActuatorMovementTimerEventHandler(void * data)
 {
     DeviceController & _this = GetDeviceController();
+    uint64_t nowMs           = ::nl::Weave::System::Platform::Layer::GetClock_MonotonicMS();
 
-    if (_this.mState == kState_LockingInitiated)
-    {
-        _this.mState = kState_LockingCompleted;
-        _this.ActionCompleted(LOCK_ACTION);
-    }
-    else if (_this.mState == kState_UnlockingInitiated)
+    for (uint8_t i = 0; i < LOCK_INSTANCE_COUNT; i++)
     {
-        _this.mState = kState_UnlockingCompleted;
-        _this.ActionCompleted(UNLOCK_ACTION);
+        LockInstance & lock = _this.mLocks[i];
+
+        if (lock.MovementDeadlineMs > nowMs)
+        {
+            continue;
+        }
+
+        if (lock.State == kState_LockingInitiated)
+        {
+            lock.State = kState_LockingCompleted;
+            _this.ActionCompleted(i, LOCK_ACTION);
+        }
+        else if (lock.State == kState_UnlockingInitiated)
+        {
+            lock.State = kState_UnlockingCompleted;
+            _this.ActionCompleted(i, UNLOCK_ACTION);
+        }
     }
+
+    _this.RearmTimer();
 }
 
-bool DeviceController::InitiateAction(int32_t aActor, Action_t aAction)
+bool DeviceController::InitiateAction(uint8_t aInstance, int32_t aActor, Action_t aAction)
 {
     // We can initiate a Lock/Unlock Action only if the previous one has completed
+    LockInstance & lock   = mLocks[aInstance];
     bool action_initiated = false;
     State_t new_state;
 
-    if (aAction == UNLOCK_ACTION && mState == kState_LockingCompleted)
+    // The bolt of the door cannot be extended while the door is open.
+    if (aAction == LOCK_ACTION && IsDoorReportedOpen(aInstance))
+    {
+        WeaveLogProgress(Support, "lock [%u] not locked: the door is open", aInstance);
+        return false;
+    }
+
+    if (aAction == UNLOCK_ACTION && lock.State == kState_LockingCompleted)
     {
         // Unlock and locking is completed, all good to move to unlocking state.
         action_initiated = true;
         new_state        = kState_UnlockingInitiated;
     }
-    else if (aAction == LOCK_ACTION && mState == kState_UnlockingCompleted)
+    else if (aAction == LOCK_ACTION && lock.State == kState_UnlockingCompleted)
     {
         // Lock and unlocking is completed, all good to move to locking state.
         action_initiated = true;
         new_state        = kState_LockingInitiated;
     }
 
-    WeaveLogDetail(Support, "action_initiated [%d] mAutoLockTimerArmed [%d] new_state: [%d]", action_initiated, mAutoLockTimerArmed,
-                   new_state);
+    WeaveLogDetail(Support, "lock [%u] action_initiated [%d] AutoLockTimerArmed [%d] new_state: [%d]", aInstance,
+                   action_initiated, lock.AutoLockTimerArmed, new_state);
     if (action_initiated)
     {
-        if (mAutoLockTimerArmed && new_state == kState_LockingInitiated)
+        if (lock.AutoLockTimerArmed && new_state == kState_LockingInitiated)
         {
             // Auto lock timer has been armed and someone initiates locking,
             // cancel the timer and continue as normal.
-            mAutoLockTimerArmed = false;
-            CancelTimer();
+            lock.AutoLockTimerArmed = false;
         }
 
-        // Simulate the bolt movement for a period of time. Timer is started.
-        mTimerContext = ACTUATOR_MOVEMENT_CONTEXT;
-        StartTimer(ACTUATOR_MOVEMENT_DURATION_MS);
-
-        // Since the timer started successfully, update the state and trigger callback
-        mState = new_state;
+        // Update the state, and simulate the bolt movement for a period of time.
+        lock.State = new_state;
+        StartTimer(aInstance, ACTUATOR_MOVEMENT_CONTEXT, ACTUATOR_MOVEMENT_DURATION_MS);
 
-        ActionInitiated(aAction, aActor);
+        ActionInitiated(aInstance, aAction, aActor);
     }
 
     return action_initiated;
 }
 
-void DeviceController::ActionInitiated(DeviceController::Action_t aAction, int32_t aActor)
+void DeviceController::ActionInitiated(uint8_t aInstance, DeviceController::Action_t aAction, int32_t aActor)
 {
+    BoltLockTraitDataSource & boltLockSource = GetWDMFeature().GetSource<BoltLockTraitDataSources>(aInstance);
+
     // If the action has been initiated by the lock, update the bolt lock trait
     // and start flashing the LEDs rapidly to indicate action initiation.
     if (aAction == DeviceController::LOCK_ACTION)
     {
-        GetWDMFeature().GetBoltLockTraitDataSource().InitiateLock(aActor);
+        boltLockSource.InitiateLock(aActor);
         WeaveLogDetail(Support, "Lock Action has been initiated");
     }
     else if (aAction == DeviceController::UNLOCK_ACTION)
     {
-        GetWDMFeature().GetBoltLockTraitDataSource().InitiateUnlock(aActor);
+        boltLockSource.InitiateUnlock(aActor);
         WeaveLogDetail(Support, "Unlock Action has been initiated");
     }
 
-    WeaveLogDetail(Support, "blinking the LockState LED");
-    mLockStateLEDPtr->Blink(50, 50);
+    if (aInstance == PHYSICAL_LOCK_INDEX)
+    {
+        WeaveLogDetail(Support, "blinking the LockState LED");
+        mLockStateLEDPtr->Blink(50, 50);
+    }
 }
 
-void DeviceController::ActionCompleted(DeviceController::Action_t aAction)
+void DeviceController::ActionCompleted(uint8_t aInstance, DeviceController::Action_t aAction)
 {
+    BoltLockTraitDataSource & boltLockSource = GetWDMFeature().GetSource<BoltLockTraitDataSources>(aInstance);
+    bool isPhysicalLock                      = (aInstance == PHYSICAL_LOCK_INDEX);
+
     // if the action has been completed by the lock, update the bolt lock trait.
     // Turn on the lock LED if in a LOCKED state OR
     // Turn off the lock LED if in an UNLOCKED state.
@@ -377,21 +512,26 @@ void DeviceController::ActionCompleted(DeviceController::Action_t aAction)
     {
         WeaveLogDetail(Support, "Lock Action has been completed");
 
-        GetWDMFeature().GetBoltLockTraitDataSource().LockingSuccessful();
-        mLockStateLEDPtr->Set(true);
+        boltLockSource.LockingSuccessful();
+        if (isPhysicalLock)
+        {
+            mLockStateLEDPtr->Set(true);
+        }
     }
     else if (aAction == DeviceController::UNLOCK_ACTION)
     {
         WeaveLogDetail(Support, "Unlock Action has been completed");
-        GetWDMFeature().GetBoltLockTraitDataSource().UnlockingSuccessful();
-        mLockStateLEDPtr->Set(false);
+        boltLockSource.UnlockingSuccessful();
+        if (isPhysicalLock)
+        {
+            mLockStateLEDPtr->Set(false);
+        }
 
         if (mAutoLockEnabled)
         {
             // Start the timer for auto-lock
-            mTimerContext       = AUTO_LOCK_CONTEXT;
-            mAutoLockTimerArmed = true;
-            StartTimer(mAutoLockDurationSeconds * 1000);
+            mLocks[aInstance].AutoLockTimerArmed = true;
+            StartTimer(aInstance, AUTO_LOCK_CONTEXT, mAutoLockDurationSeconds * 1000);
             WeaveLogDetail(Support, "Auto-lock enabled. Will be triggered in %u seconds", mAutoLockDurationSeconds);
         }
     }
@@ -420,7 +560,7 @@ void DeviceController::LockButtonEventHandler()
     }
     actor = Schema::Weave::Trait::Security::BoltLockTrait::BOLT_LOCK_ACTOR_METHOD_PHYSICAL;
 
-    bool initiated = _this.InitiateAction(actor, action);
+    bool initiated = _this.InitiateAction(PHYSICAL_LOCK_INDEX, actor, action);
     if (!initiated)
     {
         // We are already in the process of locking/unlocking the bolt.
@@ -435,7 +575,7 @@ void DeviceController::LockOnCommandRequestEventHandler(void * eventData)
     DeviceController & _this = GetDeviceController();
 
     LockOnCommandRequestData * data = static_cast<LockOnCommandRequestData *>(eventData);
-    bool initiated                  = _this.InitiateAction(data->actor, data->action);
+    bool initiated                  = _this.InitiateAction(data->instance, data->actor, data->action);
     if (!initiated)
     {
         // We are already in the process of locking/unlocking the bolt.
@@ -452,6 +592,8 @@ void DeviceController::SoftwareUpdateButtonHandler()
 void DeviceController::FactoryResetButtonHandler()
 {
     WeaveLogDetail(Support, "Factory Reset Triggered.");
+    // The Device Layer only erases the Weave configuration.
+    AppPersistentStorage::EraseAll();
     nl::Weave::DeviceLayer::ConfigurationMgr().InitiateFactoryReset();
 }
 
@@ -481,6 +623,7 @@ void DeviceController::SendIdentifyRequestButtonHandler()
         return;
     }
 
+#if WEAVE_DEVICE_CONFIG_ENABLE_THREAD
     // Get the Thread mesh-local prefix
     const otMeshLocalPrefix * otMeshPrefix = otThreadGetMeshLocalPrefix(ThreadStackMgrImpl().OTInstance());
     uint64_t otMeshPrefix64                = nl::Weave::Encoding::BigEndian::Get64(otMeshPrefix->m8);
@@ -488,6 +631,11 @@ void DeviceController::SendIdentifyRequestButtonHandler()
 
     nl::Inet::IPAddress allThreadNodesAddr =
         IPAddress::MakeIPv6PrefixMulticast(nl::Inet::kIPv6MulticastScope_Realm, 64, otMeshPrefix64, 1);
+#else
+    // No Thread network (e.g. posix host build): use the link-local all-nodes address.
+    nl::Inet::IPAddress allThreadNodesAddr =
+        IPAddress::MakeIPv6WellKnownMulticast(nl::Inet::kIPv6MulticastScope_Link, nl::Inet::kIPV6MulticastGroup_AllNodes);
+#endif
     char addrStr[50];
     allThreadNodesAddr.ToString(addrStr, sizeof(addrStr));
     WeaveLogDetail(Support, "All thread nodes multicast address: [%s]", addrStr);
@@ -527,20 +675,129 @@ void DeviceController::OnIdentifyResponseReceivedHandler(void * appState, uint64
     WeaveLogDetail(Support, "  Source Vendor Id: %04X\n", (unsigned) deviceDesc.VendorId);
     WeaveLogDetail(Support, "  Source Product Id: %04X\n", (unsigned) deviceDesc.ProductId);
     WeaveLogDetail(Support, "  Source Product Revision: %04X\n", (unsigned) deviceDesc.ProductRevision);
+
+    // Any device in user selected mode answers. Keep waiting for the sensor,
+    // and associate the first one that responds.
+    if (deviceDesc.VendorId != ASSOCIATED_SENSOR_VENDOR_ID || deviceDesc.ProductId != ASSOCIATED_SENSOR_PRODUCT_ID)
+    {
+        WeaveLogProgress(Support, "Node %" PRIX64 " is not an open/close sensor, ignored", nodeId);
+        return;
+    }
+
+    _this.mDeviceDescriptionClient.CancelExchange();
+    _this.mAssociatedSensor.Associate(nodeId, nodeAddr);
 }
 
 // -----------------------------------------------------------------------------
 // Utility Methods
 
-// This is called by BoltLockTraitDataSource::OnCustomCommand.
-void DeviceController::PostLockOnCommandRequestEvent(int32_t actor, Action_t action)
+// This is called by BoltLockTraitDataSource::OnCustomCommand. Returns false if
+// the command lane is full and the request was dropped.
+bool DeviceController::PostLockOnCommandRequestEvent(uint8_t instance, int32_t actor, Action_t action)
 {
     LockOnCommandRequestData data;
-    data.actor  = actor;
-    data.action = action;
+    data.instance = instance;
+    data.actor    = actor;
+    data.action   = action;
+
+    // The event data is copied into the event, so posting a local is safe.
+    return GetAppTask().PostEvent(LockOnCommandRequestEventHandler, data, AppTask::kEventLane_Command);
+}
+
+#if LOCK_CATALOG_BENCHMARK
+
+// -----------------------------------------------------------------------------
+// Catalog benchmark
+
+// Measures, for 32 and 128 BoltLockTrait instances, the catalog work done for
+// each instance in a notify (finding the handle of the dirty source and writing
+// its path) and in a subscribe request (resolving its path), and the memory used
+// per lock instance. The catalog items of the WDMFeature are in read-only data.
+// The rest of a notify does not depend on the number of instances.
+void DeviceController::RunCatalogBenchmark(void)
+{
+    using namespace ::nl::Weave::TLV;
+    using namespace ::nl::Weave::Profiles::DataManagement_Current;
+    typedef WDMFeatureBase::SourceTraitCatalog Catalog;
+
+    enum
+    {
+        kMaxInstanceCount = 128,
+        kRoundCount       = 16,
+    };
+    static const uint32_t kInstanceCounts[] = { 32, kMaxInstanceCount };
+    static BoltLockTraitDataSource sSources[kMaxInstanceCount];
+    static Catalog::CatalogItem sItems[kMaxInstanceCount];
+    Catalog::ItemArray array;
+    uint8_t pathBuf[64];
+    WEAVE_ERROR err = WEAVE_NO_ERROR;
+
+    WeaveLogProgress(Support, "Catalog benchmark: %u bytes per lock (source %u, catalog item %u, controller %u)",
+                     (unsigned) (sizeof(BoltLockTraitDataSource) + sizeof(Catalog::CatalogItem) + sizeof(LockInstance)),
+                     (unsigned) sizeof(BoltLockTraitDataSource), (unsigned) sizeof(Catalog::CatalogItem),
+                     (unsigned) sizeof(LockInstance));
+
+    for (size_t n = 0; n < sizeof(kInstanceCounts) / sizeof(kInstanceCounts[0]); n++)
+    {
+        uint32_t count = kInstanceCounts[n];
+        Catalog catalog(sItems, count, &array, 1);
+        uint64_t notifyUs    = 0;
+        uint64_t subscribeUs = 0;
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            sItems[i] = Catalog::MakeItem(&sSources[i], i);
+        }
+        array = Catalog::MakeArray(sSources, count, 0);
+
+        for (uint32_t round = 0; round < kRoundCount; round++)
+        {
+            for (uint32_t i = 0; i < count; i++)
+            {
+                TraitDataHandle handle;
+                SchemaVersionRange versionRange;
+                TLVWriter writer;
+                TLVReader reader;
+                TLVType containerType;
+                uint64_t startUs = ::nl::Weave::System::Platform::Layer::GetClock_MonotonicHiRes();
+
+                err = catalog.Locate(&sSources[i], handle);
+                SuccessOrExit(err);
+
+                writer.Init(pathBuf, sizeof(pathBuf));
+                err = writer.StartContainer(AnonymousTag, kTLVType_Path, containerType);
+                SuccessOrExit(err);
+                err = catalog.HandleToAddress(handle, writer, versionRange);
+                SuccessOrExit(err);
+                err = writer.EndContainer(containerType);
+                SuccessOrExit(err);
+                err = writer.Finalize();
+                SuccessOrExit(err);
+
+                notifyUs += ::nl::Weave::System::Platform::Layer::GetClock_MonotonicHiRes() - startUs;
+                startUs = ::nl::Weave::System::Platform::Layer::GetClock_MonotonicHiRes();
+
+                reader.Init(pathBuf, writer.GetLengthWritten());
+                err = reader.Next();
+                SuccessOrExit(err);
+                err = catalog.AddressToHandle(reader, handle, versionRange);
+                SuccessOrExit(err);
+
+                subscribeUs += ::nl::Weave::System::Platform::Layer::GetClock_MonotonicHiRes() - startUs;
+                VerifyOrExit(handle == i, err = WEAVE_ERROR_INCORRECT_STATE);
+            }
+        }
 
-    AppTask::AppTaskEvent appTaskEvent;
-    appTaskEvent.Handler = LockOnCommandRequestEventHandler;
-    appTaskEvent.Data    = &data;
-    GetAppTask().PostEvent(&appTaskEvent);
+        WeaveLogProgress(Support, "Catalog benchmark: %" PRIu32 " locks, notify %" PRIu32 " ns, subscribe %" PRIu32 " ns per lock",
+                         count, (uint32_t)(notifyUs * 1000 / (count * kRoundCount)),
+                         (uint32_t)(subscribeUs * 1000 / (count * kRoundCount)));
+    }
+
+exit:
+    if (err != WEAVE_NO_ERROR)
+    {
+        WeaveLogError(Support, "Catalog benchmark failed: %s", ::nl::ErrorStr(err));
+    }
 }
+
+#endif // LOCK_CATALOG_BENCHMARK
@@ -0,0 +1,103 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      Local subscription of the lock to the SecurityOpenCloseTrait of the
+ *      open/close sensor of its door (see doc/DeviceAssociationInLocalNetwork.md).
+ */
+
+#ifndef ASSOCIATED_SENSOR_H
+#define ASSOCIATED_SENSOR_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <Weave/DeviceLayer/WeaveDeviceLayer.h>
+#include <Weave/Profiles/data-management/Current/DataManagement.h>
+
+#include "MultiResourceTraitCatalog.h"
+#include "SecurityOpenCloseTraitDataSink.h"
+
+/**
+ * Keeps a WDM subscription to the sensor found by the Identify request of the
+ * lock, directly over the local network, and caches the sensor state in a sink.
+ * The lock reads the cache when it operates the bolt, so the check costs no
+ * network round-trip. The subscription is re-established on its own after a
+ * loss, and the state is unknown in the meantime.
+ */
+class AssociatedSensor
+{
+    typedef ::nl::Weave::Profiles::DataManagement_Current::SubscriptionClient SubscriptionClient;
+    typedef ::nl::Weave::Profiles::DataManagement_Current::TraitDataSink TraitDataSink;
+    typedef ::nl::Weave::Profiles::DataManagement_Current::TraitPath TraitPath;
+
+public:
+    AssociatedSensor(void);
+
+    // Subscribes to the sensor at nodeId, replacing the previous association,
+    // and persists the association. Must be called on the Weave task, after
+    // the WDMFeature is initialized.
+    WEAVE_ERROR Associate(uint64_t nodeId, const ::nl::Inet::IPAddress & nodeAddr);
+
+    // Associates again the sensor persisted by the previous boot, if any.
+    // Same calling constraints as Associate().
+    WEAVE_ERROR Restore(void);
+
+    // Whether the associated sensor last reported its door open. False if no
+    // sensor is associated or its subscription is down. May be called from any task.
+    bool IsReportedOpen(void) const { return mSink.IsReportedOpen(); }
+
+    // May be called from any task.
+    void GetLatencyStats(SecurityOpenCloseTraitDataSink::LatencyStats & stats) const { mSink.GetLatencyStats(stats); }
+
+private:
+    typedef MultiResourceTraitCatalog<TraitDataSink> SinkTraitCatalog;
+
+    // Layout of AppPersistentStorage::kRecordId_AssociatedSensor. The address
+    // is kept in network byte order, as written by IPAddress::WriteAddress.
+    struct PersistedAssociation
+    {
+        uint64_t NodeId;
+        uint8_t Addr[16];
+    };
+
+    void Dissociate(void);
+
+    static void HandleBindingEvent(void * appState, ::nl::Weave::Binding::EventType eventType,
+                                   const ::nl::Weave::Binding::InEventParam & inParam,
+                                   ::nl::Weave::Binding::OutEventParam & outParam);
+    static void HandleSubscriptionEvent(void * appState, SubscriptionClient::EventID eventType,
+                                        const SubscriptionClient::InEventParam & inParam,
+                                        SubscriptionClient::OutEventParam & outParam);
+
+    SecurityOpenCloseTraitDataSink mSink;
+
+    SinkTraitCatalog::CatalogItem mCatalogStore[1];
+    SinkTraitCatalog::ItemArray mArrayStore[1];
+    SinkTraitCatalog mCatalog;
+    TraitPath mTraitPath;
+
+    nl::Weave::Profiles::DataManagement::SubscriptionClient * mSubClient;
+    nl::Weave::Binding * mBinding;
+
+    uint64_t mNodeId;
+    ::nl::Inet::IPAddress mNodeAddr;
+};
+
+#endif // ASSOCIATED_SENSOR_H
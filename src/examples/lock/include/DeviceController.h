@@ -25,6 +25,8 @@
 #include "AppTask.h"
 #include "LED.h"
 #include "ConnectivityState.h"
+#include "WDMFeature.h"
+#include "AssociatedSensor.h"
 
 #include <Weave/Profiles/device-description/DeviceDescription.h>
 #include <Weave/Core/WeaveCore.h>
@@ -44,6 +46,29 @@ using namespace nl::Inet;
 // How long it takes for the bolt to change position.
 #define ACTUATOR_MOVEMENT_DURATION_MS 2000
 
+// Lock operated by button 2 and shown on LED 1. The other locks
+// (see LOCK_INSTANCE_COUNT) are only operated through their trait.
+#define PHYSICAL_LOCK_INDEX 0
+
+// How often a due auto-lock is attempted again while the door is reported open.
+#ifndef AUTO_LOCK_DOOR_OPEN_RETRY_MS
+#define AUTO_LOCK_DOOR_OPEN_RETRY_MS 2000
+#endif
+
+// Vendor and product ids of the open/close sensor the lock associates with
+// (see src/examples/ocsensor/include/WeaveProjectConfig.h).
+#ifndef ASSOCIATED_SENSOR_VENDOR_ID
+#define ASSOCIATED_SENSOR_VENDOR_ID 0xE100
+#endif
+#ifndef ASSOCIATED_SENSOR_PRODUCT_ID
+#define ASSOCIATED_SENSOR_PRODUCT_ID 0xFE02
+#endif
+
+// Set to 1 to measure the trait catalog cost per lock instance at startup.
+#ifndef LOCK_CATALOG_BENCHMARK
+#define LOCK_CATALOG_BENCHMARK 0
+#endif
+
 /**
  * Controller for a lock device simulated via a hardware developer kit with the following
  * GPIO artifacts:
@@ -56,6 +81,7 @@ using namespace nl::Inet;
  *   Button 1 short press: Triggers Software Update
  *   Button 1 long press: Triggers a Factory Reset
  *   Button 2: Toggles the lock state (lock/unlock)
+ *   Button 2 long press: Associates the open/close sensor of the door
  */
 class DeviceController
 {
@@ -88,6 +114,7 @@ public:
     // a lock/unlock on-command request (e.g. from Penja).
     struct LockOnCommandRequestData
     {
+        uint8_t instance;
         Action_t action;
         int32_t actor;
     };
@@ -96,34 +123,50 @@ public:
     void Init(void);
 
     // Called on every cycle of the Application Task event loop.
-    static void EventLoopCycle(void);
+    // Returns the number of milliseconds until it must be called again.
+    static uint32_t EventLoopCycle(void);
 
     // Accessor methods
-    bool IsUnlocked();
+    bool IsUnlocked(uint8_t aInstance = PHYSICAL_LOCK_INDEX);
     void EnableAutoLock(bool aOn);
     void SetAutoLockDuration(uint32_t aDurationInSeconds);
-    bool IsLockingActionInProgress();
+    bool IsLockingActionInProgress(uint8_t aInstance = PHYSICAL_LOCK_INDEX);
+
+    // Whether the bolt of the lock cannot be extended because the associated
+    // sensor reports the door open. May be called from any task.
+    bool IsDoorReportedOpen(uint8_t aInstance);
 
     // Handlers.
     static void LockOnCommandRequestEventHandler(void * data);
 
     // Utility Methods
-    void PostLockOnCommandRequestEvent(int32_t aActor, Action_t aAction);
+    bool PostLockOnCommandRequestEvent(uint8_t aInstance, int32_t aActor, Action_t aAction);
 
 private:
-    // Current state of the bolt lock.
-    State_t mState;
+    // State of one bolt lock.
+    struct LockInstance
+    {
+        // Current state of the bolt lock.
+        State_t State;
+        // If auto-lock is enabled, then this is set to true as soon as the
+        // lock is unlocked. This is then used to cancel auto-lock if the lock is
+        // locked before the auto-lock deadline.
+        bool AutoLockTimerArmed;
+        // Monotonic times at which the bolt stops moving and at which auto-lock
+        // kicks in, if pending.
+        uint64_t MovementDeadlineMs;
+        uint64_t AutoLockDeadlineMs;
+    };
+
+    // Indexed by BoltLockTrait instance id.
+    LockInstance mLocks[LOCK_INSTANCE_COUNT];
 
     // Whether a "long press" button event is in flight.
     bool mLongPressButtonEventInFlight;
 
-    // Auto-lock management.
+    // Auto-lock management, common to all the locks.
     // Tells whether auto-lock is enabled or not.
     bool mAutoLockEnabled;
-    // If auto-lock is enabled, then this is set to true as soon as the
-    // lock is unlocked. This is then used to cancel auto-lock if the lock is
-    // locked before the auto-lock timer goes off.
-    bool mAutoLockTimerArmed;
     // If auto-lock is enabled, period of time in milliseconds before auto-lock
     // kicks in after the lock is unlocked.
     uint32_t mAutoLockDurationSeconds;
@@ -134,14 +177,20 @@ private:
 
     // ConnectivityState displayed on a LED.
     ConnectivityState mConnectivityState;
+    static bool AreServiceSubscriptionsEstablished(void);
 
     // DeviceDescription client.
     DeviceDescriptionClient mDeviceDescriptionClient;
 
-    // Device Timer managemement.
+    // Open/close sensor of the door, found by the Identify request. The bolt
+    // is not extended while it reports the door open.
+    AssociatedSensor mAssociatedSensor;
+
+    // Device Timer managemement. The timer runs until the earliest deadline
+    // of all the locks; mTimerContext is the context of that deadline.
     TimerContext_t mTimerContext;
-    void StartTimer(uint32_t aTimeoutMs);
-    void CancelTimer(void);
+    void StartTimer(uint8_t aInstance, TimerContext_t aContext, uint32_t aTimeoutMs);
+    void RearmTimer(void);
 
     // Button event handlers.
     static void LockButtonEventHandler(void);
@@ -163,9 +212,13 @@ private:
     // Lock/Unlock actions go through an "initiated" and then "completed"
     // sequence of events to simulate the movement of the bolt lock.
     // Helper methods to support this sequence of events.
-    bool InitiateAction(int32_t aActor, Action_t aAction);
-    void ActionCompleted(Action_t aAction);
-    void ActionInitiated(Action_t aAction, int32_t aActor);
+    bool InitiateAction(uint8_t aInstance, int32_t aActor, Action_t aAction);
+    void ActionCompleted(uint8_t aInstance, Action_t aAction);
+    void ActionInitiated(uint8_t aInstance, Action_t aAction, int32_t aActor);
+
+#if LOCK_CATALOG_BENCHMARK
+    static void RunCatalogBenchmark(void);
+#endif
 
     // Expose singleton object.
     friend DeviceController & GetDeviceController(void);
@@ -107,7 +107,9 @@
  *
  * Enable support for Weave-over-BLE (WoBLE).
  */
+#ifndef WEAVE_DEVICE_CONFIG_ENABLE_WOBLE
 #define WEAVE_DEVICE_CONFIG_ENABLE_WOBLE 1
+#endif
 
 /**
  * WEAVE_DEVICE_CONFIG_ENABLE_WEAVE_TIME_SERVICE_TIME_SYNC
@@ -117,14 +119,32 @@
  */
 #define WEAVE_DEVICE_CONFIG_ENABLE_WEAVE_TIME_SERVICE_TIME_SYNC 1
 
+/**
+ * WDM_MAX_LOCAL_SUBSCRIBERS
+ *
+ * Phones and peer devices that may subscribe to the lock at once over the
+ * local network (see AcceptLocalSubscribers() in GenericWDMFeature.h).
+ */
+#ifndef WDM_MAX_LOCAL_SUBSCRIBERS
+#define WDM_MAX_LOCAL_SUBSCRIBERS 4
+#endif
+
+/**
+ * WDM_PUBLISHER_MAX_NUM_SUBSCRIPTION_HANDLERS
+ *
+ * The service counter-subscription and the local subscribers.
+ */
+#define WDM_PUBLISHER_MAX_NUM_SUBSCRIPTION_HANDLERS (1 + WDM_MAX_LOCAL_SUBSCRIBERS)
+
 /**
  * WEAVE_CONFIG_MAX_BINDINGS
  *
  * Maximum number of simultaneously active bindings per WeaveExchangeManager
- * 1 (Time Sync) + 2 (Two 1-way subscriptions) + 1 (Software Update) = 4
- * in the worst case. Keeping another 4 as buffer.
+ * 1 (Time Sync) + 2 (Two 1-way subscriptions) + 1 (Software Update) +
+ * 1 (Associated sensor) + WDM_MAX_LOCAL_SUBSCRIBERS = 9 in the worst case.
+ * Keeping another 4 as buffer.
  */
-#define WEAVE_CONFIG_MAX_BINDINGS 8
+#define WEAVE_CONFIG_MAX_BINDINGS (9 + WDM_MAX_LOCAL_SUBSCRIBERS)
 
 /**
  * WEAVE_CONFIG_EVENT_LOGGING_WDM_OFFLOAD
@@ -140,6 +160,15 @@
  */
 #define WEAVE_CONFIG_EVENT_LOGGING_UTC_TIMESTAMPS 1
 
+/**
+ * WEAVE_CONFIG_EVENT_LOGGING_BYTE_THRESHOLD
+ *
+ * Number of bytes of events logged after which the event log is offloaded.
+ * Above WDM_EVENT_OFFLOAD_BATCH_BYTES, so that the offloads follow the
+ * importance of the events (see WDMFeatureBase::OnEventLogged()).
+ */
+#define WEAVE_CONFIG_EVENT_LOGGING_BYTE_THRESHOLD (4096)
+
 /**
  * WEAVE_DEVICE_CONFIG_EVENT_LOGGING_DEBUG_BUFFER_SIZE
  *
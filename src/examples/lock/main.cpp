@@ -28,6 +28,9 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include <Weave/DeviceLayer/WeaveDeviceLayer.h>
+
+#if WEAVE_DEVICE_CONFIG_ENABLE_THREAD
 #include <openthread/instance.h>
 #include <openthread/thread.h>
 #include <openthread/tasklet.h>
@@ -37,8 +40,9 @@
 #include <openthread/icmp6.h>
 #include <openthread/platform/openthread-system.h>
 
-#include <Weave/DeviceLayer/WeaveDeviceLayer.h>
 #include <Weave/DeviceLayer/ThreadStackManager.h>
+#endif // WEAVE_DEVICE_CONFIG_ENABLE_THREAD
+
 #include <Weave/DeviceLayer/internal/testing/ConfigUnitTest.h>
 #include <Weave/DeviceLayer/internal/testing/GroupKeyStoreUnitTest.h>
 #include <Weave/DeviceLayer/internal/testing/SystemClockUnitTest.h>
@@ -69,12 +73,15 @@ int main(void)
     // Platform-specific initializations. Weave logging not setup yet.
     GetHardwarePlatform().Init();
 
+#if WEAVE_DEVICE_CONFIG_ENABLE_THREAD
     otSysInit(0, NULL); // This must go here for efr32 (i.e. before either OW or OT stack inits)
+#endif
 
     WeaveLogProgress(Support, "Initializing the Weave stack");
     ret = PlatformMgr().InitWeaveStack();
     SuccessOrAbort(ret, "PlatformMgr().InitWeaveStack() failed.");
 
+#if WEAVE_DEVICE_CONFIG_ENABLE_THREAD
     WeaveLogProgress(Support, "Initializing the OpenThread stack");
     ret = ThreadStackMgr().InitThreadStack();
     SuccessOrAbort(ret, "ThreadStackMgr().InitThreadStack() failed.");
@@ -92,14 +99,17 @@ int main(void)
         ret                                     = ConnectivityMgr().SetThreadPollingConfig(pollingConfig);
         SuccessOrAbort(ret, "ConnectivityMgr().SetThreadPollingConfig() failed.");
     }
+#endif // WEAVE_DEVICE_CONFIG_ENABLE_THREAD
 
     WeaveLogProgress(Support, "Starting the Weave task");
     ret = PlatformMgr().StartEventLoopTask();
     SuccessOrAbort(ret, "PlatformMgr().StartEventLoopTask() failed.");
 
+#if WEAVE_DEVICE_CONFIG_ENABLE_THREAD
     WeaveLogProgress(Support, "Starting the OpenThread task");
     ret = ThreadStackMgrImpl().StartThreadTask();
     SuccessOrAbort(ret, "ThreadStackMgr().StartThreadTask() failed.");
+#endif // WEAVE_DEVICE_CONFIG_ENABLE_THREAD
 
     WeaveLogProgress(Support, "Initializing the DeviceController");
     GetDeviceController().Init();
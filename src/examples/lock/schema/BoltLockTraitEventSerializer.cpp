@@ -0,0 +1,110 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "BoltLockTraitEventSerializer.h"
+
+namespace Schema {
+namespace Weave {
+namespace Trait {
+namespace Security {
+namespace BoltLockTrait {
+
+using namespace ::nl::Weave::TLV;
+
+// Context tags of the fields, copied from the field descriptors (checked by
+// EVENT_SERIALIZER_SELF_CHECK).
+enum
+{
+    kTag_BoltActuatorStateChangeEvent_State         = 1,
+    kTag_BoltActuatorStateChangeEvent_ActuatorState = 2,
+    kTag_BoltActuatorStateChangeEvent_LockedState   = 3,
+    kTag_BoltActuatorStateChangeEvent_BoltLockActor = 4,
+
+    kTag_BoltLockActorStruct_Method     = 1,
+    kTag_BoltLockActorStruct_Originator = 2,
+    kTag_BoltLockActorStruct_Agent      = 3,
+};
+
+// Index of the nullable fields in __nullified_fields__.
+enum
+{
+    kNullableField_BoltLockActorStruct_Originator = 0,
+    kNullableField_BoltLockActorStruct_Agent      = 1,
+};
+
+static WEAVE_ERROR PutNullableByteString(TLVWriter & writer, uint64_t tag, const nl::SerializedByteString & value, bool isNull)
+{
+    return isNull ? writer.PutNull(tag) : writer.PutBytes(tag, value.mBuf, value.mLen);
+}
+
+static WEAVE_ERROR SerializeBoltLockActor(TLVWriter & writer, uint64_t tag, const BoltLockActorStruct & actor)
+{
+    WEAVE_ERROR err;
+    TLVType container;
+
+    err = writer.StartContainer(tag, kTLVType_Structure, container);
+    SuccessOrExit(err);
+
+    err = writer.Put(ContextTag(kTag_BoltLockActorStruct_Method), actor.method);
+    SuccessOrExit(err);
+
+    err = PutNullableByteString(writer, ContextTag(kTag_BoltLockActorStruct_Originator), actor.originator,
+                                GET_FIELD_NULLIFIED_BIT(actor.__nullified_fields__, kNullableField_BoltLockActorStruct_Originator));
+    SuccessOrExit(err);
+
+    err = PutNullableByteString(writer, ContextTag(kTag_BoltLockActorStruct_Agent), actor.agent,
+                                GET_FIELD_NULLIFIED_BIT(actor.__nullified_fields__, kNullableField_BoltLockActorStruct_Agent));
+    SuccessOrExit(err);
+
+    err = writer.EndContainer(container);
+
+exit:
+    return err;
+}
+
+WEAVE_ERROR SerializeEvent(TLVWriter & writer, uint64_t tag, const BoltActuatorStateChangeEvent & event)
+{
+    WEAVE_ERROR err;
+    TLVType container;
+
+    err = writer.StartContainer(tag, kTLVType_Structure, container);
+    SuccessOrExit(err);
+
+    err = writer.Put(ContextTag(kTag_BoltActuatorStateChangeEvent_State), event.state);
+    SuccessOrExit(err);
+
+    err = writer.Put(ContextTag(kTag_BoltActuatorStateChangeEvent_ActuatorState), event.actuatorState);
+    SuccessOrExit(err);
+
+    err = writer.Put(ContextTag(kTag_BoltActuatorStateChangeEvent_LockedState), event.lockedState);
+    SuccessOrExit(err);
+
+    err = SerializeBoltLockActor(writer, ContextTag(kTag_BoltActuatorStateChangeEvent_BoltLockActor), event.boltLockActor);
+    SuccessOrExit(err);
+
+    err = writer.EndContainer(container);
+
+exit:
+    return err;
+}
+
+} // namespace BoltLockTrait
+} // namespace Security
+} // namespace Trait
+} // namespace Weave
+} // namespace Schema
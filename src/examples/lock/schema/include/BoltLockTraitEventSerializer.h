@@ -0,0 +1,44 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      Direct TLV serializers of the BoltLockTrait events (see EventSerializer.h).
+ */
+
+#ifndef BOLT_LOCK_TRAIT_EVENT_SERIALIZER_H
+#define BOLT_LOCK_TRAIT_EVENT_SERIALIZER_H
+
+#include "BoltLockTrait.h"
+
+namespace Schema {
+namespace Weave {
+namespace Trait {
+namespace Security {
+namespace BoltLockTrait {
+
+// Must match BoltActuatorStateChangeEventFieldDescriptors and BoltLockActorStructFieldDescriptors.
+WEAVE_ERROR SerializeEvent(nl::Weave::TLV::TLVWriter & writer, uint64_t tag, const BoltActuatorStateChangeEvent & event);
+
+} // namespace BoltLockTrait
+} // namespace Security
+} // namespace Trait
+} // namespace Weave
+} // namespace Schema
+
+#endif // BOLT_LOCK_TRAIT_EVENT_SERIALIZER_H
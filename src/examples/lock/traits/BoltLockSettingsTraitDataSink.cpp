@@ -23,7 +23,11 @@
 #include "BoltLockSettingsTraitDataSink.h"
 #include "BoltLockSettingsTrait.h"
 
+#include "AppPersistentStorage.h"
 #include "DeviceController.h"
+#include "TraitLeafTable.h"
+
+#include <inttypes.h>
 
 using namespace nl::Weave::TLV;
 using namespace nl::Weave::Profiles::DataManagement;
@@ -31,41 +35,107 @@ using namespace nl::Weave::Profiles::DataManagement;
 using namespace Schema::Weave::Trait::Security;
 using namespace Schema::Weave::Trait::Security::BoltLockSettingsTrait;
 
-BoltLockSettingsTraitDataSink::BoltLockSettingsTraitDataSink() : TraitDataSink(&BoltLockSettingsTrait::TraitSchema) {}
+BoltLockSettingsTraitDataSink::BoltLockSettingsTraitDataSink() :
+    TraitDataSink(&BoltLockSettingsTrait::TraitSchema), mIsStateDirty(false)
+{
+    // The defaults of the DeviceController.
+    mState.Version            = 0;
+    mState.AutoRelockOn       = false;
+    mState.AutoRelockDuration = 0;
+}
+
+WEAVE_ERROR BoltLockSettingsTraitDataSink::Init(void)
+{
+    PersistedState state;
+
+    if (!AppPersistentStorage::ReadRecord(AppPersistentStorage::kRecordId_SettingsSink, state))
+    {
+        return WEAVE_NO_ERROR;
+    }
+
+    mState = state;
+    GetDeviceController().EnableAutoLock(mState.AutoRelockOn);
+    GetDeviceController().SetAutoLockDuration(mState.AutoRelockDuration);
+
+    // The subscribe request will offer this version to the service.
+    SetVersion(mState.Version);
+
+    WeaveLogProgress(Support, "Restored bolt lock settings (version 0x%" PRIx64 "): Auto Relock %s, %" PRIu32 " secs",
+                     mState.Version, (mState.AutoRelockOn) ? "ENABLED" : "DISABLED", mState.AutoRelockDuration);
+
+    return WEAVE_NO_ERROR;
+}
 
 WEAVE_ERROR
 BoltLockSettingsTraitDataSink::SetLeafData(PropertyPathHandle aLeafHandle, TLVReader & aReader)
 {
-    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    typedef BoltLockSettingsTraitDataSink Sink;
 
-    switch (aLeafHandle)
+    static constexpr TraitLeafDecoder<Sink> kLeafDecoders[] = {
+        TRAIT_LEAF_SETTER(BoltLockSettingsTrait::kPropertyHandle_AutoRelockOn, Sink, bool, SetAutoRelockOn),
+        TRAIT_LEAF_SETTER(BoltLockSettingsTrait::kPropertyHandle_AutoRelockDuration, Sink, uint32_t, SetAutoRelockDuration),
+    };
+    static_assert(IsTraitLeafTableValid(kLeafDecoders, BoltLockSettingsTrait::kLastSchemaHandle),
+                  "BoltLockSettingsTrait leaf table does not match the schema");
+
+    return DecodeTraitLeaf(kLeafDecoders, aLeafHandle, *this, aReader);
+}
+
+WEAVE_ERROR BoltLockSettingsTraitDataSink::OnEvent(uint16_t aType, void * aInEventParam)
+{
+    // The new data version is known once all the data of a notify is applied.
+    if (aType == kEventChangeEnd)
     {
-    case BoltLockSettingsTrait::kPropertyHandle_AutoRelockOn: {
-        bool auto_relock_on;
-        err = aReader.Get(auto_relock_on);
-        nlREQUIRE_SUCCESS(err, exit);
+        SaveState();
+    }
 
-        GetDeviceController().EnableAutoLock(auto_relock_on);
+    return WEAVE_NO_ERROR;
+}
 
-        WeaveLogProgress(Support, "Auto Relock %s", (auto_relock_on) ? "ENABLED" : "DISABLED");
-        break;
+void BoltLockSettingsTraitDataSink::SetAutoRelockOn(bool aAutoRelockOn)
+{
+    // A full re-sync sends every leaf; only apply the ones that changed.
+    if (aAutoRelockOn == mState.AutoRelockOn)
+    {
+        return;
     }
 
-    case BoltLockSettingsTrait::kPropertyHandle_AutoRelockDuration: {
-        uint32_t auto_lock_duration = 0;
-        err                         = aReader.Get(auto_lock_duration);
-        nlREQUIRE_SUCCESS(err, exit);
+    mState.AutoRelockOn = aAutoRelockOn;
+    mIsStateDirty       = true;
+    GetDeviceController().EnableAutoLock(aAutoRelockOn);
 
-        GetDeviceController().SetAutoLockDuration(auto_lock_duration);
+    WeaveLogProgress(Support, "Auto Relock %s", (aAutoRelockOn) ? "ENABLED" : "DISABLED");
+}
 
-        WeaveLogProgress(Support, "Auto Relock Duration (secs): %u", auto_lock_duration);
-        break;
+void BoltLockSettingsTraitDataSink::SetAutoRelockDuration(uint32_t aAutoRelockDuration)
+{
+    if (aAutoRelockDuration == mState.AutoRelockDuration)
+    {
+        return;
     }
 
-    default:
-        break;
+    mState.AutoRelockDuration = aAutoRelockDuration;
+    mIsStateDirty             = true;
+    GetDeviceController().SetAutoLockDuration(aAutoRelockDuration);
+
+    WeaveLogProgress(Support, "Auto Relock Duration (secs): %u", aAutoRelockDuration);
+}
+
+void BoltLockSettingsTraitDataSink::SaveState(void)
+{
+    WEAVE_ERROR err;
+
+    if (!IsVersionValid() || (GetVersion() == mState.Version && !mIsStateDirty))
+    {
+        return;
     }
 
-exit:
-    return err;
+    mState.Version = GetVersion();
+    mIsStateDirty  = false;
+
+    err = AppPersistentStorage::WriteRecord(AppPersistentStorage::kRecordId_SettingsSink, mState);
+    if (err != WEAVE_NO_ERROR)
+    {
+        WeaveLogError(Support, "Failed to save bolt lock settings: %s", nl::ErrorStr(err));
+    }
 }
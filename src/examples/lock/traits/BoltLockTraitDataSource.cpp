@@ -23,6 +23,8 @@
 
 #include "BoltLockTraitDataSource.h"
 #include "BoltLockTrait.h"
+#include "BoltLockTraitEventSerializer.h"
+#include "EventSerializer.h"
 #include "WDMFeature.h"
 #include <DeviceController.h>
 #include <AppTask.h>
@@ -30,24 +32,61 @@
 #include <Weave/DeviceLayer/WeaveDeviceLayer.h>
 #include <Weave/Support/TraitEventUtils.h>
 
+#include <algorithm>
+#include <string.h>
+
 using namespace nl::Weave;
 using namespace nl::Weave::TLV;
 using namespace nl::Weave::Profiles::DataManagement;
 using namespace Schema::Weave::Trait::Security;
 using namespace Schema::Weave::Trait::Security::BoltLockTrait;
 
+ResponseBufferPool BoltLockTraitDataSource::sResponseBufferPool;
+
 BoltLockTraitDataSource::BoltLockTraitDataSource() : TraitDataSource(&BoltLockTrait::TraitSchema)
 {
-    mLockedState   = BOLT_LOCKED_STATE_LOCKED;
-    mLockActor     = BOLT_LOCK_ACTOR_METHOD_PHYSICAL;
-    mActuatorState = BOLT_ACTUATOR_STATE_OK;
-    mState         = BOLT_STATE_EXTENDED;
+    mTraitState.LockActor     = BOLT_LOCK_ACTOR_METHOD_PHYSICAL;
+    mTraitState.ActuatorState = BOLT_ACTUATOR_STATE_OK;
+    mTraitState.State         = BOLT_STATE_EXTENDED;
+
+    // The initial state dates from now, if the current UTC time is known.
+    SetLockedState(BOLT_LOCKED_STATE_LOCKED);
+
+    mPublishedTraitState.Init(mTraitState);
+
+    memset(&mCommandStats, 0, sizeof(mCommandStats));
+    mPublishedCommandStats.Init(mCommandStats);
+}
+
+void BoltLockTraitDataSource::SetLockedState(int32_t aLockedState)
+{
+    uint64_t currentTime = 0;
+
+    // Left at 0 if real time is not synced yet.
+    System::Platform::Layer::GetClock_RealTimeMS(currentTime);
+
+    mTraitState.LockedState              = aLockedState;
+    mTraitState.LockedStateLastChangedAt = static_cast<int64_t>(currentTime);
+}
+
+// Makes the working copy visible to GetLeafData(). Called by the AppTask before
+// the changed properties are marked dirty, so that the notification engine
+// never reads older data than what it was told about.
+void BoltLockTraitDataSource::PublishTraitState(void)
+{
+    mPublishedTraitState.Publish(mTraitState);
+}
+
+// The lock controlled through this instance, which is also its trait instance id.
+uint8_t BoltLockTraitDataSource::GetInstanceIndex(void)
+{
+    return (uint8_t)(this - &GetWDMFeature().GetSource<BoltLockTraitDataSources>(0));
 }
 
 bool BoltLockTraitDataSource::IsLocked()
 {
     bool lock_state = false;
-    if (mLockedState == BOLT_LOCKED_STATE_LOCKED)
+    if (mTraitState.LockedState == BOLT_LOCKED_STATE_LOCKED)
     {
         lock_state = true;
     }
@@ -57,11 +96,13 @@ bool BoltLockTraitDataSource::IsLocked()
 
 void BoltLockTraitDataSource::InitiateLock(int32_t aLockActor)
 {
-    Lock();
+    mTraitState.LockActor     = aLockActor;
+    mTraitState.ActuatorState = BOLT_ACTUATOR_STATE_LOCKING;
+    mTraitState.State         = BOLT_STATE_EXTENDED;
+
+    PublishTraitState();
 
-    mLockActor     = aLockActor;
-    mActuatorState = BOLT_ACTUATOR_STATE_LOCKING;
-    mState         = BOLT_STATE_EXTENDED;
+    Lock();
 
     SetDirty(BoltLockTrait::kPropertyHandle_State);
     SetDirty(BoltLockTrait::kPropertyHandle_BoltLockActor_Method);
@@ -69,26 +110,29 @@ void BoltLockTraitDataSource::InitiateLock(int32_t aLockActor)
 
     Unlock();
 
+    // Goes out with the held trait change (see WDMFeatureBase::OnEventLogged()).
     BoltActuatorStateChangeEvent ev;
-    EventOptions options(true);
+    EventOptions options;
     ev.state                = BOLT_STATE_EXTENDED;
     ev.actuatorState        = BOLT_ACTUATOR_STATE_LOCKING;
     ev.lockedState          = BOLT_LOCKED_STATE_UNLOCKED;
     ev.boltLockActor.method = aLockActor;
     ev.boltLockActor.SetOriginatorNull();
     ev.boltLockActor.SetAgentNull();
-    nl::LogEvent(&ev, options);
+    LogEventDirect(ev, options);
 
-    GetWDMFeature().ProcessTraitChanges();
+    GetWDMFeature().ProcessTraitChanges(WDMFeature::kTraitChange_Intermediate);
 }
 
 void BoltLockTraitDataSource::InitiateUnlock(int32_t aLockActor)
 {
-    Lock();
+    mTraitState.LockActor     = aLockActor;
+    mTraitState.ActuatorState = BOLT_ACTUATOR_STATE_UNLOCKING;
+    SetLockedState(BOLT_LOCKED_STATE_UNLOCKED);
+
+    PublishTraitState();
 
-    mLockActor     = aLockActor;
-    mActuatorState = BOLT_ACTUATOR_STATE_UNLOCKING;
-    mLockedState   = BOLT_LOCKED_STATE_UNLOCKED;
+    Lock();
 
     SetDirty(BoltLockTrait::kPropertyHandle_BoltLockActor_Method);
     SetDirty(BoltLockTrait::kPropertyHandle_ActuatorState);
@@ -97,25 +141,28 @@ void BoltLockTraitDataSource::InitiateUnlock(int32_t aLockActor)
 
     Unlock();
 
+    // Goes out with the held trait change, see InitiateLock().
     BoltActuatorStateChangeEvent ev;
-    EventOptions options(true);
+    EventOptions options;
     ev.state                = BOLT_STATE_EXTENDED;
     ev.actuatorState        = BOLT_ACTUATOR_STATE_UNLOCKING;
     ev.lockedState          = BOLT_LOCKED_STATE_UNLOCKED;
     ev.boltLockActor.method = aLockActor;
     ev.boltLockActor.SetOriginatorNull();
     ev.boltLockActor.SetAgentNull();
-    nl::LogEvent(&ev, options);
+    LogEventDirect(ev, options);
 
-    GetWDMFeature().ProcessTraitChanges();
+    GetWDMFeature().ProcessTraitChanges(WDMFeature::kTraitChange_Intermediate);
 }
 
 void BoltLockTraitDataSource::LockingSuccessful(void)
 {
-    Lock();
+    mTraitState.ActuatorState = BOLT_ACTUATOR_STATE_OK;
+    SetLockedState(BOLT_LOCKED_STATE_LOCKED);
+
+    PublishTraitState();
 
-    mActuatorState = BOLT_ACTUATOR_STATE_OK;
-    mLockedState   = BOLT_LOCKED_STATE_LOCKED;
+    Lock();
 
     SetDirty(BoltLockTrait::kPropertyHandle_ActuatorState);
     SetDirty(BoltLockTrait::kPropertyHandle_LockedState);
@@ -124,24 +171,26 @@ void BoltLockTraitDataSource::LockingSuccessful(void)
     Unlock();
 
     BoltActuatorStateChangeEvent ev;
-    EventOptions options(true);
+    EventOptions options;
     ev.state                = BOLT_STATE_EXTENDED;
     ev.actuatorState        = BOLT_ACTUATOR_STATE_OK;
     ev.lockedState          = BOLT_LOCKED_STATE_LOCKED;
-    ev.boltLockActor.method = mLockActor;
+    ev.boltLockActor.method = mTraitState.LockActor;
     ev.boltLockActor.SetOriginatorNull();
     ev.boltLockActor.SetAgentNull();
-    nl::LogEvent(&ev, options);
+    LogEventDirect(ev, options);
 
     GetWDMFeature().ProcessTraitChanges();
 }
 
 void BoltLockTraitDataSource::UnlockingSuccessful(void)
 {
-    Lock();
+    mTraitState.State         = BOLT_STATE_RETRACTED;
+    mTraitState.ActuatorState = BOLT_ACTUATOR_STATE_OK;
 
-    mState         = BOLT_STATE_RETRACTED;
-    mActuatorState = BOLT_ACTUATOR_STATE_OK;
+    PublishTraitState();
+
+    Lock();
 
     SetDirty(BoltLockTrait::kPropertyHandle_State);
     SetDirty(BoltLockTrait::kPropertyHandle_ActuatorState);
@@ -149,66 +198,101 @@ void BoltLockTraitDataSource::UnlockingSuccessful(void)
     Unlock();
 
     BoltActuatorStateChangeEvent ev;
-    EventOptions options(true);
+    EventOptions options;
     ev.state                = BOLT_STATE_RETRACTED;
     ev.actuatorState        = BOLT_ACTUATOR_STATE_OK;
     ev.lockedState          = BOLT_LOCKED_STATE_UNLOCKED;
-    ev.boltLockActor.method = mLockActor;
+    ev.boltLockActor.method = mTraitState.LockActor;
     ev.boltLockActor.SetOriginatorNull();
     ev.boltLockActor.SetAgentNull();
-    nl::LogEvent(&ev, options);
+    LogEventDirect(ev, options);
 
     GetWDMFeature().ProcessTraitChanges();
 }
 
 WEAVE_ERROR BoltLockTraitDataSource::GetLeafData(PropertyPathHandle aLeafHandle, uint64_t aTagToWrite, TLVWriter & aWriter)
 {
-    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    static constexpr TraitLeafEncoder<TraitState> kLeafEncoders[] = {
+        TRAIT_LEAF_FIELD(BoltLockTrait::kPropertyHandle_State, TraitState, State),
+        TRAIT_LEAF_FIELD(BoltLockTrait::kPropertyHandle_ActuatorState, TraitState, ActuatorState),
+        TRAIT_LEAF_FIELD(BoltLockTrait::kPropertyHandle_LockedState, TraitState, LockedState),
+        TRAIT_LEAF_NONE(BoltLockTrait::kPropertyHandle_BoltLockActor),
+        TRAIT_LEAF_FIELD(BoltLockTrait::kPropertyHandle_BoltLockActor_Method, TraitState, LockActor),
+        TRAIT_LEAF_NULL(BoltLockTrait::kPropertyHandle_BoltLockActor_Originator, TraitState),
+        TRAIT_LEAF_NULL(BoltLockTrait::kPropertyHandle_BoltLockActor_Agent, TraitState),
+        TRAIT_LEAF_FIELD(BoltLockTrait::kPropertyHandle_LockedStateLastChangedAt, TraitState, LockedStateLastChangedAt),
+    };
+    static_assert(IsTraitLeafTableValid(kLeafEncoders, BoltLockTrait::kLastSchemaHandle),
+                  "BoltLockTrait leaf table does not match the schema");
+
+    // Lock-free: the AppTask may be publishing a new state concurrently.
+    const TraitState & state = mNotifiedTraitState.Get(mPublishedTraitState, GetVersion());
+
+    return EncodeTraitLeaf(kLeafEncoders, aLeafHandle, state, aTagToWrite, aWriter);
+}
 
-    switch (aLeafHandle)
+#if BOLT_LOCK_TRAIT_FANOUT_BENCHMARK
+void BoltLockTraitDataSource::RunFanOutBenchmark(void)
+{
+    enum
     {
-    case BoltLockTrait::kPropertyHandle_State:
-        err = aWriter.Put(aTagToWrite, mState);
-        SuccessOrExit(err);
-        break;
-
-    case BoltLockTrait::kPropertyHandle_ActuatorState:
-        err = aWriter.Put(aTagToWrite, mActuatorState);
-        SuccessOrExit(err);
-        break;
+        kIterations = 1000
+    };
+    static const int kSubscriberCounts[] = { 1, 4, 8 };
+    uint8_t buf[64];
 
-    case BoltLockTrait::kPropertyHandle_LockedState:
-        err = aWriter.Put(aTagToWrite, mLockedState);
-        SuccessOrExit(err);
-        break;
+    for (size_t n = 0; n < sizeof(kSubscriberCounts) / sizeof(kSubscriberCounts[0]); n++)
+    {
+        uint64_t elapsedUs[2];
 
-    case BoltLockTrait::kPropertyHandle_BoltLockActor_Method:
-        err = aWriter.Put(aTagToWrite, mLockActor);
-        SuccessOrExit(err);
-        break;
+        // Each iteration is a new version of the trait, notified to every subscriber.
+        // Without the snapshot, the published state is read again for every leaf.
+        for (int shared = 0; shared < 2; shared++)
+        {
+            uint64_t startUs = System::Platform::Layer::GetClock_MonotonicHiRes();
 
-    case BoltLockTrait::kPropertyHandle_LockedStateLastChangedAt: {
-        uint64_t currentTime = 0;
-        System::Platform::Layer::GetClock_RealTimeMS(currentTime);
-        err = aWriter.Put(aTagToWrite, static_cast<int64_t>(currentTime));
-        SuccessOrExit(err);
-        break;
-    }
+            for (int iteration = 0; iteration < kIterations; iteration++)
+            {
+                mNotifiedTraitState.Invalidate();
+
+                for (int subscriber = 0; subscriber < kSubscriberCounts[n]; subscriber++)
+                {
+                    TLVWriter writer;
+                    TLVType container;
+
+                    writer.Init(buf, sizeof(buf));
+                    writer.StartContainer(AnonymousTag, kTLVType_Structure, container);
+                    for (PropertyPathHandle handle = kRootPropertyPathHandle + 1; handle <= BoltLockTrait::kLastSchemaHandle;
+                         handle++)
+                    {
+                        if (handle == BoltLockTrait::kPropertyHandle_BoltLockActor)
+                        {
+                            continue;
+                        }
+                        if (!shared)
+                        {
+                            mNotifiedTraitState.Invalidate();
+                        }
+                        GetLeafData(handle, ContextTag(handle), writer);
+                    }
+                    writer.EndContainer(container);
+                }
+            }
 
-    case BoltLockTrait::kPropertyHandle_BoltLockActor_Originator:
-    case BoltLockTrait::kPropertyHandle_BoltLockActor_Agent:
-        err = aWriter.PutNull(aTagToWrite);
-        SuccessOrExit(err);
-        break;
+            elapsedUs[shared] = System::Platform::Layer::GetClock_MonotonicHiRes() - startUs;
+        }
 
-    default:
-        WeaveLogError(Support, "Unexpected Leaf");
-        break;
+        // Each figure covers the notifies of one version to all the subscribers.
+        WeaveLogProgress(Support,
+                         "BoltLockTrait notify encode, %d subscribers: %" PRIu32 " ns per version reading every leaf, %" PRIu32
+                         " ns per version with a snapshot (%d versions)",
+                         kSubscriberCounts[n], (uint32_t)(elapsedUs[0] * 1000 / kIterations),
+                         (uint32_t)(elapsedUs[1] * 1000 / kIterations), kIterations);
     }
 
-exit:
-    return err;
+    mNotifiedTraitState.Invalidate();
 }
+#endif // BOLT_LOCK_TRAIT_FANOUT_BENCHMARK
 
 void BoltLockTraitDataSource::OnCustomCommand(nl::Weave::Profiles::DataManagement::Command * aCommand,
                                               const nl::Weave::WeaveMessageInfo * aMsgInfo, nl::Weave::PacketBuffer * aPayload,
@@ -219,6 +303,7 @@ void BoltLockTraitDataSource::OnCustomCommand(nl::Weave::Profiles::DataManagemen
     WEAVE_ERROR err           = WEAVE_NO_ERROR;
     uint32_t reportProfileId  = nl::Weave::Profiles::kWeaveProfile_Common;
     uint16_t reportStatusCode = nl::Weave::Profiles::Common::kStatus_BadRequest;
+    uint64_t receivedUs       = System::Platform::Layer::GetClock_MonotonicHiRes();
 
     if (aIsMustBeVersionValid)
     {
@@ -263,9 +348,11 @@ void BoltLockTraitDataSource::OnCustomCommand(nl::Weave::Profiles::DataManagemen
 
     WeaveLogError(Support, "BoltLockChangeRequest Command Valid!");
 
+    // The arguments are read in place from the payload.
     {
         int32_t changeRequestParam_State;
         int32_t changeRequestParam_Actor;
+        bool isPosted = false;
         nl::Weave::TLV::TLVType OuterContainerType;
         err = aArgumentReader.EnterContainer(OuterContainerType);
         SuccessOrExit(err);
@@ -312,28 +399,50 @@ void BoltLockTraitDataSource::OnCustomCommand(nl::Weave::Profiles::DataManagemen
 
         if (changeRequestParam_State == BOLT_STATE_RETRACTED)
         {
-            GetDeviceController().PostLockOnCommandRequestEvent(changeRequestParam_Actor, DeviceController::UNLOCK_ACTION);
+            isPosted = GetDeviceController().PostLockOnCommandRequestEvent(GetInstanceIndex(), changeRequestParam_Actor,
+                                                                           DeviceController::UNLOCK_ACTION);
         }
         else if (changeRequestParam_State == BOLT_STATE_EXTENDED)
         {
-            GetDeviceController().PostLockOnCommandRequestEvent(changeRequestParam_Actor, DeviceController::LOCK_ACTION);
+            // The AppTask would refuse it: tell the sender rather than
+            // acknowledging a lock that will not happen.
+            if (GetDeviceController().IsDoorReportedOpen(GetInstanceIndex()))
+            {
+                WeaveLogError(Support, "BoltLockChangeRequest refused: the door is open");
+                reportProfileId  = nl::Weave::Profiles::kWeaveProfile_Common;
+                reportStatusCode = nl::Weave::Profiles::Common::kStatus_Busy;
+                ExitNow(err = WEAVE_ERROR_INCORRECT_STATE);
+            }
+
+            isPosted = GetDeviceController().PostLockOnCommandRequestEvent(GetInstanceIndex(), changeRequestParam_Actor,
+                                                                           DeviceController::LOCK_ACTION);
         }
         else
         {
             // Command changeRequestParam_State value is invalid.
             err = WEAVE_ERROR_STATUS_REPORT_RECEIVED;
         }
+
+        // The command lane is full: the request was dropped, tell the sender.
+        if (err == WEAVE_NO_ERROR && !isPosted)
+        {
+            WeaveLogError(Support, "BoltLockChangeRequest dropped: the AppTask is busy");
+            reportProfileId  = nl::Weave::Profiles::kWeaveProfile_Common;
+            reportStatusCode = nl::Weave::Profiles::Common::kStatus_Busy;
+            ExitNow(err = WEAVE_ERROR_NO_MEMORY);
+        }
     }
 
     PacketBuffer::Free(aPayload);
     aPayload = NULL;
 
-    // Generate a success response right here.
+    // Generate a success response right here, in a reserved buffer: the
+    // command is already posted to the AppTask.
     if (err == WEAVE_NO_ERROR)
     {
         WeaveLogError(Support, "BoltLockChangeRequest Command Parsed!");
 
-        PacketBuffer * msgBuf = PacketBuffer::New();
+        PacketBuffer * msgBuf = sResponseBufferPool.Take();
         if (NULL == msgBuf)
         {
             reportProfileId  = nl::Weave::Profiles::kWeaveProfile_Common;
@@ -345,6 +454,8 @@ void BoltLockTraitDataSource::OnCustomCommand(nl::Weave::Profiles::DataManagemen
         aCommand->SendResponse(GetVersion(), msgBuf);
         aCommand = NULL;
         msgBuf   = NULL;
+
+        RecordCommandLatency(receivedUs, true);
     }
     else
     {
@@ -356,6 +467,8 @@ exit:
     {
         aCommand->SendError(reportProfileId, reportStatusCode, err);
         aCommand = NULL;
+
+        RecordCommandLatency(receivedUs, false);
     }
 
     if (aPayload)
@@ -364,3 +477,26 @@ exit:
         aPayload = NULL;
     }
 }
+
+// Accounts for a command answered on the Weave task. Only the success responses
+// are timed.
+void BoltLockTraitDataSource::RecordCommandLatency(uint64_t aReceivedUs, bool aIsSuccess)
+{
+    if (!aIsSuccess)
+    {
+        mCommandStats.ErrorCount++;
+        mPublishedCommandStats.Publish(mCommandStats);
+        return;
+    }
+
+    mCommandStats.Count++;
+    mCommandStats.LastUs = static_cast<uint32_t>(System::Platform::Layer::GetClock_MonotonicHiRes() - aReceivedUs);
+    mCommandStats.MaxUs  = std::max(mCommandStats.MaxUs, mCommandStats.LastUs);
+    mCommandStats.TotalUs += mCommandStats.LastUs;
+    mPublishedCommandStats.Publish(mCommandStats);
+
+    WeaveLogProgress(Support,
+                     "BoltLockChangeRequest latency: %" PRIu32 " us (mean %" PRIu32 " us, max %" PRIu32 " us, n=%" PRIu32 ")",
+                     mCommandStats.LastUs, static_cast<uint32_t>(mCommandStats.TotalUs / mCommandStats.Count), mCommandStats.MaxUs,
+                     mCommandStats.Count);
+}
@@ -32,9 +32,78 @@ using namespace ::nl::Weave::TLV;
 using namespace ::nl::Weave::DeviceLayer;
 using namespace ::Schema::Weave::Trait::Description;
 
-DeviceIdentityTraitDataSource::DeviceIdentityTraitDataSource(void) : TraitDataSource(&DeviceIdentityTrait::TraitSchema) {}
+// Leaves are the handles that follow the root.
+#define FIRST_LEAF_HANDLE (DeviceIdentityTrait::kPropertyHandle_Root + 1)
+#define LEAF_COUNT (DeviceIdentityTrait::kLastSchemaHandle - DeviceIdentityTrait::kPropertyHandle_Root)
 
-WEAVE_ERROR DeviceIdentityTraitDataSource::GetLeafData(PropertyPathHandle aLeafHandle, uint64_t aTagToWrite, TLVWriter & aWriter)
+DeviceIdentityTraitDataSource::DeviceIdentityTraitDataSource(void) :
+    CachedTraitDataSource(&DeviceIdentityTrait::TraitSchema, LEAF_COUNT)
+{
+    static_assert(LEAF_COUNT <= CACHED_TRAIT_DATA_SOURCE_MAX_LEAVES, "CACHED_TRAIT_DATA_SOURCE_MAX_LEAVES too small");
+}
+
+void DeviceIdentityTraitDataSource::OnPlatformEvent(const WeaveDeviceEvent * event)
+{
+    // Serial number and manufacturing date are factory data, and the firmware
+    // revision only changes across a reboot. The fabric id and the node id may
+    // change at runtime.
+    switch (event->Type)
+    {
+    case DeviceEventType::kFabricMembershipChange:
+    case DeviceEventType::kServiceProvisioningChange:
+        InvalidateCache();
+        break;
+
+    default:
+        break;
+    }
+}
+
+#if DEVICE_IDENTITY_TRAIT_BENCHMARK
+void DeviceIdentityTraitDataSource::RunEncodeBenchmark(void)
+{
+    enum
+    {
+        kIterations = 1000
+    };
+    uint8_t buf[CACHED_TRAIT_DATA_SOURCE_BUFFER_SIZE + 16];
+    uint64_t elapsedUs[2];
+
+    for (int cached = 0; cached < 2; cached++)
+    {
+        uint64_t startUs = ::nl::Weave::System::Platform::Layer::GetClock_MonotonicHiRes();
+
+        for (int iteration = 0; iteration < kIterations; iteration++)
+        {
+            TLVWriter writer;
+            TLVType container;
+
+            writer.Init(buf, sizeof(buf));
+            writer.StartContainer(AnonymousTag, kTLVType_Structure, container);
+            for (uint8_t i = 0; i < LEAF_COUNT; i++)
+            {
+                if (cached)
+                {
+                    GetLeafData(FIRST_LEAF_HANDLE + i, ContextTag(FIRST_LEAF_HANDLE + i), writer);
+                }
+                else
+                {
+                    EncodeLeaf(FIRST_LEAF_HANDLE + i, ContextTag(FIRST_LEAF_HANDLE + i), writer);
+                }
+            }
+            writer.EndContainer(container);
+        }
+
+        elapsedUs[cached] = ::nl::Weave::System::Platform::Layer::GetClock_MonotonicHiRes() - startUs;
+    }
+
+    WeaveLogProgress(Support, "DeviceIdentityTrait encode: %" PRIu32 " ns direct, %" PRIu32 " ns cached (%d iterations)",
+                     (uint32_t)(elapsedUs[0] * 1000 / kIterations), (uint32_t)(elapsedUs[1] * 1000 / kIterations), kIterations);
+}
+#endif // DEVICE_IDENTITY_TRAIT_BENCHMARK
+
+// Encodes a leaf from the ConfigurationManager.
+WEAVE_ERROR DeviceIdentityTraitDataSource::EncodeLeaf(PropertyPathHandle aLeafHandle, uint64_t aTagToWrite, TLVWriter & aWriter)
 {
     WEAVE_ERROR err = WEAVE_NO_ERROR;
 
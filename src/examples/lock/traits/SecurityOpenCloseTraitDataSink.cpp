@@ -0,0 +1,145 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      A trait data sink implementation for the SecurityOpenCloseTrait of the
+ *      open/close sensor associated with the lock.
+ */
+
+#include "SecurityOpenCloseTraitDataSink.h"
+
+#include <nest/trait/detector/OpenCloseTrait.h>
+#include <nest/trait/security/SecurityOpenCloseTrait.h>
+
+#include <Weave/DeviceLayer/WeaveDeviceLayer.h>
+
+#include "TraitLeafTable.h"
+
+#include <algorithm>
+#include <inttypes.h>
+#include <string.h>
+
+using namespace nl::Weave;
+using namespace nl::Weave::TLV;
+using namespace nl::Weave::Profiles::DataManagement;
+using namespace Schema::Nest::Trait::Security;
+using namespace Schema::Nest::Trait::Detector::OpenCloseTrait;
+
+SecurityOpenCloseTraitDataSink::SecurityOpenCloseTraitDataSink() :
+    TraitDataSink(&SecurityOpenCloseTrait::TraitSchema), mIsStateChanged(false)
+{
+    mState.IsKnown           = false;
+    mState.OpenCloseState    = OPEN_CLOSE_STATE_UNKNOWN;
+    mState.FirstObservedAtMs = 0;
+    mPublishedState.Init(mState);
+
+    memset(&mLatencyStats, 0, sizeof(mLatencyStats));
+    mPublishedLatencyStats.Init(mLatencyStats);
+}
+
+void SecurityOpenCloseTraitDataSink::Reset(void)
+{
+    ClearVersion();
+
+    mIsStateChanged          = false;
+    mState.IsKnown           = false;
+    mState.OpenCloseState    = OPEN_CLOSE_STATE_UNKNOWN;
+    mState.FirstObservedAtMs = 0;
+    mPublishedState.Publish(mState);
+}
+
+bool SecurityOpenCloseTraitDataSink::IsReportedOpen(void) const
+{
+    SensorState state;
+
+    mPublishedState.Read(state);
+
+    return state.IsKnown && state.OpenCloseState == OPEN_CLOSE_STATE_OPEN;
+}
+
+WEAVE_ERROR
+SecurityOpenCloseTraitDataSink::SetLeafData(PropertyPathHandle aLeafHandle, TLVReader & aReader)
+{
+    typedef SecurityOpenCloseTraitDataSink Sink;
+
+    static constexpr TraitLeafDecoder<Sink> kLeafDecoders[] = {
+        TRAIT_LEAF_SETTER(SecurityOpenCloseTrait::kPropertyHandle_OpenCloseState, Sink, int32_t, SetOpenCloseState),
+        TRAIT_LEAF_NONE(SecurityOpenCloseTrait::kPropertyHandle_FirstObservedAt),
+        TRAIT_LEAF_SETTER(SecurityOpenCloseTrait::kPropertyHandle_FirstObservedAtMs, Sink, int64_t, SetFirstObservedAtMs),
+        TRAIT_LEAF_NONE(SecurityOpenCloseTrait::kPropertyHandle_BypassRequested),
+    };
+    static_assert(IsTraitLeafTableValid(kLeafDecoders, SecurityOpenCloseTrait::kLastSchemaHandle),
+                  "SecurityOpenCloseTrait leaf table does not match the schema");
+
+    return DecodeTraitLeaf(kLeafDecoders, aLeafHandle, *this, aReader);
+}
+
+WEAVE_ERROR SecurityOpenCloseTraitDataSink::OnEvent(uint16_t aType, void * aInEventParam)
+{
+    // Publish all the leaves of a notify at once, so that the AppTask never
+    // sees a state without its timestamp.
+    if (aType == kEventChangeEnd && mIsStateChanged)
+    {
+        mIsStateChanged = false;
+        mState.IsKnown  = true;
+        mPublishedState.Publish(mState);
+
+        WeaveLogProgress(Support, "Associated sensor is %s",
+                         (mState.OpenCloseState == OPEN_CLOSE_STATE_OPEN) ? "OPEN" : "CLOSED");
+
+        RecordLatency();
+    }
+
+    return WEAVE_NO_ERROR;
+}
+
+void SecurityOpenCloseTraitDataSink::SetOpenCloseState(int32_t aOpenCloseState)
+{
+    mIsStateChanged       = mIsStateChanged || (aOpenCloseState != mState.OpenCloseState);
+    mState.OpenCloseState = aOpenCloseState;
+}
+
+void SecurityOpenCloseTraitDataSink::SetFirstObservedAtMs(int64_t aFirstObservedAtMs)
+{
+    mIsStateChanged          = mIsStateChanged || (aFirstObservedAtMs != mState.FirstObservedAtMs);
+    mState.FirstObservedAtMs = aFirstObservedAtMs;
+}
+
+void SecurityOpenCloseTraitDataSink::RecordLatency(void)
+{
+#if LOCAL_SENSOR_SHARES_CLOCK
+    int64_t latencyMs = static_cast<int64_t>(System::Platform::Layer::GetClock_MonotonicMS()) - mState.FirstObservedAtMs;
+
+    // The first notify of a subscription carries a state observed long ago.
+    if (mState.FirstObservedAtMs == 0 || latencyMs < 0 || latencyMs > UINT32_MAX)
+    {
+        return;
+    }
+
+    mLatencyStats.Count++;
+    mLatencyStats.LastMs = static_cast<uint32_t>(latencyMs);
+    mLatencyStats.MaxMs  = std::max(mLatencyStats.MaxMs, mLatencyStats.LastMs);
+    mLatencyStats.TotalMs += mLatencyStats.LastMs;
+    mPublishedLatencyStats.Publish(mLatencyStats);
+
+    WeaveLogProgress(Support, "Sensor to lock latency: %" PRIu32 " ms (mean %" PRIu32 " ms, max %" PRIu32 " ms, n=%" PRIu32 ")",
+                     mLatencyStats.LastMs, static_cast<uint32_t>(mLatencyStats.TotalMs / mLatencyStats.Count),
+                     mLatencyStats.MaxMs, mLatencyStats.Count);
+#endif
+}
@@ -30,9 +30,30 @@ class BoltLockSettingsTraitDataSink : public nl::Weave::Profiles::DataManagement
 public:
     BoltLockSettingsTraitDataSink();
 
+    // Restores the settings and their data version saved before the last reboot.
+    WEAVE_ERROR Init(void);
+
 private:
+    // Data version of the settings, saved with the settings it describes.
+    struct PersistedState
+    {
+        uint64_t Version;
+        bool AutoRelockOn;
+        uint32_t AutoRelockDuration;
+    };
+
     WEAVE_ERROR SetLeafData(nl::Weave::Profiles::DataManagement::PropertyPathHandle aLeafHandle,
                             nl::Weave::TLV::TLVReader & aReader);
+    WEAVE_ERROR OnEvent(uint16_t aType, void * aInEventParam);
+
+    void SetAutoRelockOn(bool aAutoRelockOn);
+    void SetAutoRelockDuration(uint32_t aAutoRelockDuration);
+
+    void SaveState(void);
+
+    PersistedState mState;
+    // Set when a leaf changed since the last SaveState().
+    bool mIsStateDirty;
 };
 
 #endif /* BOLT_LOCK_SETTINGS_TRAIT_DATA_SINK_H */
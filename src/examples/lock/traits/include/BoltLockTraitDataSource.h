@@ -26,11 +26,39 @@
 
 #include <Weave/Profiles/data-management/DataManagement.h>
 
+#include "ResponseBufferPool.h"
+#include "SeqLock.h"
+#include "TraitLeafTable.h"
+#include "VersionedSnapshot.h"
+
+// Set to 1 to log the cost of encoding a change for 1, 4 and 8 subscribers at startup.
+#ifndef BOLT_LOCK_TRAIT_FANOUT_BENCHMARK
+#define BOLT_LOCK_TRAIT_FANOUT_BENCHMARK 0
+#endif
+
 class BoltLockTraitDataSource : public nl::Weave::Profiles::DataManagement::TraitDataSource
 {
 public:
+    // Time from the receipt of a BoltLockChangeRequest to its response.
+    struct CommandStats
+    {
+        uint32_t Count;      // Commands answered with a success response.
+        uint32_t ErrorCount; // Commands answered with an error.
+        uint32_t LastUs;
+        uint32_t MaxUs;
+        uint64_t TotalUs;
+    };
+
     BoltLockTraitDataSource();
 
+    // Reserves the response buffers shared by the lock instances. Called once
+    // the Weave stack is initialized, with the Weave stack lock held.
+    static void ReserveResponseBuffers(void) { sResponseBufferPool.Init(); }
+    static void GetResponseBufferStats(ResponseBufferPool::Stats & stats) { sResponseBufferPool.GetStats(stats); }
+
+    // May be called from any task.
+    void GetCommandStats(CommandStats & stats) const { mPublishedCommandStats.Read(stats); }
+
     // FIXME: This is never used. The deviceController is teh source of truth, so we never
     // need to ask what the state is, the controller simply makes sure it is set accordingly.
     bool IsLocked();
@@ -40,6 +68,10 @@ public:
     void LockingSuccessful(void);
     void UnlockingSuccessful(void);
 
+#if BOLT_LOCK_TRAIT_FANOUT_BENCHMARK
+    void RunFanOutBenchmark(void);
+#endif
+
 private:
     WEAVE_ERROR GetLeafData(::nl::Weave::Profiles::DataManagement_Current::PropertyPathHandle aLeafHandle, uint64_t aTagToWrite,
                             ::nl::Weave::TLV::TLVWriter & aWriter);
@@ -49,10 +81,35 @@ private:
                          const int64_t & aExpiryTimeMicroSecond, const bool aIsMustBeVersionValid, const uint64_t & aMustBeVersion,
                          nl::Weave::TLV::TLVReader & aArgumentReader);
 
-    int32_t mLockedState;
-    int32_t mLockActor;
-    int32_t mActuatorState;
-    int32_t mState;
+    struct TraitState
+    {
+        int32_t LockedState;
+        int32_t LockActor;
+        int32_t ActuatorState;
+        int32_t State;
+        int64_t LockedStateLastChangedAt;
+    };
+
+    void SetLockedState(int32_t aLockedState);
+    void PublishTraitState(void);
+    uint8_t GetInstanceIndex(void);
+    void RecordCommandLatency(uint64_t aReceivedUs, bool aIsSuccess);
+
+    // Working copy, owned by the AppTask.
+    TraitState mTraitState;
+
+    // Snapshot read by GetLeafData() on the Weave task.
+    SeqLock<TraitState> mPublishedTraitState;
+
+    // Copy of mPublishedTraitState at the current data version, shared by the
+    // notifies of all the subscribers. Owned by the Weave task.
+    VersionedSnapshot<TraitState> mNotifiedTraitState;
+
+    // Owned by the Weave task.
+    CommandStats mCommandStats;
+    SeqLock<CommandStats> mPublishedCommandStats;
+
+    static ResponseBufferPool sResponseBufferPool;
 };
 
 #endif /* BOLT_LOCK_TRAIT_DATA_SOURCE_H */
@@ -0,0 +1,93 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      A trait data sink implementation for the SecurityOpenCloseTrait of the
+ *      open/close sensor associated with the lock.
+ */
+
+#ifndef SECURITY_OPEN_CLOSE_TRAIT_DATA_SINK_H
+#define SECURITY_OPEN_CLOSE_TRAIT_DATA_SINK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <Weave/Profiles/data-management/DataManagement.h>
+
+#include "SeqLock.h"
+
+// The sensor timestamps its state with its monotonic clock, which is also the
+// clock of the lock only when both run on the same host (posix multi-node runs).
+// The sensor-change-to-lock-aware latency is measured in that case only.
+#ifndef LOCAL_SENSOR_SHARES_CLOCK
+#define LOCAL_SENSOR_SHARES_CLOCK WEAVE_DEVICE_LAYER_TARGET_LINUX
+#endif
+
+class SecurityOpenCloseTraitDataSink : public nl::Weave::Profiles::DataManagement::TraitDataSink
+{
+public:
+    // Time from a change of state on the sensor to its application on the lock.
+    struct LatencyStats
+    {
+        uint32_t Count;
+        uint32_t LastMs;
+        uint32_t MaxMs;
+        uint64_t TotalMs;
+    };
+
+    SecurityOpenCloseTraitDataSink();
+
+    // Whether the last state received from the sensor is "open". False while
+    // the state is unknown. May be called from any task.
+    bool IsReportedOpen(void) const;
+
+    // Forgets the state and data version of the sensor, before subscribing to
+    // another one or when the subscription is lost. Must be called on the Weave task.
+    void Reset(void);
+
+    // May be called from any task.
+    void GetLatencyStats(LatencyStats & stats) const { mPublishedLatencyStats.Read(stats); }
+
+private:
+    struct SensorState
+    {
+        bool IsKnown;
+        int32_t OpenCloseState;
+        int64_t FirstObservedAtMs;
+    };
+
+    WEAVE_ERROR SetLeafData(nl::Weave::Profiles::DataManagement::PropertyPathHandle aLeafHandle,
+                            nl::Weave::TLV::TLVReader & aReader);
+    WEAVE_ERROR OnEvent(uint16_t aType, void * aInEventParam);
+
+    void SetOpenCloseState(int32_t aOpenCloseState);
+    void SetFirstObservedAtMs(int64_t aFirstObservedAtMs);
+
+    void RecordLatency(void);
+
+    // Working copy, owned by the Weave task. Published at the end of each change.
+    SensorState mState;
+    bool mIsStateChanged;
+    SeqLock<SensorState> mPublishedState;
+
+    LatencyStats mLatencyStats;
+    SeqLock<LatencyStats> mPublishedLatencyStats;
+};
+
+#endif // SECURITY_OPEN_CLOSE_TRAIT_DATA_SINK_H
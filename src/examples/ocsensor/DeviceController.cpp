@@ -20,6 +20,8 @@
 #include "HardwarePlatform.h"
 #include "AppTask.h"
 
+#include <algorithm>
+
 #include <Weave/DeviceLayer/WeaveDeviceLayer.h>
 #include <Weave/Profiles/WeaveProfiles.h>
 #include <Weave/Support/crypto/HashAlgos.h>
@@ -28,13 +30,16 @@
 
 #include <nest/trait/detector/OpenCloseTrait.h>
 #include <nest/trait/security/SecurityOpenCloseTrait.h>
+#include <nest/trait/security/SecurityOpenCloseTraitEventSerializer.h>
 
 #include "app_timer.h"
 #include "FreeRTOS.h"
 
 //#include "BoltLockTrait.h"
+#include "AppPersistentStorage.h"
 #include "AppSoftwareUpdateManager.h"
 #include "ConnectivityState.h"
+#include "EventSerializer.h"
 #include "WDMFeature.h"
 #include "AppTask.h"
 
@@ -76,14 +81,34 @@ void DeviceController::Init()
     mOCSensorStateLEDPtr->Set(!IsOpen());
 
     WeaveLogProgress(Support, "Initializing WDMFeature");
+    // The associated lock subscribes to the sensor state directly.
+    GetWDMFeature().AcceptLocalSubscription(WDMFeature::SourceHandle<SecurityOpenCloseTraitDataSource>());
     ret = GetWDMFeature().Init();
     SuccessOrAbort(ret, "GetWDMFeature().Init() failed.");
 
+#if DEVICE_IDENTITY_TRAIT_BENCHMARK
+    GetWDMFeature().GetSource<DeviceIdentityTraitDataSource>().RunEncodeBenchmark();
+#endif
+#if EVENT_SERIALIZER_BENCHMARK || PERSISTED_EVENT_LOG_BENCHMARK
+    {
+        SecurityOpenCloseEvent ev;
+        ev.openCloseState      = OPEN_CLOSE_STATE_OPEN;
+        ev.priorOpenCloseState = OPEN_CLOSE_STATE_CLOSED;
+        ev.bypassRequested     = false;
+#if EVENT_SERIALIZER_BENCHMARK
+        RunEventSerializerBenchmark(ev, "SecurityOpenCloseEvent");
+#endif
+#if PERSISTED_EVENT_LOG_BENCHMARK
+        PersistedEventLog::GetInstance().RunBenchmark(ev, "SecurityOpenCloseEvent");
+#endif
+    }
+#endif
+
     // Initialize the Manager for Software Updates (SWU aka OTA).
     GetAppSoftwareUpdateManager().Init();
 
     // Setup the ConnectivityState object that reflects the provisioning state on a LED.
-    mConnectivityState.SetLED(mConnectivityStateLEDPtr);
+    mConnectivityState.Init(mConnectivityStateLEDPtr, AreServiceSubscriptionsEstablished);
 
     // Print the current software version.
     char currentFirmwareRev[ConfigurationManager::kMaxFirmwareRevisionLength + 1] = { 0 };
@@ -93,7 +118,7 @@ void DeviceController::Init()
     WeaveLogProgress(Support, "Current Firmware Version: %s", currentFirmwareRev);
 }
 
-void DeviceController::EventLoopCycle()
+uint32_t DeviceController::EventLoopCycle()
 {
     DeviceController & _this = GetDeviceController();
     LED * leds               = GetHardwarePlatform().GetLEDs();
@@ -105,9 +130,11 @@ void DeviceController::EventLoopCycle()
     bool startLongPressInFlight = false;
     bool endLongPressInFlight   = false;
     bool allButtonsReleased     = true;    // Provides check for button released before Long_Completed state.
+    uint32_t deadlineMs         = APP_EVENT_LOOP_NO_DEADLINE;
     for (int idx = 0; idx < PLATFORM_BUTTONS_COUNT; idx++)
     {
         Button::ButtonPressState buttonPressState = (buttons + idx)->UpdateButtonPressState();
+        deadlineMs = std::min(deadlineMs, (buttons + idx)->GetNextPressStateDeadlineMs());
         if (buttonPressState != Button::kButtonPressState_Inactive)
         {
             allButtonsReleased = false;
@@ -134,6 +161,9 @@ void DeviceController::EventLoopCycle()
     if (startLongPressInFlight)
     {
         // Indicate that long press is in flight on the LEDs by blinking all of them.
+        // The connectivity state must not override the blinking meanwhile.
+        _this.mConnectivityState.SetLEDUpdatesEnabled(false);
+
         // Turn off all LEDs before starting blink to make sure blink is co-ordinated.
         for (int led_idx = 0; led_idx < PLATFORM_LEDS_COUNT; led_idx++)
         {
@@ -156,25 +186,21 @@ void DeviceController::EventLoopCycle()
         // Set the OC Sensor status LED back to show state of lock.
         _this.mOCSensorStateLEDPtr->Set(!_this.IsOpen());
 
-        // Update the provisioning state shown on LED.
-        _this.mConnectivityState.Update(GetWDMFeature().AreServiceSubscriptionsEstablished());
-    }
-    else if (!_this.mLongPressButtonEventInFlight)
-    {
-        // Update the provisioning state shown on LED.
-        static uint16_t loopCount = 0;
-        ++loopCount;
-        if ((loopCount % 100) == 0)
-        {
-            _this.mConnectivityState.Update(GetWDMFeature().AreServiceSubscriptionsEstablished());
-        }
+        // Show the provisioning state on its LED again.
+        _this.mConnectivityState.SetLEDUpdatesEnabled(true);
     }
 
+#if OCSENSOR_EVENT_STORM_COUNT
+    deadlineMs = std::min(deadlineMs, RunEventStorm());
+#endif
+
     // Animate the LEDs.
     for (int idx = 0; idx < PLATFORM_LEDS_COUNT; idx++)
     {
-        (leds + idx)->Animate();
+        deadlineMs = std::min(deadlineMs, (leds + idx)->Animate());
     }
+
+    return deadlineMs;
 }
 
 // -----------------------------------------------------------------------------
@@ -185,6 +211,12 @@ bool DeviceController::IsOpen()
     return (mState == kState_Open);
 }
 
+// Called by ConnectivityState on the Weave task.
+bool DeviceController::AreServiceSubscriptionsEstablished(void)
+{
+    return GetWDMFeature().AreServiceSubscriptionsEstablished();
+}
+
 // -----------------------------------------------------------------------------
 // Event Handlers
 
@@ -195,7 +227,7 @@ void DeviceController::OCSensorButtonEventHandler()
     _this.mState                = (_this.IsOpen()) ? kState_Closed : kState_Open;
     int32_t openCloseTraitState = (!_this.IsOpen()) ? OPEN_CLOSE_STATE_CLOSED : OPEN_CLOSE_STATE_OPEN;
     _this.mOCSensorStateLEDPtr->Set(!_this.IsOpen());
-    GetWDMFeature().GetSecurityOpenCloseTraitDataSource().HandleStateChange(openCloseTraitState);
+    GetWDMFeature().GetSource<SecurityOpenCloseTraitDataSource>().HandleStateChange(openCloseTraitState);
 }
 
 void DeviceController::SoftwareUpdateButtonHandler()
@@ -207,6 +239,8 @@ void DeviceController::SoftwareUpdateButtonHandler()
 void DeviceController::FactoryResetButtonHandler()
 {
     WeaveLogProgress(Support, "Factory Reset Triggered.");
+    // The Device Layer only erases the Weave configuration.
+    AppPersistentStorage::EraseAll();
     nl::Weave::DeviceLayer::ConfigurationMgr().InitiateFactoryReset();
 }
 
@@ -216,3 +250,67 @@ void DeviceController::EnableUserSelectedModeButtonHandler()
     ConnectivityMgr().SetUserSelectedModeTimeout(USER_SELECTED_MODE_TIMEOUT_MS);
     ConnectivityMgr().SetUserSelectedMode(true);
 }
+
+#if OCSENSOR_EVENT_STORM_COUNT
+
+// -----------------------------------------------------------------------------
+// Event storm
+
+static_assert(PERSISTED_EVENT_LOG_PAGE_COUNT, "OCSENSOR_EVENT_STORM_COUNT requires the persisted event log");
+
+// Toggles the sensor every OCSENSOR_EVENT_STORM_INTERVAL_MS, as a door slammed
+// repeatedly would, then logs how many of its events fit in a KiB of the
+// persisted event log pages (not of the RAM event buffers, which keep full
+// headers). The events are offloaded like any other. Called on every
+// cycle of the event loop; returns the number of milliseconds until the next press.
+uint32_t DeviceController::RunEventStorm(void)
+{
+    static uint32_t sPressCount;
+    static bool sIsStarted;
+    static uint64_t sNextPressMs;
+    static PersistedEventLog::Stats sBefore;
+    uint64_t nowMs = ::nl::Weave::System::Platform::Layer::GetClock_MonotonicMS();
+    PersistedEventLog::Stats after;
+    uint32_t count;
+    uint32_t entryBytes;
+    uint32_t expandedBytes;
+
+    if (sPressCount == OCSENSOR_EVENT_STORM_COUNT)
+    {
+        return APP_EVENT_LOOP_NO_DEADLINE;
+    }
+
+    if (!sIsStarted)
+    {
+        PersistedEventLog::GetInstance().GetStats(sBefore);
+        sNextPressMs = nowMs;
+        sIsStarted   = true;
+    }
+
+    if (nowMs < sNextPressMs)
+    {
+        return (uint32_t)(sNextPressMs - nowMs);
+    }
+
+    OCSensorButtonEventHandler();
+    sNextPressMs = nowMs + OCSENSOR_EVENT_STORM_INTERVAL_MS;
+    if (++sPressCount < OCSENSOR_EVENT_STORM_COUNT)
+    {
+        return OCSENSOR_EVENT_STORM_INTERVAL_MS;
+    }
+
+    PersistedEventLog::GetInstance().GetStats(after);
+    count         = after.PersistedCount - sBefore.PersistedCount;
+    entryBytes    = std::max<uint32_t>(after.EntryBytes - sBefore.EntryBytes, 1);
+    expandedBytes = std::max<uint32_t>(after.ExpandedBytes - sBefore.ExpandedBytes, 1);
+
+    WeaveLogProgress(Support,
+                     "Event storm: %" PRIu32 " events persisted in %" PRIu32 " bytes, %" PRIu32 " with full headers: %" PRIu32
+                     " vs %" PRIu32 " events per KiB, %" PRIu32 " dropped",
+                     count, entryBytes, expandedBytes, count * 1024 / entryBytes, count * 1024 / expandedBytes,
+                     after.DroppedCount - sBefore.DroppedCount);
+
+    return APP_EVENT_LOOP_NO_DEADLINE;
+}
+
+#endif // OCSENSOR_EVENT_STORM_COUNT
@@ -38,6 +38,18 @@
 // See doc/DeviceAssociationInLocalNetwor.md.
 #define USER_SELECTED_MODE_TIMEOUT_MS 60000
 
+// Set to a number of presses of button 2 to simulate once the event loop runs,
+// then log the space their events take in the persisted event log. 0 disables
+// the storm.
+#ifndef OCSENSOR_EVENT_STORM_COUNT
+#define OCSENSOR_EVENT_STORM_COUNT 0
+#endif
+
+// Interval between two presses of the storm.
+#ifndef OCSENSOR_EVENT_STORM_INTERVAL_MS
+#define OCSENSOR_EVENT_STORM_INTERVAL_MS 50
+#endif
+
 /**
  * Controller for an Open/Close Sensor device simulated via a hardware developer kit with the
  * following GPIO artifacts:
@@ -64,7 +76,8 @@ public:
     void Init(void);
 
     // Called on every cycle of the Application Task event loop.
-    static void EventLoopCycle(void);
+    // Returns the number of milliseconds until it must be called again.
+    static uint32_t EventLoopCycle(void);
 
     // Accessor methods
     bool IsOpen();
@@ -82,6 +95,7 @@ private:
 
     // ConnectivityState displayed on a LED.
     ConnectivityState mConnectivityState;
+    static bool AreServiceSubscriptionsEstablished(void);
 
     // Button event handlers.
     static void OCSensorButtonEventHandler(void);
@@ -89,6 +103,10 @@ private:
     static void FactoryResetButtonHandler(void);
     static void EnableUserSelectedModeButtonHandler(void);
 
+#if OCSENSOR_EVENT_STORM_COUNT
+    static uint32_t RunEventStorm(void);
+#endif
+
     // Expose singleton object.
     friend DeviceController & GetDeviceController(void);
     static DeviceController sDeviceController;
@@ -19,133 +19,20 @@
 #ifndef WDM_FEATURE_H
 #define WDM_FEATURE_H
 
-#include <Weave/DeviceLayer/WeaveDeviceLayer.h>
-#include <Weave/Profiles/data-management/Current/DataManagement.h>
+#include "GenericWDMFeature.h"
 
 #include "SecurityOpenCloseTraitDataSource.h"
 #include "DeviceIdentityTraitDataSource.h"
 #include "DeviceLocatedSettingsTraitDataSink.h"
 
-#include "FreeRTOS.h"
-#include "semphr.h"
-
-class PublisherLock : public nl::Weave::Profiles::DataManagement::IWeavePublisherLock
-{
-public:
-    // Creates a recursice mutex
-    int Init();
-
-    // Takes the mutex recursively.
-    WEAVE_ERROR Lock();
-
-    // Gives the mutex recursively.
-    WEAVE_ERROR Unlock();
-
-private:
-    SemaphoreHandle_t mRecursiveLock;
-};
-
-class WDMFeature
-{
-    typedef ::nl::Weave::Profiles::DataManagement_Current::SubscriptionClient SubscriptionClient;
-    typedef ::nl::Weave::Profiles::DataManagement_Current::SubscriptionEngine SubscriptionEngine;
-    typedef ::nl::Weave::Profiles::DataManagement_Current::SubscriptionHandler SubscriptionHandler;
-    typedef ::nl::Weave::Profiles::DataManagement_Current::TraitDataSink TraitDataSink;
-    typedef ::nl::Weave::Profiles::DataManagement_Current::TraitDataSource TraitDataSource;
-    typedef ::nl::Weave::Profiles::DataManagement_Current::TraitPath TraitPath;
-    typedef ::nl::Weave::Profiles::DataManagement_Current::ResourceIdentifier ResourceIdentifier;
-    typedef ::nl::Weave::Profiles::DataManagement_Current::PropertyPathHandle PropertyPathHandle;
-
-public:
-    WDMFeature(void);
-    WEAVE_ERROR Init(void);
-    void ProcessTraitChanges(void);
-    void TearDownSubscriptions(void);
-
-    bool AreServiceSubscriptionsEstablished(void);
-
-    SecurityOpenCloseTraitDataSource & GetSecurityOpenCloseTraitDataSource(void);
-
-    nl::Weave::Profiles::DataManagement::SubscriptionEngine mSubscriptionEngine;
-
-private:
-    friend WDMFeature & GetWDMFeature(void);
-
-    enum SourceTraitHandle
-    {
-        kSourceHandle_SecurityOpenCloseTrait = 0,
-        kSourceHandle_DeviceIdentityTrait,
-
-        kSourceHandle_Max
-    };
-
-    enum SinkTraitHandle
-    {
-        kSinkHandle_DeviceLocatedSettingsTrait = 0,
-
-        kSinkHandle_Max
-    };
-
-    // Published Traits
-    SecurityOpenCloseTraitDataSource mSecurityOpenCloseTraitSource;
-    DeviceIdentityTraitDataSource mDeviceIdentityTraitSource;
-
-    // Subscribed Traits
-    DeviceLocatedSettingsTraitDataSink mBDeviceLocatedSettingsTraitSink;
-
-    void InitiateSubscriptionToService(void);
-    static void AsyncProcessChanges(intptr_t arg);
-
-    static void PlatformEventHandler(const ::nl::Weave::DeviceLayer::WeaveDeviceEvent * event, intptr_t arg);
-    static void HandleSubscriptionEngineEvent(void * appState, SubscriptionEngine::EventID eventType,
-                                              const SubscriptionEngine::InEventParam & inParam,
-                                              SubscriptionEngine::OutEventParam & outParam);
-    static void HandleServiceBindingEvent(void * appState, ::nl::Weave::Binding::EventType eventType,
-                                          const ::nl::Weave::Binding::InEventParam & inParam,
-                                          ::nl::Weave::Binding::OutEventParam & outParam);
-    static void HandleOutboundServiceSubscriptionEvent(void * appState, SubscriptionClient::EventID eventType,
-                                                       const SubscriptionClient::InEventParam & inParam,
-                                                       SubscriptionClient::OutEventParam & outParam);
-    static void HandleInboundSubscriptionEvent(void * aAppState, SubscriptionHandler::EventID eventType,
-                                               const SubscriptionHandler::InEventParam & inParam,
-                                               SubscriptionHandler::OutEventParam & outParam);
-
-    // Sink Catalog
-    nl::Weave::Profiles::DataManagement::SingleResourceSinkTraitCatalog::CatalogItem mServiceSinkCatalogStore[kSinkHandle_Max];
-    nl::Weave::Profiles::DataManagement::SingleResourceSinkTraitCatalog mServiceSinkTraitCatalog;
-
-    // Source Catalog
-    nl::Weave::Profiles::DataManagement::SingleResourceSourceTraitCatalog mServiceSourceTraitCatalog;
-    nl::Weave::Profiles::DataManagement::SingleResourceSourceTraitCatalog::CatalogItem
-        mServiceSourceCatalogStore[kSourceHandle_Max];
-
-    nl::Weave::Profiles::DataManagement::TraitPath mServiceSinkTraitPaths[kSinkHandle_Max];
-
-    // Subscription Clients
-    nl::Weave::Profiles::DataManagement::SubscriptionClient * mServiceSubClient;
-
-    // Subscription Handler
-    nl::Weave::Profiles::DataManagement::SubscriptionHandler * mServiceCounterSubHandler;
-
-    // Binding
-    nl::Weave::Binding * mServiceSubBinding;
-
-    static WDMFeature sWDMFeature;
-    PublisherLock mPublisherLock;
-
-    bool mIsSubToServiceEstablished;
-    bool mIsServiceCounterSubEstablished;
-    bool mIsSubToServiceActivated;
-};
+// Traits published and subscribed to by the open/close sensor.
+typedef GenericWDMFeature<TraitList<SecurityOpenCloseTraitDataSource, DeviceIdentityTraitDataSource>,
+                          TraitList<DeviceLocatedSettingsTraitDataSink>>
+    WDMFeature;
 
 inline WDMFeature & GetWDMFeature(void)
 {
-    return WDMFeature::sWDMFeature;
-}
-
-inline SecurityOpenCloseTraitDataSource & WDMFeature::GetSecurityOpenCloseTraitDataSource(void)
-{
-    return mSecurityOpenCloseTraitSource;
+    return WDMFeature::GetInstance();
 }
 
 #endif // WDM_FEATURE_H
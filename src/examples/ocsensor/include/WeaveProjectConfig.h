@@ -107,7 +107,9 @@
  *
  * Enable support for Weave-over-BLE (WoBLE).
  */
+#ifndef WEAVE_DEVICE_CONFIG_ENABLE_WOBLE
 #define WEAVE_DEVICE_CONFIG_ENABLE_WOBLE 1
+#endif
 
 /**
  * WEAVE_DEVICE_CONFIG_ENABLE_WEAVE_TIME_SERVICE_TIME_SYNC
@@ -140,6 +142,15 @@
  */
 #define WEAVE_CONFIG_EVENT_LOGGING_UTC_TIMESTAMPS 1
 
+/**
+ * WEAVE_CONFIG_EVENT_LOGGING_BYTE_THRESHOLD
+ *
+ * Number of bytes of events logged after which the event log is offloaded.
+ * Above WDM_EVENT_OFFLOAD_BATCH_BYTES, so that the offloads follow the
+ * importance of the events (see WDMFeatureBase::OnEventLogged()).
+ */
+#define WEAVE_CONFIG_EVENT_LOGGING_BYTE_THRESHOLD (4096)
+
 /**
  * WEAVE_DEVICE_CONFIG_EVENT_LOGGING_DEBUG_BUFFER_SIZE
  *
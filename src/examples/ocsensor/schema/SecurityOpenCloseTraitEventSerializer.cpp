@@ -0,0 +1,65 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include <nest/trait/security/SecurityOpenCloseTraitEventSerializer.h>
+
+namespace Schema {
+namespace Nest {
+namespace Trait {
+namespace Security {
+namespace SecurityOpenCloseTrait {
+
+using namespace ::nl::Weave::TLV;
+
+// Context tags of the fields, copied from the field descriptors (checked by
+// EVENT_SERIALIZER_SELF_CHECK).
+enum
+{
+    kTag_SecurityOpenCloseEvent_OpenCloseState      = 1,
+    kTag_SecurityOpenCloseEvent_PriorOpenCloseState = 2,
+    kTag_SecurityOpenCloseEvent_BypassRequested     = 32,
+};
+
+WEAVE_ERROR SerializeEvent(TLVWriter & writer, uint64_t tag, const SecurityOpenCloseEvent & event)
+{
+    WEAVE_ERROR err;
+    TLVType container;
+
+    err = writer.StartContainer(tag, kTLVType_Structure, container);
+    SuccessOrExit(err);
+
+    err = writer.Put(ContextTag(kTag_SecurityOpenCloseEvent_OpenCloseState), event.openCloseState);
+    SuccessOrExit(err);
+
+    err = writer.Put(ContextTag(kTag_SecurityOpenCloseEvent_PriorOpenCloseState), event.priorOpenCloseState);
+    SuccessOrExit(err);
+
+    err = writer.PutBoolean(ContextTag(kTag_SecurityOpenCloseEvent_BypassRequested), event.bypassRequested);
+    SuccessOrExit(err);
+
+    err = writer.EndContainer(container);
+
+exit:
+    return err;
+}
+
+} // namespace SecurityOpenCloseTrait
+} // namespace Security
+} // namespace Trait
+} // namespace Nest
+} // namespace Schema
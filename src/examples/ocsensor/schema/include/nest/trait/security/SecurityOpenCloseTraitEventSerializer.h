@@ -0,0 +1,44 @@
+/*
+ *
+ *    Copyright (c) 2020 Google LLC.
+ *    All rights reserved.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *        http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ *    @file
+ *      Direct TLV serializers of the SecurityOpenCloseTrait events (see EventSerializer.h).
+ */
+
+#ifndef SECURITY_OPEN_CLOSE_TRAIT_EVENT_SERIALIZER_H
+#define SECURITY_OPEN_CLOSE_TRAIT_EVENT_SERIALIZER_H
+
+#include <nest/trait/security/SecurityOpenCloseTrait.h>
+
+namespace Schema {
+namespace Nest {
+namespace Trait {
+namespace Security {
+namespace SecurityOpenCloseTrait {
+
+// Must match SecurityOpenCloseEventFieldDescriptors.
+WEAVE_ERROR SerializeEvent(nl::Weave::TLV::TLVWriter & writer, uint64_t tag, const SecurityOpenCloseEvent & event);
+
+} // namespace SecurityOpenCloseTrait
+} // namespace Security
+} // namespace Trait
+} // namespace Nest
+} // namespace Schema
+
+#endif // SECURITY_OPEN_CLOSE_TRAIT_EVENT_SERIALIZER_H
@@ -22,106 +22,184 @@
 
 #include <Weave/Support/CodeUtils.h>
 
+#include "AppPersistentStorage.h"
+#include "TraitLeafTable.h"
+
+#include <inttypes.h>
+
 using namespace ::nl::Weave::TLV;
 using namespace ::nl::Weave::Profiles::DataManagement;
 using namespace ::Schema::Nest::Trait::Located;
 
-DeviceLocatedSettingsTraitDataSink::DeviceLocatedSettingsTraitDataSink() : TraitDataSink(&DeviceLocatedSettingsTrait::TraitSchema)
-{}
+DeviceLocatedSettingsTraitDataSink::DeviceLocatedSettingsTraitDataSink() :
+    TraitDataSink(&DeviceLocatedSettingsTrait::TraitSchema), mIsStateDirty(false)
+{
+    mState.Version          = 0;
+    mState.FixtureMajorType = 0;
+    mState.FixtureMinorType = 0;
+}
+
+WEAVE_ERROR DeviceLocatedSettingsTraitDataSink::Init(void)
+{
+    PersistedState state;
+
+    if (!AppPersistentStorage::ReadRecord(AppPersistentStorage::kRecordId_SettingsSink, state))
+    {
+        return WEAVE_NO_ERROR;
+    }
+
+    mState = state;
+
+    // The subscribe request will offer this version to the service.
+    SetVersion(mState.Version);
+
+    WeaveLogProgress(Support, "Restored device located settings (version 0x%" PRIx64 "): fixture %" PRIu32 "/%" PRIu32,
+                     mState.Version, mState.FixtureMajorType, mState.FixtureMinorType);
+
+    return WEAVE_NO_ERROR;
+}
 
 WEAVE_ERROR
 DeviceLocatedSettingsTraitDataSink::SetLeafData(PropertyPathHandle aLeafHandle, TLVReader & aReader)
 {
-    WEAVE_ERROR err = WEAVE_NO_ERROR;
+    typedef DeviceLocatedSettingsTraitDataSink Sink;
+
+    static constexpr TraitLeafDecoder<Sink> kLeafDecoders[] = {
+        TRAIT_LEAF_NONE(DeviceLocatedSettingsTrait::kPropertyHandle_WhereAnnotationRid),
+        TRAIT_LEAF_NONE(DeviceLocatedSettingsTrait::kPropertyHandle_FixtureAnnotationRid),
+        TRAIT_LEAF_NONE(DeviceLocatedSettingsTrait::kPropertyHandle_FixtureType),
+        TRAIT_LEAF_SETTER(DeviceLocatedSettingsTrait::kPropertyHandle_FixtureType_MajorType, Sink, uint32_t, SetFixtureMajorType),
+        TRAIT_LEAF_SETTER(DeviceLocatedSettingsTrait::kPropertyHandle_FixtureType_MinorTypeDoor, Sink, uint32_t,
+                          SetFixtureMinorTypeDoor),
+        TRAIT_LEAF_SETTER(DeviceLocatedSettingsTrait::kPropertyHandle_FixtureType_MinorTypeWindow, Sink, uint32_t,
+                          SetFixtureMinorTypeWindow),
+        TRAIT_LEAF_SETTER(DeviceLocatedSettingsTrait::kPropertyHandle_FixtureType_MinorTypeWall, Sink, uint32_t,
+                          SetFixtureMinorTypeWall),
+        TRAIT_LEAF_SETTER(DeviceLocatedSettingsTrait::kPropertyHandle_FixtureType_MinorTypeObject, Sink, uint32_t,
+                          SetFixtureMinorTypeObject),
+        TRAIT_LEAF_NONE(DeviceLocatedSettingsTrait::kPropertyHandle_WhereLabel),
+        TRAIT_LEAF_NONE(DeviceLocatedSettingsTrait::kPropertyHandle_WhereSpokenAnnotationRids),
+        TRAIT_LEAF_NONE(DeviceLocatedSettingsTrait::kPropertyHandle_FixtureNameLabel),
+        TRAIT_LEAF_NONE(DeviceLocatedSettingsTrait::kPropertyHandle_FixtureSpokenAnnotationRids),
+        TRAIT_LEAF_NONE(DeviceLocatedSettingsTrait::kPropertyHandle_LastModifiedTimestamp),
+        TRAIT_LEAF_NONE(DeviceLocatedSettingsTrait::kPropertyHandle_LastKnownRelocationTimestamp),
+        TRAIT_LEAF_NONE(DeviceLocatedSettingsTrait::kPropertyHandle_WhereLegacyUuid),
+    };
+    static_assert(IsTraitLeafTableValid(kLeafDecoders, DeviceLocatedSettingsTrait::kLastSchemaHandle),
+                  "DeviceLocatedSettingsTrait leaf table does not match the schema");
+
+    return DecodeTraitLeaf(kLeafDecoders, aLeafHandle, *this, aReader);
+}
+
+WEAVE_ERROR DeviceLocatedSettingsTraitDataSink::OnEvent(uint16_t aType, void * aInEventParam)
+{
+    // The new data version is known once all the data of a notify is applied.
+    if (aType == kEventChangeEnd)
+    {
+        SaveState();
+    }
+
+    return WEAVE_NO_ERROR;
+}
+
+void DeviceLocatedSettingsTraitDataSink::SaveState(void)
+{
+    WEAVE_ERROR err;
+
+    if (!IsVersionValid() || (GetVersion() == mState.Version && !mIsStateDirty))
+    {
+        return;
+    }
+
+    mState.Version = GetVersion();
+    mIsStateDirty  = false;
+
+    err = AppPersistentStorage::WriteRecord(AppPersistentStorage::kRecordId_SettingsSink, mState);
+    if (err != WEAVE_NO_ERROR)
+    {
+        WeaveLogError(Support, "Failed to save device located settings: %s", nl::ErrorStr(err));
+    }
+}
+
+// Logs a fixture type received from the service, and whether it is in [min, max].
+static void LogFixtureType(const char * name, uint32_t value, uint32_t min, uint32_t max)
+{
+    if (value >= min && value <= max)
+    {
+        WeaveLogDetail(Support, "<< kPropertyHandle_FixtureType_%s : %d\n", name, value);
+    }
+    else
+    {
+        WeaveLogDetail(Support, "<< kPropertyHandle_FixtureType_%s %d is invalid\n", name, value);
+    }
+}
+
+void DeviceLocatedSettingsTraitDataSink::SetFixtureMajorType(uint32_t aMajorType)
+{
+    // A full re-sync sends every leaf; only apply the ones that changed.
+    if (aMajorType == mState.FixtureMajorType)
+    {
+        return;
+    }
+
+    mState.FixtureMajorType = aMajorType;
+    mIsStateDirty           = true;
+    LogFixtureType("MajorType", mState.FixtureMajorType, LocatedTrait::LOCATED_MAJOR_FIXTURE_TYPE_DOOR,
+                   LocatedTrait::LOCATED_MAJOR_FIXTURE_TYPE_OBJECT);
+}
+
+void DeviceLocatedSettingsTraitDataSink::SetFixtureMinorTypeDoor(uint32_t aMinorType)
+{
+    if (!UpdateFixtureMinorType(aMinorType))
+    {
+        return;
+    }
+
+    LogFixtureType("MinorTypeDoor", mState.FixtureMinorType, LocatedTrait::LOCATED_MINOR_FIXTURE_TYPE_DOOR_GENERIC,
+                   LocatedTrait::LOCATED_MINOR_FIXTURE_TYPE_DOOR_GARAGE_SINGLE_PANEL);
+}
+
+void DeviceLocatedSettingsTraitDataSink::SetFixtureMinorTypeWindow(uint32_t aMinorType)
+{
+    if (!UpdateFixtureMinorType(aMinorType))
+    {
+        return;
+    }
 
-    uint32_t mFixtureMajorType = 0;
-    uint32_t mFixtureMinorType = 0;
+    LogFixtureType("MinorTypeWindow", mState.FixtureMinorType, LocatedTrait::LOCATED_MINOR_FIXTURE_TYPE_WINDOW_GENERIC,
+                   LocatedTrait::LOCATED_MINOR_FIXTURE_TYPE_WINDOW_ROOF);
+}
 
-    switch (aLeafHandle)
+void DeviceLocatedSettingsTraitDataSink::SetFixtureMinorTypeWall(uint32_t aMinorType)
+{
+    if (!UpdateFixtureMinorType(aMinorType))
+    {
+        return;
+    }
+
+    LogFixtureType("MinorTypeWall", mState.FixtureMinorType, LocatedTrait::LOCATED_MINOR_FIXTURE_TYPE_WALL_GENERIC,
+                   LocatedTrait::LOCATED_MINOR_FIXTURE_TYPE_WALL_FLUSH);
+}
+
+void DeviceLocatedSettingsTraitDataSink::SetFixtureMinorTypeObject(uint32_t aMinorType)
+{
+    if (!UpdateFixtureMinorType(aMinorType))
+    {
+        return;
+    }
+
+    LogFixtureType("MinorTypeObject", mState.FixtureMinorType, LocatedTrait::LOCATED_MINOR_FIXTURE_TYPE_OBJECT_GENERIC,
+                   LocatedTrait::LOCATED_MINOR_FIXTURE_TYPE_OBJECT_GENERIC);
+}
+
+bool DeviceLocatedSettingsTraitDataSink::UpdateFixtureMinorType(uint32_t aMinorType)
+{
+    if (aMinorType == mState.FixtureMinorType)
     {
-    case DeviceLocatedSettingsTrait::kPropertyHandle_FixtureType_MajorType:
-        err = aReader.Get(mFixtureMajorType);
-        SuccessOrExit(err);
-
-        if (mFixtureMajorType >= LocatedTrait::LOCATED_MAJOR_FIXTURE_TYPE_DOOR &&
-            mFixtureMajorType <= LocatedTrait::LOCATED_MAJOR_FIXTURE_TYPE_OBJECT)
-        {
-            WeaveLogDetail(Support, "<< kPropertyHandle_FixtureType_MajorType : %d\n", mFixtureMajorType);
-        }
-        else
-        {
-            WeaveLogDetail(Support, "<< kPropertyHandle_FixtureType_MajorType %d is invalid\n", mFixtureMajorType);
-        }
-        break;
-
-    case DeviceLocatedSettingsTrait::kPropertyHandle_FixtureType_MinorTypeDoor:
-        err = aReader.Get(mFixtureMinorType);
-        SuccessOrExit(err);
-
-        if (mFixtureMinorType >= LocatedTrait::LOCATED_MINOR_FIXTURE_TYPE_DOOR_GENERIC &&
-            mFixtureMinorType <= LocatedTrait::LOCATED_MINOR_FIXTURE_TYPE_DOOR_GARAGE_SINGLE_PANEL)
-        {
-            WeaveLogDetail(Support, "<< kPropertyHandle_FixtureType_MinorTypeDoor : %d\n", mFixtureMinorType);
-        }
-        else
-        {
-            WeaveLogDetail(Support, "<< kPropertyHandle_FixtureType_MinorTypeDoor %d is invalid\n", mFixtureMinorType);
-        }
-        break;
-
-    case DeviceLocatedSettingsTrait::kPropertyHandle_FixtureType_MinorTypeWindow:
-        err = aReader.Get(mFixtureMinorType);
-        SuccessOrExit(err);
-
-        if (mFixtureMinorType >= LocatedTrait::LOCATED_MINOR_FIXTURE_TYPE_WINDOW_GENERIC &&
-            mFixtureMinorType <= LocatedTrait::LOCATED_MINOR_FIXTURE_TYPE_WINDOW_ROOF)
-        {
-            WeaveLogDetail(Support, "<< kPropertyHandle_FixtureType_MinorTypeWindow : %d\n", mFixtureMinorType);
-        }
-        else
-        {
-            WeaveLogDetail(Support, "<< kPropertyHandle_FixtureType_MinorTypeWindow %d is invalid\n", mFixtureMinorType);
-        }
-        break;
-
-    case DeviceLocatedSettingsTrait::kPropertyHandle_FixtureType_MinorTypeWall:
-        err = aReader.Get(mFixtureMinorType);
-        SuccessOrExit(err);
-
-        if (mFixtureMinorType >= LocatedTrait::LOCATED_MINOR_FIXTURE_TYPE_WALL_GENERIC &&
-            mFixtureMinorType <= LocatedTrait::LOCATED_MINOR_FIXTURE_TYPE_WALL_FLUSH)
-        {
-            WeaveLogDetail(Support, "<< kPropertyHandle_FixtureType_MinorTypeWall : %d\n", mFixtureMinorType);
-        }
-        else
-        {
-            WeaveLogDetail(Support, "<< kPropertyHandle_FixtureType_MinorTypeWall %d is invalid\n", mFixtureMinorType);
-        }
-
-        WeaveLogDetail(Support, "<< kHandle_minor_type_wall = %d\n", mFixtureMinorType);
-        break;
-
-    case DeviceLocatedSettingsTrait::kPropertyHandle_FixtureType_MinorTypeObject:
-        err = aReader.Get(mFixtureMinorType);
-        SuccessOrExit(err);
-
-        if (mFixtureMinorType == LocatedTrait::LOCATED_MINOR_FIXTURE_TYPE_OBJECT_GENERIC)
-        {
-            WeaveLogDetail(Support, "<< kPropertyHandle_FixtureType_MinorTypeObject : %d\n", mFixtureMinorType);
-        }
-        else
-        {
-            WeaveLogDetail(Support, "<< kPropertyHandle_FixtureType_MinorTypeObject %d is invalid\n", mFixtureMinorType);
-        }
-        break;
-
-    case DeviceLocatedSettingsTrait::kPropertyHandle_FixtureType:
-        break;
-
-    default:
-        WeaveLogDetail(Support, "<< UNKNOWN Device Located Settings trait leaf handle : %d\n", aLeafHandle);
+        return false;
     }
 
-exit:
-    return err;
+    mState.FixtureMinorType = aMinorType;
+    mIsStateDirty           = true;
+    return true;
 }
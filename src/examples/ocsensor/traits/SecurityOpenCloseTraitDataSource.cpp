@@ -27,6 +27,8 @@
 
 #include <nest/trait/detector/OpenCloseTrait.h>
 #include <nest/trait/security/SecurityOpenCloseTrait.h>
+#include <nest/trait/security/SecurityOpenCloseTraitEventSerializer.h>
+#include <EventSerializer.h>
 #include <WDMFeature.h>
 #include <AppTask.h>
 
@@ -46,13 +48,24 @@ SecurityOpenCloseTraitDataSource::SecurityOpenCloseTraitDataSource() : TraitData
     // reboot the device. Our example app will say it is closed. How long before the service
     // catches up with that? Can the device trigger that update? It probably should... Otherwaise,
     // we have to wait for the service to request an update for the state. How often does that happen?
-    mState = OPEN_CLOSE_STATE_CLOSED;
+    mTraitState.OpenCloseState    = OPEN_CLOSE_STATE_CLOSED;
+    mTraitState.FirstObservedAtMs = 0;
+    // Bypass is not a supported feature in this example.
+    mTraitState.BypassRequested = false;
+
+    mPublishedTraitState.Init(mTraitState);
 }
 
 void SecurityOpenCloseTraitDataSource::HandleStateChange(int32_t aState)
 {
-    int32_t previous_state = mState;
-    mState                 = aState;
+    int32_t previous_state = mTraitState.OpenCloseState;
+
+    mTraitState.OpenCloseState    = aState;
+    mTraitState.FirstObservedAtMs = static_cast<int64_t>(System::Platform::Layer::GetClock_MonotonicMS());
+
+    // Publish before marking dirty, so that the notification engine never reads
+    // older data than what it was told about.
+    mPublishedTraitState.Publish(mTraitState);
 
     Lock();
 
@@ -63,51 +76,28 @@ void SecurityOpenCloseTraitDataSource::HandleStateChange(int32_t aState)
     Unlock();
 
     SecurityOpenCloseEvent ev;
-    EventOptions options(true);
-    ev.openCloseState      = mState;
+    EventOptions options;
+    ev.openCloseState      = mTraitState.OpenCloseState;
     ev.priorOpenCloseState = previous_state;
-
-    /* Bypass is not a supported feature in this example */
-    ev.bypassRequested = false;
-    nl::LogEvent(&ev, options);
+    ev.bypassRequested     = mTraitState.BypassRequested;
+    LogEventDirect(ev, options);
 
     GetWDMFeature().ProcessTraitChanges();
 }
 
 WEAVE_ERROR SecurityOpenCloseTraitDataSource::GetLeafData(PropertyPathHandle aLeafHandle, uint64_t aTagToWrite, TLVWriter & aWriter)
 {
-    WEAVE_ERROR err = WEAVE_NO_ERROR;
-
-    switch (aLeafHandle)
-    {
-    case SecurityOpenCloseTrait::kPropertyHandle_OpenCloseState: {
-        err = aWriter.Put(aTagToWrite, mState);
-        SuccessOrExit(err);
-        break;
-    }
-
-    case SecurityOpenCloseTrait::kPropertyHandle_BypassRequested: {
-        /* Bypass is not a supported feature in this example */
-        bool bypass_requested = false;
-        err                   = aWriter.PutBoolean(aTagToWrite, bypass_requested);
-        SuccessOrExit(err);
-        break;
-    }
-
-    case SecurityOpenCloseTrait::kPropertyHandle_FirstObservedAtMs: {
-        uint64_t currentTime = 0;
-        currentTime          = System::Platform::Layer::GetClock_MonotonicMS();
-        err                  = aWriter.Put(aTagToWrite, static_cast<int64_t>(currentTime));
-        SuccessOrExit(err);
-        break;
-    }
-
-    default: {
-        WeaveLogError(Support, "SecurityOpenCloseTrait::Unexpected Leaf");
-        break;
-    }
-    }
-
-exit:
-    return err;
-}
\ No newline at end of file
+    static constexpr TraitLeafEncoder<TraitState> kLeafEncoders[] = {
+        TRAIT_LEAF_FIELD(SecurityOpenCloseTrait::kPropertyHandle_OpenCloseState, TraitState, OpenCloseState),
+        TRAIT_LEAF_NONE(SecurityOpenCloseTrait::kPropertyHandle_FirstObservedAt),
+        TRAIT_LEAF_FIELD(SecurityOpenCloseTrait::kPropertyHandle_FirstObservedAtMs, TraitState, FirstObservedAtMs),
+        TRAIT_LEAF_FIELD(SecurityOpenCloseTrait::kPropertyHandle_BypassRequested, TraitState, BypassRequested),
+    };
+    static_assert(IsTraitLeafTableValid(kLeafEncoders, SecurityOpenCloseTrait::kLastSchemaHandle),
+                  "SecurityOpenCloseTrait leaf table does not match the schema");
+
+    // Lock-free: the AppTask may be publishing a new state concurrently.
+    const TraitState & state = mNotifiedTraitState.Get(mPublishedTraitState, GetVersion());
+
+    return EncodeTraitLeaf(kLeafEncoders, aLeafHandle, state, aTagToWrite, aWriter);
+}
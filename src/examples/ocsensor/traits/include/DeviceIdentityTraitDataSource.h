@@ -25,7 +25,14 @@
 #ifndef DEVICE_IDENTITY_TRAIT_DATA_SOURCE_H
 #define DEVICE_IDENTITY_TRAIT_DATA_SOURCE_H
 
-#include <Weave/Profiles/data-management/TraitData.h>
+#include <Weave/DeviceLayer/WeaveDeviceLayer.h>
+
+#include "CachedTraitDataSource.h"
+
+// Set to 1 to log the cost of encoding the trait with and without the cache at startup.
+#ifndef DEVICE_IDENTITY_TRAIT_BENCHMARK
+#define DEVICE_IDENTITY_TRAIT_BENCHMARK 0
+#endif
 
 /**
  *  @class DeviceIdentityTraitDataSource
@@ -33,15 +40,27 @@
  *  @brief
  *    Implements a data source for the Weave DeviceIdentityTrait.
  *
+ *    The trait data only changes on provisioning or software update, so each
+ *    leaf is encoded once into a TLV cache and copied from there on every
+ *    notify, instead of being read back from the ConfigurationManager.
+ *
  */
-class DeviceIdentityTraitDataSource : public ::nl::Weave::Profiles::DataManagement_Current::TraitDataSource
+class DeviceIdentityTraitDataSource : public CachedTraitDataSource
 {
 public:
     DeviceIdentityTraitDataSource(void);
 
+    // Must be called on every device event, on the Weave task. Drops the cache
+    // when the identity or the fabric of the device may have changed.
+    void OnPlatformEvent(const ::nl::Weave::DeviceLayer::WeaveDeviceEvent * event);
+
+#if DEVICE_IDENTITY_TRAIT_BENCHMARK
+    void RunEncodeBenchmark(void);
+#endif
+
 private:
-    WEAVE_ERROR GetLeafData(::nl::Weave::Profiles::DataManagement_Current::PropertyPathHandle aLeafHandle, uint64_t aTagToWrite,
-                            ::nl::Weave::TLV::TLVWriter & aWriter) override;
+    WEAVE_ERROR EncodeLeaf(::nl::Weave::Profiles::DataManagement_Current::PropertyPathHandle aLeafHandle, uint64_t aTagToWrite,
+                           ::nl::Weave::TLV::TLVWriter & aWriter) override;
 };
 
 #endif // DEVICE_IDENTITY_TRAIT_DATA_SOURCE_H
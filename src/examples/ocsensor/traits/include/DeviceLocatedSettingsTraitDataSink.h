@@ -32,12 +32,34 @@ class DeviceLocatedSettingsTraitDataSink : public nl::Weave::Profiles::DataManag
 public:
     DeviceLocatedSettingsTraitDataSink();
 
+    // Restores the fixture type and its data version saved before the last reboot.
+    WEAVE_ERROR Init(void);
+
 private:
+    // Data version of the fixture type, saved with the fixture type it describes.
+    struct PersistedState
+    {
+        uint64_t Version;
+        uint32_t FixtureMajorType;
+        uint32_t FixtureMinorType;
+    };
+
     WEAVE_ERROR SetLeafData(nl::Weave::Profiles::DataManagement::PropertyPathHandle aLeafHandle,
                             nl::Weave::TLV::TLVReader & aReader);
+    WEAVE_ERROR OnEvent(uint16_t aType, void * aInEventParam);
+
+    void SetFixtureMajorType(uint32_t aMajorType);
+    void SetFixtureMinorTypeDoor(uint32_t aMinorType);
+    void SetFixtureMinorTypeWindow(uint32_t aMinorType);
+    void SetFixtureMinorTypeWall(uint32_t aMinorType);
+    void SetFixtureMinorTypeObject(uint32_t aMinorType);
+    bool UpdateFixtureMinorType(uint32_t aMinorType);
+
+    void SaveState(void);
 
-    uint32_t mFixtureMajorType = 0;
-    uint32_t mFixtureMinorType = 0;
+    PersistedState mState;
+    // Set when a leaf changed since the last SaveState().
+    bool mIsStateDirty;
 };
 
 #endif /* DEVICE_LOCATED_SETTINGS_TRAIT_DATA_SINK_H */
\ No newline at end of file
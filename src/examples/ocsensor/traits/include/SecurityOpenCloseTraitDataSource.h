@@ -29,6 +29,10 @@
 
 #include <Weave/Profiles/data-management/TraitData.h>
 
+#include "SeqLock.h"
+#include "TraitLeafTable.h"
+#include "VersionedSnapshot.h"
+
 class SecurityOpenCloseTraitDataSource : public ::nl::Weave::Profiles::DataManagement_Current::TraitDataSource
 {
 public:
@@ -40,7 +44,22 @@ private:
     WEAVE_ERROR GetLeafData(::nl::Weave::Profiles::DataManagement_Current::PropertyPathHandle aLeafHandle, uint64_t aTagToWrite,
                             ::nl::Weave::TLV::TLVWriter & aWriter) override;
 
-    int32_t mState;
+    struct TraitState
+    {
+        int32_t OpenCloseState;
+        int64_t FirstObservedAtMs;
+        bool BypassRequested;
+    };
+
+    // Working copy, owned by the AppTask.
+    TraitState mTraitState;
+
+    // Snapshot read by GetLeafData() on the Weave task.
+    SeqLock<TraitState> mPublishedTraitState;
+
+    // Copy of mPublishedTraitState at the current data version, shared by the
+    // notifies of the service and of the associated lock.
+    VersionedSnapshot<TraitState> mNotifiedTraitState;
 };
 
 #endif // SECURITY_OPEN_CLOSE_TRAIT_DATA_SOURCE_H
\ No newline at end of file